@@ -14,7 +14,7 @@
 //! `extern "C"` symbols is discouraged — prefer `safe::*` wrappers.
 
 use std::ffi::c_void;
-use std::os::raw::c_int;
+use std::os::raw::{c_char, c_int};
 
 // Link to our C library
 #[cfg(has_c_fast_path)]
@@ -76,6 +76,55 @@ extern "C" {
     /// Returns 0 on success.
     pub fn mev_pools_init() -> i32;
 
+    /// Initialise the pools with explicit `MEV_ARENA_*` flags (0 = heap slabs).
+    pub fn mev_pools_init_arena(flags: u32) -> i32;
+
+    /// Initialise the pools with explicit size classes; -1 on an invalid config.
+    pub fn mev_pools_init_ex(cfg: *const MevPoolsConfig) -> i32;
+
+    /// Fill `cfg` with the default classes (256 B .. 128 KB) and arena flags.
+    pub fn mev_pools_default_config(cfg: *mut MevPoolsConfig);
+
+    /// Arena layout and pre-fault counts for the pools; -1 before init.
+    pub fn mev_pools_arena_info(out: *mut MevArenaInfo) -> i32;
+
+    /// Reserve the per-block region arena (0 = default size / chunk) with `MEV_ARENA_*` flags.
+    pub fn mev_region_init(bytes: usize, chunk_bytes: usize, arena_flags: u32) -> i32;
+
+    /// Bump-allocate block-lifetime memory (16-byte aligned); valid until the next reset.
+    pub fn mev_region_alloc(size: usize) -> *mut u8;
+
+    /// Bump-allocate with a power-of-2 alignment up to 4096.
+    pub fn mev_region_alloc_aligned(size: usize, align: usize) -> *mut u8;
+
+    /// Recycle the whole region and start `epoch` (the new block number). No thread
+    /// may still use the previous block's region memory.
+    pub fn mev_region_reset(epoch: u64);
+
+    /// Chunk usage, high-water mark and overflow counts for the region.
+    pub fn mev_region_stats(out: *mut MevRegionStats);
+
+    /// Allocate from the smallest size class that fits (malloc above the largest).
+    pub fn mev_alloc(size: usize) -> *mut u8;
+
+    /// Free any block from `mev_alloc` / `mev_alloc_*`; the class is found from its address.
+    pub fn mev_free(ptr: *mut u8);
+
+    /// Number of configured size classes.
+    pub fn mev_pools_class_count() -> u32;
+
+    /// NUMA nodes the pools keep a copy of every class for.
+    pub fn mev_pools_node_count() -> u32;
+
+    /// Pin the calling thread's pool allocations to `node` (-1 follows the CPU again).
+    pub fn mev_pools_set_thread_node(node: i32) -> i32;
+
+    /// Slab accounting for one node's copy of a size class; -1 if out of range.
+    pub fn mev_pool_node_usage(node: u32, cls: u32, out: *mut MevPoolUsage) -> i32;
+
+    /// Slab accounting for one size class (ascending index); -1 if out of range.
+    pub fn mev_pool_class_usage(cls: u32, out: *mut MevPoolUsage) -> i32;
+
     /// Allocate a 512-byte transaction buffer from the arena pool. Returns null on exhaustion.
     pub fn mev_alloc_tx() -> *mut u8;
 
@@ -88,6 +137,16 @@ extern "C" {
     /// Return a calldata buffer to the arena pool.
     pub fn mev_free_calldata(ptr: *mut u8);
 
+    /// Return the calling thread's magazine-cached blocks to the shared pools
+    /// (done automatically when a C-visible thread exits).
+    pub fn mev_pools_flush_thread();
+
+    /// Shared-pool contention counters for the tx, calldata and result pools.
+    pub fn mev_pool_contention(tx: *mut MevPoolContention, calldata: *mut MevPoolContention, result: *mut MevPoolContention);
+
+    /// Exact slab accounting and malloc-fallback counts for the tx, calldata and result pools.
+    pub fn mev_pool_usage(tx: *mut MevPoolUsage, calldata: *mut MevPoolUsage, result: *mut MevPoolUsage);
+
     /// Create a lock-free MPSC queue with the given capacity (rounded up to power of 2).
     /// Returns null on allocation failure.
     pub fn mev_queue_create(capacity: usize) -> *mut c_void;
@@ -101,8 +160,280 @@ extern "C" {
     /// Pop an item from the queue. Returns null if empty.
     pub fn mev_queue_pop(q: *mut c_void) -> *mut c_void;
 
+    /// Push up to `n_items`, claiming the run of free slots with one CAS.
+    /// Returns the number pushed (0 if full).
+    pub fn mev_queue_push_batch(q: *mut c_void, items: *const *mut c_void, n_items: usize) -> usize;
+
+    /// Pop up to `max_items`, claiming the run of ready slots with one CAS.
+    /// Returns the number popped (0 if empty).
+    pub fn mev_queue_pop_batch(q: *mut c_void, items: *mut *mut c_void, max_items: usize) -> usize;
+
     /// Return the current number of items in the queue (approximate under concurrency).
     pub fn mev_queue_size(q: *mut c_void) -> usize;
+
+    /// Create an inline-record queue: `record_size`-byte payloads stored in the slots.
+    /// Returns null on allocation failure or a zero record size.
+    pub fn mev_recq_create(capacity: usize, record_size: usize) -> *mut c_void;
+
+    /// Destroy an inline-record queue.
+    pub fn mev_recq_destroy(q: *mut c_void);
+
+    /// Claim a slot to fill in place; null if full. Follow with `mev_recq_commit(ticket)`.
+    pub fn mev_recq_claim(q: *mut c_void, ticket: *mut usize) -> *mut c_void;
+
+    /// Publish a claimed slot.
+    pub fn mev_recq_commit(q: *mut c_void, ticket: usize);
+
+    /// Take the oldest record to read in place; null if empty. Follow with `mev_recq_release(ticket)`.
+    pub fn mev_recq_acquire(q: *mut c_void, ticket: *mut usize) -> *const c_void;
+
+    /// Return an acquired slot to producers.
+    pub fn mev_recq_release(q: *mut c_void, ticket: usize);
+
+    /// Turn on telemetry for a queue (before it is shared); one push in 2^`sample_shift`
+    /// is timestamped for the sojourn histogram. Returns 0, or -1 on allocation failure.
+    pub fn mev_queue_enable_stats(q: *mut c_void, sample_shift: u32) -> i32;
+
+    /// Snapshot queue telemetry into `out`. Returns -1 if telemetry is off.
+    pub fn mev_queue_stats(q: *mut c_void, out: *mut MevQueueStats) -> i32;
+
+    /// Create a single-producer broadcast ring of `record_size`-byte records read by up
+    /// to `max_consumers` consumers. Returns null on allocation failure.
+    pub fn mev_bcast_create(capacity: usize, record_size: usize, max_consumers: usize) -> *mut c_void;
+
+    /// Destroy a broadcast ring.
+    pub fn mev_bcast_destroy(b: *mut c_void);
+
+    /// Register a consumer; returns its id or -1 if all are taken.
+    pub fn mev_bcast_subscribe(b: *mut c_void) -> i32;
+
+    /// Unregister a consumer so it no longer gates the producer.
+    pub fn mev_bcast_unsubscribe(b: *mut c_void, id: i32);
+
+    /// Next slot to fill (producer thread); null while the slowest consumer is a ring behind.
+    pub fn mev_bcast_claim(b: *mut c_void) -> *mut c_void;
+
+    /// Make every claimed slot visible. Returns the number published.
+    pub fn mev_bcast_publish(b: *mut c_void) -> usize;
+
+    /// Contiguous unread records for consumer `id`, `mev_bcast_stride` bytes apart, read in place.
+    pub fn mev_bcast_read(b: *mut c_void, id: i32, first: *mut *const c_void, max: usize) -> usize;
+
+    /// Mark `n` records consumed by consumer `id`.
+    pub fn mev_bcast_release(b: *mut c_void, id: i32, n: usize);
+
+    /// Byte distance between consecutive records.
+    pub fn mev_bcast_stride(b: *mut c_void) -> usize;
+
+    /// Create a cross-process queue in POSIX shared memory `name` (e.g. "/mev-txs"),
+    /// replacing any existing one. `kind` 1 = SPSC variable-length, 2 = MPMC fixed slots.
+    pub fn mev_shmq_create(name: *const c_char, kind: i32, capacity: usize, slot_size: usize) -> *mut c_void;
+
+    /// Map a queue created by another process. Null if missing, not ready or a different version.
+    pub fn mev_shmq_open(name: *const c_char) -> *mut c_void;
+
+    /// Unmap this process's view of a shared-memory queue.
+    pub fn mev_shmq_close(q: *mut c_void);
+
+    /// Remove the shared-memory name; existing mappings stay valid.
+    pub fn mev_shmq_unlink(name: *const c_char) -> i32;
+
+    /// Copy a record in. 0 on success, -1 if full, -2 if larger than the queue's max record.
+    pub fn mev_shmq_send(q: *mut c_void, data: *const u8, len: u32) -> i32;
+
+    /// Copy the next record out. Its length, -1 if empty, -2 if `buf_len` is too small.
+    pub fn mev_shmq_recv(q: *mut c_void, buf: *mut u8, buf_len: u32) -> i32;
+
+    /// Create an unbounded MPSC segmented queue capped at `max_items` (0 = no ceiling).
+    pub fn mev_segq_create(max_items: usize) -> *mut c_void;
+
+    /// Destroy a segmented queue (queued items are not freed).
+    pub fn mev_segq_destroy(q: *mut c_void);
+
+    /// Push a non-null item from any thread. 0 on success, -1 only at the memory ceiling.
+    pub fn mev_segq_push(q: *mut c_void, item: *mut c_void) -> i32;
+
+    /// Pop the oldest item (single consumer). Returns null if empty.
+    pub fn mev_segq_pop(q: *mut c_void) -> *mut c_void;
+
+    /// Segments allocated now, the most ever allocated at once, and pushes refused at the ceiling.
+    pub fn mev_segq_stats(q: *mut c_void, segments: *mut usize, high_water: *mut usize, ceiling_hits: *mut usize);
+
+    /// Create a profit-ordered priority queue of `capacity` entries over `n_shards` shards (0 = 8).
+    pub fn mev_pq_create(capacity: usize, n_shards: usize) -> *mut c_void;
+
+    /// Destroy a priority queue (queued items are not freed).
+    pub fn mev_pq_destroy(q: *mut c_void);
+
+    /// Push an opportunity. Returns 1 when the full shard shed its lowest entry
+    /// (possibly `item`), written to `evicted`; 0 otherwise.
+    pub fn mev_pq_push(q: *mut c_void, profit: i64, deadline_block: u64, item: *mut c_void, evicted: *mut *mut c_void) -> i32;
+
+    /// Pop the (approximately) most profitable item. Returns null if empty.
+    pub fn mev_pq_pop(q: *mut c_void, profit: *mut i64, deadline_block: *mut u64) -> *mut c_void;
+
+    /// Create a blocking-wait object to pair with one queue. Returns null on allocation failure.
+    pub fn mev_wait_create() -> *mut c_void;
+
+    /// Destroy a blocking-wait object.
+    pub fn mev_wait_destroy(w: *mut c_void);
+
+    /// Wake parked consumers; call after a successful push.
+    pub fn mev_wait_notify(w: *mut c_void);
+
+    /// Pop, spinning then parking on a futex for up to `timeout_ns` (< 0 = forever).
+    /// Returns null on timeout.
+    pub fn mev_queue_pop_wait(q: *mut c_void, w: *mut c_void, timeout_ns: i64) -> *mut c_void;
+
+    /// Create a wait-free SPSC ring (one producer thread, one consumer thread).
+    /// Capacity is rounded up to a power of 2. Returns null on allocation failure.
+    pub fn mev_spsc_create(capacity: usize) -> *mut c_void;
+
+    /// Destroy an SPSC ring and free its backing memory.
+    pub fn mev_spsc_destroy(q: *mut c_void);
+
+    /// Push an item (producer thread only). Returns 0 on success, -1 if full.
+    pub fn mev_spsc_push(q: *mut c_void, item: *mut c_void) -> i32;
+
+    /// Pop an item (consumer thread only). Returns null if empty.
+    pub fn mev_spsc_pop(q: *mut c_void) -> *mut c_void;
+
+    /// Push up to `n_items` with a single publish. Returns the number pushed.
+    pub fn mev_spsc_push_batch(q: *mut c_void, items: *const *mut c_void, n_items: usize) -> usize;
+
+    /// Pop up to `max_items` with a single release. Returns the number popped.
+    pub fn mev_spsc_pop_batch(q: *mut c_void, items: *mut *mut c_void, max_items: usize) -> usize;
+}
+
+/// C-compatible per-pool contention counters filled by [`mev_pool_contention`].
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct MevPoolContention {
+    /// Failed CAS attempts on the shared pool's free-list head.
+    pub cas_retries: usize,
+    /// Per-thread magazine refills from the shared pool.
+    pub refills: usize,
+    /// Per-thread magazine spills to the shared pool.
+    pub spills: usize,
+    /// Blocks freed by a thread on another NUMA node.
+    pub remote_frees: usize,
+}
+
+/// C-compatible slab accounting filled by [`mev_pool_usage`].
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct MevPoolUsage {
+    pub block_size: usize,
+    /// Slab blocks; `blocks - free` are held by threads or callers.
+    pub blocks: usize,
+    pub free: usize,
+    /// Blocks malloc'd because the slab was empty.
+    pub fallback_allocs: usize,
+    /// Fallback blocks not yet freed.
+    pub fallback_live: usize,
+    /// Slab ceiling; `blocks` grows from the initial count up to it.
+    pub max_blocks: usize,
+}
+
+/// C-compatible region statistics filled by [`mev_region_stats`].
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct MevRegionStats {
+    pub epoch: u64,
+    pub resets: u64,
+    pub chunk_bytes: usize,
+    pub chunks: usize,
+    /// Chunks claimed this epoch.
+    pub chunks_used: usize,
+    pub chunks_high_water: usize,
+    /// Chunks malloc'd this epoch because the arena was exhausted.
+    pub overflow_chunks: usize,
+    pub overflow_total: usize,
+}
+
+/// Maximum size classes in [`MevPoolsConfig`].
+pub const MEV_POOL_MAX_CLASSES: usize = 16;
+
+/// One pool size class: block size with initial (pre-faulted) and maximum counts.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct MevSizeClass {
+    pub block_size: usize,
+    pub initial: u32,
+    pub max: u32,
+}
+
+/// C-compatible pool configuration for [`mev_pools_init_ex`].
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct MevPoolsConfig {
+    pub n_classes: u32,
+    /// Ascending block sizes.
+    pub classes: [MevSizeClass; MEV_POOL_MAX_CLASSES],
+    /// `MEV_ARENA_*` flags.
+    pub arena_flags: u32,
+    /// NUMA nodes with their own copy of every class; 0 = detect.
+    pub nodes: u32,
+}
+
+/// Maximum labelled regions in [`MevArenaInfo::regions`].
+pub const MEV_ARENA_MAX_REGIONS: usize = 64;
+
+/// One labelled carve in the pool arena.
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct MevArenaRegion {
+    pub label: *const c_char,
+    /// Offset from the arena base.
+    pub offset: usize,
+    pub bytes: usize,
+}
+
+/// C-compatible arena report filled by [`mev_pools_arena_info`].
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct MevArenaInfo {
+    pub base: *mut c_void,
+    pub size: usize,
+    pub used: usize,
+    pub page_size: usize,
+    /// 0 heap, 1 4K pages, 2 THP, 3 hugetlb.
+    pub backing: c_int,
+    /// Every mlock requested succeeded.
+    pub locked: c_int,
+    pub locked_bytes: usize,
+    /// Faults taken while pre-faulting at init.
+    pub minor_faults: std::os::raw::c_long,
+    pub major_faults: std::os::raw::c_long,
+    pub prefault_ns: u64,
+    /// NUMA binds refused (those spans take first-touch placement).
+    pub bind_failures: u32,
+    pub n_regions: u32,
+    pub regions: [MevArenaRegion; MEV_ARENA_MAX_REGIONS],
+}
+
+/// Number of log2 buckets in [`MevQueueStats::sojourn`].
+pub const MEV_QUEUE_LAT_BUCKETS: usize = 32;
+
+/// C-compatible queue telemetry snapshot filled by [`mev_queue_stats`].
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct MevQueueStats {
+    pub pushes: u64,
+    pub pops: u64,
+    /// Push calls cut short by a full queue.
+    pub full: u64,
+    /// Occupancy at snapshot time.
+    pub depth: u64,
+    /// Deepest occupancy seen after a push.
+    pub high_water: u64,
+    pub capacity: u64,
+    /// Sojourn samples recorded.
+    pub sampled: u64,
+    /// TSC ticks per nanosecond, measured since telemetry was enabled.
+    pub ticks_per_ns: f64,
+    /// Enqueue → dequeue time histogram; bucket `b` counts [2^b, 2^(b+1)) ticks.
+    pub sojourn: [u64; MEV_QUEUE_LAT_BUCKETS],
 }
 
 /// C-compatible struct returned by [`mev_parse_swap`] after decoding swap calldata.
@@ -179,9 +510,41 @@ pub mod safe {
     use super::*;
     use ethers::types::{Address, H256, U256};
 
-    /// Initialise C arena allocator pools. Call once at startup.
+    /// Initialise C arena allocator pools and log the arena layout. Call once at startup.
     pub fn init_pools() -> bool {
-        unsafe { mev_pools_init() == 0 }
+        if unsafe { mev_pools_init() } != 0 {
+            return false;
+        }
+        let mut info: MevArenaInfo = unsafe { std::mem::zeroed() };
+        if unsafe { mev_pools_arena_info(&mut info) } == 0 {
+            let backing = ["heap", "4k", "thp", "hugetlb"]
+                .get(info.backing as usize)
+                .copied()
+                .unwrap_or("?");
+            tracing::info!(
+                backing,
+                numa_nodes = unsafe { mev_pools_node_count() },
+                size_kb = info.size >> 10,
+                locked_kb = info.locked_bytes >> 10,
+                minor_faults = info.minor_faults,
+                major_faults = info.major_faults,
+                prefault_us = info.prefault_ns / 1000,
+                "pool arena ready"
+            );
+            if info.bind_failures > 0 {
+                tracing::warn!(
+                    bind_failures = info.bind_failures,
+                    "pool arena: NUMA bind refused, those spans are placed on first touch"
+                );
+            }
+            for r in &info.regions[..info.n_regions as usize] {
+                let label = unsafe { std::ffi::CStr::from_ptr(r.label) }.to_string_lossy();
+                tracing::info!(region = %label, offset = r.offset, bytes = r.bytes, "pool arena region");
+            }
+        } else {
+            tracing::warn!("pool arena unavailable, slabs are heap-backed");
+        }
+        true
     }
 
     /// Compute Keccak-256 via the C implementation (~550 ns for 32 bytes).
@@ -390,6 +753,42 @@ impl OpportunityQueue {
     }
     pub fn len(&self) -> usize { unsafe { mev_queue_size(self.inner) } }
     pub fn is_empty(&self) -> bool { self.len() == 0 }
+
+    /// Turn on telemetry (call before sharing the queue across threads).
+    pub fn enable_stats(&mut self, sample_shift: u32) -> bool {
+        unsafe { mev_queue_enable_stats(self.inner, sample_shift) == 0 }
+    }
+    pub fn stats(&self) -> Option<MevQueueStats> {
+        let mut out = MevQueueStats::default();
+        if unsafe { mev_queue_stats(self.inner, &mut out) } == 0 { Some(out) } else { None }
+    }
+
+    /// Export the telemetry snapshot as `mev_queue_*` gauges labelled `queue = name`.
+    pub fn publish_metrics(&self, name: &'static str) {
+        let Some(s) = self.stats() else {
+            metrics::gauge!("mev_queue_depth", "queue" => name).set(self.len() as f64);
+            return;
+        };
+        metrics::gauge!("mev_queue_depth", "queue" => name).set(s.depth as f64);
+        metrics::gauge!("mev_queue_high_water", "queue" => name).set(s.high_water as f64);
+        metrics::gauge!("mev_queue_pushes_total", "queue" => name).set(s.pushes as f64);
+        metrics::gauge!("mev_queue_pops_total", "queue" => name).set(s.pops as f64);
+        metrics::gauge!("mev_queue_full_total", "queue" => name).set(s.full as f64);
+        if s.sampled > 0 && s.ticks_per_ns > 0.0 {
+            // Median and p99 from the log2 histogram, as bucket lower bounds
+            let quantile = |q: f64| {
+                let target = (s.sampled as f64 * q).ceil() as u64;
+                let mut seen = 0;
+                for (b, n) in s.sojourn.iter().enumerate() {
+                    seen += n;
+                    if seen >= target { return (1u64 << b) as f64 / s.ticks_per_ns; }
+                }
+                (1u64 << (MEV_QUEUE_LAT_BUCKETS - 1)) as f64 / s.ticks_per_ns
+            };
+            metrics::gauge!("mev_queue_sojourn_p50_ns", "queue" => name).set(quantile(0.5));
+            metrics::gauge!("mev_queue_sojourn_p99_ns", "queue" => name).set(quantile(0.99));
+        }
+    }
 }
 
 #[cfg(has_c_fast_path)]
@@ -422,6 +821,11 @@ impl OpportunityQueue {
     }
     pub fn len(&self) -> usize { self.inner.lock().unwrap().len() }
     pub fn is_empty(&self) -> bool { self.len() == 0 }
+    pub fn enable_stats(&mut self, _sample_shift: u32) -> bool { false }
+    pub fn stats(&self) -> Option<MevQueueStats> { None }
+    pub fn publish_metrics(&self, name: &'static str) {
+        metrics::gauge!("mev_queue_depth", "queue" => name).set(self.len() as f64);
+    }
 }
 
 #[cfg(not(has_c_fast_path))]
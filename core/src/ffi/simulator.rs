@@ -65,8 +65,32 @@ pub struct PathfinderResultC {
     pub best_path:      PathC,
     pub optimal_amount: u64,
     pub gross_profit:   i64,
+    pub profit_base:    i64,  // gross_profit in base-token (WETH) units
     pub valid:          u8,
-    pub _pad:           [u8; 7],
+    pub normalized:     u8,   // 1 if profit_base is set
+    pub _pad:           [u8; 6],
+}
+
+/// Pending swap handed to the backrun cache — mirrors `VictimSwap` in backrun_cache.h
+#[repr(C, packed)]
+#[derive(Clone, Copy, Default)]
+pub struct VictimSwapC {
+    pub tx_hash:   [u8; 32],
+    pub pool_addr: [u8; 20],
+    pub token_in:  [u8; 20],
+    pub amount_in: u64,
+}
+
+/// Precomputed backrun — mirrors `BackrunQuote` in backrun_cache.h
+#[repr(C, packed)]
+#[derive(Clone, Copy, Default)]
+pub struct BackrunQuoteC {
+    pub backrun:           PathfinderResultC,
+    pub post_reserve0:     u64,
+    pub post_reserve1:     u64,
+    pub victim_amount_out: u64,
+    pub victim_slot:       u32,
+    pub _pad:              u32,
 }
 
 // ─── Raw extern "C" declarations ─────────────────────────────────────────────
@@ -101,11 +125,15 @@ extern "C" {
     #[allow(dead_code)]
     fn pathfinder_token_fp(addr20: *const u8) -> u64;
 
+    /// Interned token id in `graph`, u32::MAX if no pool references it
+    #[allow(dead_code)]
+    fn pathfinder_token_id(graph: *const u8, addr20: *const u8) -> u32;
+
     #[allow(dead_code)]
     fn pathfinder_find_best(
         graph:        *const u8,  // *const PoolGraph (opaque)
-        token_in_fp:  u64,
-        token_out_fp: u64,
+        token_in_id:  u32,        // from pathfinder_token_id
+        token_out_id: u32,
         amount_hint:  u64,
         out:          *mut PathfinderResultC,
     ) -> i32;
@@ -116,6 +144,31 @@ extern "C" {
     fn pathfinder_graph_clear(graph: *mut u8);
     #[allow(dead_code)]
     fn pathfinder_graph_size(graph: *const u8) -> u32;
+
+    // Backrun cache — BackrunCache is opaque; allocate backrun_cache_size() bytes
+    #[allow(dead_code)]
+    fn backrun_cache_size() -> usize;
+    #[allow(dead_code)]
+    fn backrun_cache_clear(cache: *mut u8);
+
+    /// Simulate a pending swap and cache its best backrun; 0 or negative BR_E* code
+    #[allow(dead_code)]
+    fn backrun_precompute(
+        cache:       *mut u8,
+        graph:       *mut u8,
+        swap:        *const VictimSwapC,
+        amount_hint: u64,
+        out:         *mut BackrunQuoteC,
+    ) -> i32;
+
+    /// 1 if the cached quote for `tx_hash32` is still valid against `graph`
+    #[allow(dead_code)]
+    fn backrun_lookup(
+        cache:     *mut u8,
+        graph:     *const u8,
+        tx_hash32: *const u8,
+        out:       *mut BackrunQuoteC,
+    ) -> i32;
 }
 
 // ─── Safe wrappers ────────────────────────────────────────────────────────────
@@ -167,8 +220,8 @@ pub fn v3_amount_out(liquidity: u64, sqrt_price_x64: u64, zero_for_one: bool, fe
 
 /// Compute a 64-bit fingerprint of a 20-byte EVM address.
 ///
-/// Use this to convert `ethers::types::Address` bytes to a `u64` before
-/// passing to `pathfinder_find_best`.
+/// The pathfinder itself identifies tokens by graph-local ids
+/// (`pathfinder_token_id`); the fingerprint is only a stable hash key.
 #[inline]
 pub fn token_fingerprint(addr: &[u8; 20]) -> u64 {
     #[cfg(has_c_fast_path)]
@@ -0,0 +1,244 @@
+/**
+ * MEV Protocol - Historical backtest
+ *
+ * Replays a recorded delta stream (delta_stream.h) on top of its start
+ * snapshot (graph_snapshot.h) as fast as possible, runs the pathfinder
+ * every block and reports search latency percentiles, opportunities found
+ * and summed gross profit.  Replay is deterministic: the profit figures
+ * depend only on the inputs and the kernels, so two builds can be compared
+ * run-for-run.
+ *
+ *   backtest_runner <snapshot> <deltas> [options]
+ *   backtest_runner --synth <blocks> [options]   (generate + replay)
+ *
+ * Options:
+ *   --token <hex40>   start/end token of the cycle search (repeatable;
+ *                     default: the token with the most pools)
+ *   --amount <wei>    amount hint passed to the search (default 1e8)
+ *   --seed <n>        RNG seed for --synth (default 1)
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <vector>
+#include "../include/delta_stream.h"
+
+static constexpr uint32_t BT_MAX_START_TOKENS = 8;
+
+static PoolGraph g_graph;
+
+static uint64_t now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static bool parse_addr(const char* hex, uint8_t out[20]) {
+    if (hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) hex += 2;
+    if (strlen(hex) != 40) return false;
+    for (int i = 0; i < 20; ++i) {
+        unsigned v;
+        if (sscanf(hex + 2 * i, "%2x", &v) != 1) return false;
+        out[i] = static_cast<uint8_t>(v);
+    }
+    return true;
+}
+
+/// Id of the token appearing in the most pools
+static uint32_t busiest_token(const PoolGraph& g) {
+    static uint32_t degree[PF_MAX_TOKENS];
+    memset(degree, 0, sizeof(degree));
+    for (uint32_t i = 0; i < g.n_pools; ++i) {
+        ++degree[g.token0_id[i]];
+        ++degree[g.token1_id[i]];
+    }
+    uint32_t best = 0;
+    for (uint32_t t = 1; t < g.tokens.n_tokens; ++t)
+        if (degree[t] > degree[best]) best = t;
+    return best;
+}
+
+// ─── Synthetic data ──────────────────────────────────────────────────────────
+
+static uint64_t xorshift64(uint64_t& s) {
+    s ^= s << 13;
+    s ^= s >> 7;
+    s ^= s << 17;
+    return s;
+}
+
+/// Random pools over 16 tokens, then `n_blocks` blocks in which a handful of
+/// pools random-walk their reserves by up to ±1%.
+static int synthesize(const char* snap_path, const char* delta_path,
+                      uint32_t n_blocks, uint64_t seed) {
+    PoolGraph& g = g_graph;
+    g.clear();
+    uint64_t s = seed ? seed : 1;
+    const uint64_t start_block = 20000000ULL;
+
+    for (uint32_t p = 0; p < 128; ++p) {
+        AMMPool pool{};
+        uint8_t t0 = static_cast<uint8_t>(1 + xorshift64(s) % 16);
+        uint8_t t1 = static_cast<uint8_t>(1 + xorshift64(s) % 16);
+        if (t1 == t0) t1 = static_cast<uint8_t>(1 + t0 % 16);
+        pool.token0[0] = pool.token1[0] = 0xAA;
+        pool.token0[19]    = t0;
+        pool.token1[19]    = t1;
+        pool.pool_addr[0]  = 0xBB;
+        pool.pool_addr[18] = static_cast<uint8_t>(p >> 8);
+        pool.pool_addr[19] = static_cast<uint8_t>(p);
+        pool.reserve0 = 1000000000000ULL + xorshift64(s) % 1000000000000ULL;
+        pool.reserve1 = 1000000000000ULL + xorshift64(s) % 1000000000000ULL;
+        pool.fee_bps  = (p & 3) == 0 ? 500 : 3000;
+        pool.block_updated = start_block;
+        g.upsert(pool);
+    }
+    if (snapshot_save(g, snap_path, start_block) != PF_SNAP_OK) return PF_SNAP_EIO;
+
+    DeltaWriter w;
+    if (w.open(delta_path) != PF_SNAP_OK) return PF_SNAP_EIO;
+    static PoolDelta deltas[PF_MAX_POOLS];
+    for (uint32_t b = 1; b <= n_blocks; ++b) {
+        const uint64_t block = start_block + b;
+        const uint32_t clock = g.version_clock;
+        const uint32_t touched = 1 + static_cast<uint32_t>(xorshift64(s) % 8);
+        for (uint32_t k = 0; k < touched; ++k) {
+            const uint32_t slot = static_cast<uint32_t>(xorshift64(s) % g.n_pools);
+            const int64_t  bps  = static_cast<int64_t>(xorshift64(s) % 201) - 100;
+            const uint64_t r0   = g.reserve0[slot] + g.reserve0[slot] / 10000 * static_cast<uint64_t>(bps);
+            const uint64_t r1   = g.reserve1[slot] - g.reserve1[slot] / 10000 * static_cast<uint64_t>(bps);
+            g.apply_state(slot, r0, r1, 0, block);
+        }
+        uint32_t n = delta_collect(g, clock, deltas, PF_MAX_POOLS);
+        if (w.append(block, deltas, n) != PF_SNAP_OK) return PF_SNAP_EIO;
+    }
+    return w.finish();
+}
+
+// ─── Replay ──────────────────────────────────────────────────────────────────
+
+static uint64_t percentile(const std::vector<uint64_t>& sorted, double q) {
+    if (sorted.empty()) return 0;
+    size_t i = static_cast<size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[i];
+}
+
+static int replay(const char* snap_path, const char* delta_path,
+                  const uint8_t (*start_tokens)[20], uint32_t n_start, uint64_t amount) {
+    PoolGraph& g = g_graph;
+    uint64_t snap_block = 0;
+    int rc = snapshot_load(g, snap_path, &snap_block);
+    if (rc != PF_SNAP_OK) {
+        fprintf(stderr, "backtest: cannot load snapshot %s (%d)\n", snap_path, rc);
+        return 1;
+    }
+    DeltaReader rd;
+    rc = rd.open(delta_path);
+    if (rc != PF_SNAP_OK) {
+        fprintf(stderr, "backtest: cannot open delta stream %s (%d)\n", delta_path, rc);
+        return 1;
+    }
+    // Token ids are only known once the snapshot is interned
+    uint32_t start_ids[BT_MAX_START_TOKENS];
+    for (uint32_t k = 0; k < n_start; ++k) {
+        start_ids[k] = g.tokens.find(start_tokens[k]);
+        if (start_ids[k] == PF_INF) {
+            fprintf(stderr, "backtest: --token #%u is not in the snapshot\n", k + 1);
+            return 1;
+        }
+    }
+    if (n_start == 0) start_ids[n_start++] = busiest_token(g);
+
+    std::vector<uint64_t> lat;
+    lat.reserve(static_cast<size_t>(rd.hdr.n_frames));
+    uint64_t blocks = 0, skipped = 0, applied = 0, found = 0;
+    int64_t  profit = 0;
+    uint64_t digest = 14695981039346656037ULL;   // FNV-1a over per-block results
+
+    uint64_t block = 0;
+    uint32_t n = 0;
+    const PoolDelta* deltas = nullptr;
+    const uint64_t wall0 = now_ns();
+    while (rd.next(block, deltas, n)) {
+        if (block <= snap_block) { ++skipped; continue; }  // already in the snapshot
+        applied += delta_apply(g, block, deltas, n);
+
+        const uint64_t t0 = now_ns();
+        for (uint32_t k = 0; k < n_start; ++k) {
+            PathfinderResult r = find_best_path(g, start_ids[k], start_ids[k], amount);
+            if (r.valid) {
+                ++found;
+                profit += r.gross_profit;
+                digest = (digest ^ static_cast<uint64_t>(r.gross_profit)) * 1099511628211ULL;
+            }
+        }
+        lat.push_back(now_ns() - t0);
+        ++blocks;
+    }
+    const uint64_t wall = now_ns() - wall0;
+    rd.close();
+
+    std::sort(lat.begin(), lat.end());
+    printf("blocks      %llu (skipped %llu at or before snapshot block %llu)\n",
+           (unsigned long long)blocks, (unsigned long long)skipped, (unsigned long long)snap_block);
+    printf("deltas      %llu applied\n", (unsigned long long)applied);
+    printf("search ns   p50 %llu  p90 %llu  p99 %llu  max %llu\n",
+           (unsigned long long)percentile(lat, 0.50), (unsigned long long)percentile(lat, 0.90),
+           (unsigned long long)percentile(lat, 0.99), (unsigned long long)(lat.empty() ? 0 : lat.back()));
+    printf("found       %llu opportunities over %u start token(s)\n",
+           (unsigned long long)found, n_start);
+    printf("profit      %lld (digest %016llx)\n", (long long)profit, (unsigned long long)digest);
+    printf("replay      %.1f ms wall\n", static_cast<double>(wall) / 1e6);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* paths[2] = { nullptr, nullptr };
+    uint32_t n_paths = 0;
+    uint32_t synth_blocks = 0;
+    uint64_t seed = 1, amount = 100000000ULL;
+    uint8_t  start_tokens[BT_MAX_START_TOKENS][20];
+    uint32_t n_start = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool has_arg = i + 1 < argc;
+        if (!strcmp(argv[i], "--synth") && has_arg) {
+            synth_blocks = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (!strcmp(argv[i], "--seed") && has_arg) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--amount") && has_arg) {
+            amount = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--token") && has_arg) {
+            if (n_start == BT_MAX_START_TOKENS || !parse_addr(argv[++i], start_tokens[n_start])) {
+                fprintf(stderr, "backtest: bad or too many --token values\n");
+                return 2;
+            }
+            ++n_start;
+        } else if (argv[i][0] != '-' && n_paths < 2) {
+            paths[n_paths++] = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s <snapshot> <deltas> | --synth <blocks> "
+                            "[--token <hex40>] [--amount <wei>] [--seed <n>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (synth_blocks) {
+        paths[0] = "bench/backtest_synth.snap";
+        paths[1] = "bench/backtest_synth.dlt";
+        if (synthesize(paths[0], paths[1], synth_blocks, seed) != PF_SNAP_OK) {
+            fprintf(stderr, "backtest: cannot write synthetic data\n");
+            return 1;
+        }
+    } else if (n_paths != 2) {
+        fprintf(stderr, "usage: %s <snapshot> <deltas> | --synth <blocks>\n", argv[0]);
+        return 2;
+    }
+
+    printf("MEV Protocol - Backtest\n");
+    printf("=======================\n");
+    return replay(paths[0], paths[1], start_tokens, n_start, amount);
+}
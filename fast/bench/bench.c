@@ -0,0 +1,832 @@
+/**
+ * MEV Protocol - C Hot Path Benchmarks
+ *
+ * Queue transfer: one producer thread hands N items to one consumer thread
+ * through each queue flavour.  Reported per item: wall-clock ns and
+ * hardware cache misses (both threads, via perf_event_open; "n/a" when the
+ * kernel or container does not expose the PMU).
+ *
+ * Record transfer: the same hand-off with a 128-byte record per item, either
+ * as a mev_alloc_result() buffer sent by pointer through mev_queue_t, or
+ * written in place into a mev_recq_t slot.
+ *
+ * Fan-out: one producer hands every 128-byte record to 3 consumers, either
+ * written once into a mev_bcast_t and read in place by all of them, or
+ * copied into one mev_recq_t per consumer.
+ *
+ * Pool alloc/free: 4 threads each allocate and free 512-byte tx buffers in
+ * runs of 8, through the shared pool only or through per-thread magazines.
+ * Reported: ns per alloc+free pair and shared-pool CAS retries per pair.
+ * Then the same runs with sizes cycling from 100 B to 96 KB, through
+ * mev_alloc / mev_free (size classes) and through malloc / free.
+ *
+ * Per-block allocation: 4096 buffers of 64 B .. 2 KB per simulated block,
+ * all dead at its end — each freed through mev_free, or bump-allocated from
+ * the region and released by one mev_region_reset.
+ *
+ * Priority queue: 4 producers push opportunities with random profits to one
+ * consumer, through mev_queue_t (FIFO) and mev_pq_t (multi-queue).
+ *
+ * Wake latency: a producer pushes a timestamp every ~100 µs; the consumer
+ * waits by pure spinning, by nanosleep polling, or with mev_queue_pop_wait
+ * (spin → yield → futex).  Reported: p50 / p99 push-to-pop latency and the
+ * consumer's CPU time as a share of wall time.
+ *
+ * Cross-process round trip: a forked child echoes 256-byte messages (a
+ * typical pending tx) back to the parent, through a pair of mev_shmq_t
+ * rings in /dev/shm or through a UNIX SOCK_SEQPACKET socket pair.
+ * Reported: p50 / p99 round-trip time.
+ *
+ *   bench_runner [items]        (default 10M)
+ *
+ * Threads are pinned to CPUs 0 and 1 when the machine has at least two.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "../include/lockfree_queue.h"
+#include "../include/spsc_queue.h"
+#include "../include/queue_wait.h"
+#include "../include/record_queue.h"
+#include "../include/memory_pool.h"
+#include "../include/region.h"
+#include "../include/priority_queue.h"
+#include "../include/segmented_queue.h"
+#include "../include/broadcast_ring.h"
+#include "../include/simd_utils.h"
+#include "../include/shm_queue.h"
+
+#define BENCH_CAPACITY 4096
+#define BENCH_BATCH    32
+#define RECORD_SIZE    128
+#define RECORD_CAPACITY 256   /* in-flight records stay within the result pool's 1024 */
+#define FANOUT_READERS 3
+#define PQ_PRODUCERS   4
+#define POOL_THREADS   4
+#define POOL_RUN       8
+#define BLOCK_ALLOCS   4096
+#define WAKE_ROUNDS    2000
+#define WAKE_GAP_NS    100000
+#define IPC_ROUNDS     20000
+#define IPC_MSG        256
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void pin_to_cpu(int cpu) {
+#ifdef __linux__
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+/* Spin briefly, then give the CPU away (matters when both threads share one core) */
+static inline void backoff(unsigned* spins) {
+    if (++*spins < 64) { mev_cpu_pause(); return; }
+    *spins = 0;
+    sched_yield();
+}
+
+// ─── Cache-miss counter ──────────────────────────────────────────────────────
+
+/* Counts this thread and every thread it creates afterwards (inherit);
+ * child counts are folded in when the children exit.  -1 if unavailable. */
+static int miss_counter_open(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled       = 1;
+    attr.inherit        = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+static int64_t miss_counter_close(int fd) {
+    if (fd < 0) return -1;
+    int64_t v = -1;
+#ifdef __linux__
+    uint64_t count;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &count, sizeof(count)) == (ssize_t)sizeof(count)) v = (int64_t)count;
+#endif
+    close(fd);
+    return v;
+}
+
+// ─── Queue transfer ──────────────────────────────────────────────────────────
+
+typedef enum { Q_MPMC, Q_MPMC_STATS, Q_MPMC_BATCH, Q_SPSC, Q_SPSC_BATCH, Q_SEGQ } queue_kind_t;
+
+typedef struct {
+    queue_kind_t kind;
+    void*        q;
+    uint64_t     n_items;
+} transfer_args_t;
+
+/* Items are 1..n so NULL keeps meaning "empty" */
+static void* transfer_producer(void* arg) {
+    transfer_args_t* a = (transfer_args_t*)arg;
+    pin_to_cpu(1);
+    void* batch[BENCH_BATCH];
+    unsigned spins = 0;
+    uint64_t i = 1;
+    while (i <= a->n_items) {
+        switch (a->kind) {
+        case Q_MPMC:
+        case Q_MPMC_STATS:
+            if (mev_queue_push((mev_queue_t*)a->q, (void*)(uintptr_t)i) == 0) ++i;
+            else backoff(&spins);
+            break;
+        case Q_SPSC:
+            if (mev_spsc_push((mev_spsc_t*)a->q, (void*)(uintptr_t)i) == 0) ++i;
+            else backoff(&spins);
+            break;
+        case Q_SEGQ:
+            if (mev_segq_push((mev_segq_t*)a->q, (void*)(uintptr_t)i) == 0) ++i;
+            else backoff(&spins);
+            break;
+        case Q_MPMC_BATCH:
+        case Q_SPSC_BATCH: {
+            size_t n = 0;
+            while (n < BENCH_BATCH && i + n <= a->n_items) {
+                batch[n] = (void*)(uintptr_t)(i + n);
+                ++n;
+            }
+            size_t done = 0;
+            while (done < n) {
+                size_t k = a->kind == Q_MPMC_BATCH
+                    ? mev_queue_push_batch((mev_queue_t*)a->q, batch + done, n - done)
+                    : mev_spsc_push_batch((mev_spsc_t*)a->q, batch + done, n - done);
+                if (k == 0) backoff(&spins);
+                done += k;
+            }
+            i += n;
+            break;
+        }
+        }
+    }
+    return NULL;
+}
+
+/* Consumer runs on the calling thread; returns 0 if items arrived in order */
+static int transfer_consume(const transfer_args_t* a) {
+    void* batch[BENCH_BATCH];
+    unsigned spins = 0;
+    uint64_t expect = 1;
+    while (expect <= a->n_items) {
+        size_t n = 0;
+        switch (a->kind) {
+        case Q_MPMC:
+        case Q_MPMC_STATS:
+            batch[0] = mev_queue_pop((mev_queue_t*)a->q);
+            n = batch[0] != NULL;
+            break;
+        case Q_MPMC_BATCH:
+            n = mev_queue_pop_batch((mev_queue_t*)a->q, batch, BENCH_BATCH);
+            break;
+        case Q_SPSC:
+            batch[0] = mev_spsc_pop((mev_spsc_t*)a->q);
+            n = batch[0] != NULL;
+            break;
+        case Q_SPSC_BATCH:
+            n = mev_spsc_pop_batch((mev_spsc_t*)a->q, batch, BENCH_BATCH);
+            break;
+        case Q_SEGQ:
+            batch[0] = mev_segq_pop((mev_segq_t*)a->q);
+            n = batch[0] != NULL;
+            break;
+        }
+        if (n == 0) { backoff(&spins); continue; }
+        for (size_t k = 0; k < n; ++k)
+            if ((uintptr_t)batch[k] != expect++) return -1;
+    }
+    return 0;
+}
+
+static void bench_transfer(const char* name, queue_kind_t kind, uint64_t n_items) {
+    transfer_args_t a = { kind, NULL, n_items };
+    const int mpmc = kind == Q_MPMC || kind == Q_MPMC_STATS || kind == Q_MPMC_BATCH;
+    if (kind == Q_SEGQ) a.q = mev_segq_create(0);
+    else a.q = mpmc ? (void*)mev_queue_create(BENCH_CAPACITY)
+                    : (void*)mev_spsc_create(BENCH_CAPACITY);
+    if (!a.q) { printf("  %-24s create failed\n", name); return; }
+    if (kind == Q_MPMC_STATS) mev_queue_enable_stats((mev_queue_t*)a.q, 6);
+
+    int fd = miss_counter_open();
+    uint64_t t0 = now_ns();
+    pthread_t producer;
+    pthread_create(&producer, NULL, transfer_producer, &a);
+    int rc = transfer_consume(&a);
+    pthread_join(producer, NULL);
+    uint64_t elapsed = now_ns() - t0;
+    int64_t misses = miss_counter_close(fd);
+
+    size_t high_water = 0;
+    mev_queue_stats_t st;
+    int have_stats = kind == Q_MPMC_STATS && mev_queue_stats((mev_queue_t*)a.q, &st) == 0;
+    if (kind == Q_SEGQ) {
+        mev_segq_stats((mev_segq_t*)a.q, NULL, &high_water, NULL);
+        mev_segq_destroy((mev_segq_t*)a.q);
+    } else if (mpmc) mev_queue_destroy((mev_queue_t*)a.q);
+    else mev_spsc_destroy((mev_spsc_t*)a.q);
+
+    printf("  %-24s %8.2f ns/op", name, (double)elapsed / (double)n_items);
+    if (misses >= 0) printf("  %8.3f misses/op", (double)misses / (double)n_items);
+    else             printf("  %8s misses/op", "n/a");
+    if (high_water) printf("  peak %zu segments", high_water);
+    if (have_stats) {
+        /* Median sojourn from the log2 histogram (bucket lower bound) */
+        uint64_t seen = 0;
+        int b = 0;
+        while (b < MEV_QUEUE_LAT_BUCKETS - 1 && (seen += st.sojourn[b]) * 2 < st.sampled) ++b;
+        printf("  full %llu  hw %llu  sojourn p50 >= %.0f ns", (unsigned long long)st.full,
+               (unsigned long long)st.high_water,
+               st.ticks_per_ns > 0.0 ? (double)(1ULL << b) / st.ticks_per_ns : 0.0);
+    }
+    printf("%s\n", rc == 0 ? "" : "  ORDER VIOLATION");
+}
+
+// ─── Record transfer ─────────────────────────────────────────────────────────
+
+typedef struct {
+    int      inline_records;   /* 1: mev_recq_t, 0: mev_queue_t + result pool */
+    void*    q;
+    uint64_t n_items;
+} record_args_t;
+
+static void* record_producer(void* arg) {
+    record_args_t* a = (record_args_t*)arg;
+    pin_to_cpu(1);
+    unsigned spins = 0;
+    for (uint64_t i = 1; i <= a->n_items; ) {
+        if (a->inline_records) {
+            size_t t;
+            uint64_t* r = (uint64_t*)mev_recq_claim((mev_recq_t*)a->q, &t);
+            if (!r) { backoff(&spins); continue; }
+            r[0] = i;
+            memset(r + 1, (int)i, RECORD_SIZE - sizeof(uint64_t));
+            mev_recq_commit((mev_recq_t*)a->q, t);
+        } else {
+            uint64_t* r = (uint64_t*)mev_alloc_result();
+            r[0] = i;
+            memset(r + 1, (int)i, RECORD_SIZE - sizeof(uint64_t));
+            while (mev_queue_push((mev_queue_t*)a->q, r) != 0) backoff(&spins);
+        }
+        ++i;
+    }
+    return NULL;
+}
+
+static void bench_records(const char* name, int inline_records, uint64_t n_items) {
+    record_args_t a = { inline_records, NULL, n_items };
+    a.q = inline_records ? (void*)mev_recq_create(RECORD_CAPACITY, RECORD_SIZE)
+                         : (void*)mev_queue_create(RECORD_CAPACITY);
+    if (!a.q) { printf("  %-24s create failed\n", name); return; }
+
+    int fd = miss_counter_open();
+    uint64_t t0 = now_ns();
+    pthread_t producer;
+    pthread_create(&producer, NULL, record_producer, &a);
+    uint64_t bad = 0;
+    unsigned spins = 0;
+    uint64_t sum = 0;
+    for (uint64_t expect = 1; expect <= n_items; ) {
+        const uint64_t* r;
+        size_t t;
+        if (inline_records) r = (const uint64_t*)mev_recq_acquire((mev_recq_t*)a.q, &t);
+        else                r = (const uint64_t*)mev_queue_pop((mev_queue_t*)a.q);
+        if (!r) { backoff(&spins); continue; }
+        bad += r[0] != expect++;
+        sum += ((const uint8_t*)r)[RECORD_SIZE - 1];    /* touch the tail of the record */
+        if (inline_records) mev_recq_release((mev_recq_t*)a.q, t);
+        else                mev_free_result((void*)r);
+    }
+    pthread_join(producer, NULL);
+    uint64_t elapsed = now_ns() - t0;
+    int64_t misses = miss_counter_close(fd);
+    (void)sum;
+
+    if (inline_records) mev_recq_destroy((mev_recq_t*)a.q);
+    else mev_queue_destroy((mev_queue_t*)a.q);
+
+    printf("  %-24s %8.2f ns/op", name, (double)elapsed / (double)n_items);
+    if (misses >= 0) printf("  %8.3f misses/op", (double)misses / (double)n_items);
+    else             printf("  %8s misses/op", "n/a");
+    /* Guard against the pool handing one buffer to two owners */
+    if (bad) printf("  %llu records clobbered", (unsigned long long)bad);
+    printf("\n");
+}
+
+// ─── Fan-out ─────────────────────────────────────────────────────────────────
+
+typedef struct {
+    int          broadcast;    /* 1: one mev_bcast_t, 0: one mev_recq_t per reader */
+    mev_bcast_t* b;
+    mev_recq_t*  q[FANOUT_READERS];
+    int          id;           /* reader index / bcast consumer id */
+    uint64_t     n_items;
+    uint64_t     bad;          /* out: records out of order */
+} fanout_args_t;
+
+static void* fanout_reader(void* arg) {
+    fanout_args_t* a = (fanout_args_t*)arg;
+    unsigned spins = 0;
+    uint64_t sum = 0;
+    for (uint64_t expect = 1; expect <= a->n_items; ) {
+        if (a->broadcast) {
+            const void* first;
+            size_t n = mev_bcast_read(a->b, a->id, &first, BENCH_BATCH);
+            if (!n) { backoff(&spins); continue; }
+            const size_t stride = mev_bcast_stride(a->b);
+            for (size_t k = 0; k < n; k++) {
+                const uint64_t* r = (const uint64_t*)((const uint8_t*)first + k * stride);
+                a->bad += r[0] != expect++;
+                sum += ((const uint8_t*)r)[RECORD_SIZE - 1];
+            }
+            mev_bcast_release(a->b, a->id, n);
+        } else {
+            size_t t;
+            const uint64_t* r = (const uint64_t*)mev_recq_acquire(a->q[a->id], &t);
+            if (!r) { backoff(&spins); continue; }
+            a->bad += r[0] != expect++;
+            sum += ((const uint8_t*)r)[RECORD_SIZE - 1];
+            mev_recq_release(a->q[a->id], t);
+        }
+    }
+    (void)sum;
+    return NULL;
+}
+
+static void bench_fanout(const char* name, int broadcast, uint64_t n_items) {
+    fanout_args_t a[FANOUT_READERS];
+    pthread_t t[FANOUT_READERS];
+    mev_bcast_t* b = NULL;
+    mev_recq_t* q[FANOUT_READERS] = { NULL };
+    if (broadcast) {
+        b = mev_bcast_create(RECORD_CAPACITY, RECORD_SIZE, FANOUT_READERS);
+        if (!b) { printf("  %-24s create failed\n", name); return; }
+    } else {
+        for (int i = 0; i < FANOUT_READERS; i++) {
+            q[i] = mev_recq_create(RECORD_CAPACITY, RECORD_SIZE);
+            if (!q[i]) { printf("  %-24s create failed\n", name); return; }
+        }
+    }
+
+    int fd = miss_counter_open();
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < FANOUT_READERS; i++) {
+        a[i] = (fanout_args_t){ broadcast, b, { NULL }, broadcast ? mev_bcast_subscribe(b) : i, n_items, 0 };
+        memcpy(a[i].q, q, sizeof(q));
+        pthread_create(&t[i], NULL, fanout_reader, &a[i]);
+    }
+    unsigned spins = 0;
+    for (uint64_t i = 1; i <= n_items; ) {
+        if (broadcast) {
+            uint64_t* r = (uint64_t*)mev_bcast_claim(b);
+            if (!r) { mev_bcast_publish(b); backoff(&spins); continue; }
+            r[0] = i;
+            memset(r + 1, (int)i, RECORD_SIZE - sizeof(uint64_t));
+            if ((i & (BENCH_BATCH - 1)) == 0 || i == n_items) mev_bcast_publish(b);
+        } else {
+            for (int k = 0; k < FANOUT_READERS; k++) {
+                size_t tk;
+                uint64_t* r;
+                while (!(r = (uint64_t*)mev_recq_claim(q[k], &tk))) backoff(&spins);
+                r[0] = i;
+                memset(r + 1, (int)i, RECORD_SIZE - sizeof(uint64_t));
+                mev_recq_commit(q[k], tk);
+            }
+        }
+        ++i;
+    }
+    uint64_t bad = 0;
+    for (int i = 0; i < FANOUT_READERS; i++) {
+        pthread_join(t[i], NULL);
+        bad += a[i].bad;
+    }
+    uint64_t elapsed = now_ns() - t0;
+    int64_t misses = miss_counter_close(fd);
+
+    if (broadcast) mev_bcast_destroy(b);
+    else for (int i = 0; i < FANOUT_READERS; i++) mev_recq_destroy(q[i]);
+
+    printf("  %-24s %8.2f ns/op", name, (double)elapsed / (double)n_items);
+    if (misses >= 0) printf("  %8.3f misses/op", (double)misses / (double)n_items);
+    else             printf("  %8s misses/op", "n/a");
+    if (bad) printf("  %llu records out of order", (unsigned long long)bad);
+    printf("\n");
+}
+
+// ─── Pool alloc/free ─────────────────────────────────────────────────────────
+
+static void* pool_worker(void* arg) {
+    uint64_t n = *(const uint64_t*)arg;
+    void* held[POOL_RUN];
+    for (uint64_t i = 0; i < n; i += POOL_RUN) {
+        for (int k = 0; k < POOL_RUN; k++) {
+            held[k] = mev_alloc_tx();
+            *(volatile uint8_t*)held[k] = (uint8_t)k;
+        }
+        for (int k = 0; k < POOL_RUN; k++) mev_free_tx(held[k]);
+    }
+    return NULL;
+}
+
+static void bench_pool(const char* name, int magazines, uint64_t n_items) {
+    mev_pools_set_magazines(magazines);
+    mev_pool_contention_t c0, c1;
+    mev_pool_contention(&c0, NULL, NULL);
+
+    uint64_t per = n_items / POOL_THREADS;
+    pthread_t t[POOL_THREADS];
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < POOL_THREADS; i++) pthread_create(&t[i], NULL, pool_worker, &per);
+    for (int i = 0; i < POOL_THREADS; i++) pthread_join(t[i], NULL);
+    uint64_t elapsed = now_ns() - t0;
+
+    mev_pool_contention(&c1, NULL, NULL);
+    const double pairs = (double)(per * POOL_THREADS);
+    printf("  %-24s %8.2f ns/op  %8.4f cas retries/op  refills %zu  spills %zu\n", name,
+           (double)elapsed / pairs, (double)(c1.cas_retries - c0.cas_retries) / pairs,
+           c1.refills - c0.refills, c1.spills - c0.spills);
+    mev_pools_set_magazines(1);
+}
+
+// Mixed sizes: calldata-like requests from 100 B to 96 KB, mev_alloc vs malloc
+static const size_t g_mixed_sizes[POOL_RUN] = { 100, 300, 600, 2000, 3500, 9000, 30000, 96000 };
+
+typedef struct {
+    int      use_pool;
+    uint64_t n;
+} mixed_args_t;
+
+static void* mixed_worker(void* arg) {
+    const mixed_args_t* a = (const mixed_args_t*)arg;
+    void* held[POOL_RUN];
+    for (uint64_t i = 0; i < a->n; i += POOL_RUN) {
+        for (int k = 0; k < POOL_RUN; k++) {
+            const size_t size = g_mixed_sizes[(i / POOL_RUN + k) % POOL_RUN];
+            held[k] = a->use_pool ? mev_alloc(size) : malloc(size);
+            *(volatile uint8_t*)held[k] = (uint8_t)k;
+        }
+        for (int k = 0; k < POOL_RUN; k++) {
+            if (a->use_pool) mev_free(held[k]);
+            else             free(held[k]);
+        }
+    }
+    return NULL;
+}
+
+static void bench_alloc_mixed(const char* name, int use_pool, uint64_t n_items) {
+    mixed_args_t a = { use_pool, n_items / POOL_THREADS };
+    pthread_t t[POOL_THREADS];
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < POOL_THREADS; i++) pthread_create(&t[i], NULL, mixed_worker, &a);
+    for (int i = 0; i < POOL_THREADS; i++) pthread_join(t[i], NULL);
+    uint64_t elapsed = now_ns() - t0;
+    printf("  %-24s %8.2f ns/op\n", name, (double)elapsed / (double)(a.n * POOL_THREADS));
+}
+
+// ─── Per-block allocation ────────────────────────────────────────────────────
+
+// One "block": BLOCK_ALLOCS buffers of 64 B .. 2 KB, all dead at the block's end
+static void bench_block_alloc(const char* name, int use_region, uint64_t n_items) {
+    static void* held[BLOCK_ALLOCS];
+    const uint64_t n_blocks = n_items / BLOCK_ALLOCS ? n_items / BLOCK_ALLOCS : 1;
+    uint64_t t0 = now_ns();
+    for (uint64_t b = 0; b < n_blocks; b++) {
+        for (int k = 0; k < BLOCK_ALLOCS; k++) {
+            const size_t size = (size_t)64 << (k % 6);
+            held[k] = use_region ? mev_region_alloc(size) : mev_alloc(size);
+            *(volatile uint8_t*)held[k] = (uint8_t)k;
+        }
+        if (use_region) {
+            mev_region_reset(b + 1);
+        } else {
+            for (int k = 0; k < BLOCK_ALLOCS; k++) mev_free(held[k]);
+        }
+    }
+    uint64_t elapsed = now_ns() - t0;
+    printf("  %-24s %8.2f ns/alloc\n", name, (double)elapsed / (double)(n_blocks * BLOCK_ALLOCS));
+}
+
+// ─── Priority queue ──────────────────────────────────────────────────────────
+
+typedef struct {
+    int      use_pq;
+    void*    q;
+    uint64_t n_items;
+    uint64_t seed;
+    uint64_t shed;     /* out: items dropped by the priority queue */
+    int*     n_done;   /* producers finished, shared */
+} pq_args_t;
+
+static void* pq_producer(void* arg) {
+    pq_args_t* a = (pq_args_t*)arg;
+    unsigned spins = 0;
+    uint64_t s = a->seed;
+    for (uint64_t i = 0; i < a->n_items; ) {
+        s ^= s << 13; s ^= s >> 7; s ^= s << 17;
+        void* item = (void*)(uintptr_t)(i + 1);
+        if (a->use_pq) {
+            a->shed += (uint64_t)mev_pq_push((mev_pq_t*)a->q, (int64_t)(s % 1000000), s % 64, item, NULL);
+        } else {
+            while (mev_queue_push((mev_queue_t*)a->q, item) != 0) backoff(&spins);
+        }
+        ++i;
+    }
+    __atomic_add_fetch(a->n_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void bench_pq(const char* name, int use_pq, uint64_t n_items) {
+    pq_args_t a[PQ_PRODUCERS];
+    pthread_t t[PQ_PRODUCERS];
+    void* q = use_pq ? (void*)mev_pq_create(BENCH_CAPACITY, 8) : (void*)mev_queue_create(BENCH_CAPACITY);
+    if (!q) { printf("  %-24s create failed\n", name); return; }
+    const uint64_t per = n_items / PQ_PRODUCERS;
+    int n_done = 0;
+
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < PQ_PRODUCERS; i++) {
+        a[i] = (pq_args_t){ use_pq, q, per, 0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1), 0, &n_done };
+        pthread_create(&t[i], NULL, pq_producer, &a[i]);
+    }
+    uint64_t popped = 0;
+    unsigned spins = 0;
+    for (;;) {
+        void* item = use_pq ? mev_pq_pop((mev_pq_t*)q, NULL, NULL) : mev_queue_pop((mev_queue_t*)q);
+        if (item) { ++popped; continue; }
+        // Empty after every producer finished: nothing more can arrive
+        if (__atomic_load_n(&n_done, __ATOMIC_ACQUIRE) == PQ_PRODUCERS) {
+            item = use_pq ? mev_pq_pop((mev_pq_t*)q, NULL, NULL) : mev_queue_pop((mev_queue_t*)q);
+            if (!item) break;
+            ++popped;
+            continue;
+        }
+        backoff(&spins);
+    }
+    uint64_t shed = 0;
+    for (int i = 0; i < PQ_PRODUCERS; i++) {
+        pthread_join(t[i], NULL);
+        shed += a[i].shed;
+    }
+    uint64_t elapsed = now_ns() - t0;
+
+    if (use_pq) mev_pq_destroy((mev_pq_t*)q);
+    else mev_queue_destroy((mev_queue_t*)q);
+
+    const uint64_t total = per * PQ_PRODUCERS;
+    printf("  %-24s %8.2f ns/op  %6.2f Mops/s  shed %llu%s\n", name,
+           (double)elapsed / (double)total, (double)total * 1e3 / (double)elapsed,
+           (unsigned long long)shed, popped + shed == total ? "" : "  LOST ITEMS");
+}
+
+// ─── Wake latency ────────────────────────────────────────────────────────────
+
+typedef enum { W_SPIN, W_SLEEP, W_FUTEX } wait_kind_t;
+
+typedef struct {
+    mev_queue_t* q;
+    mev_wait_t*  w;
+} wake_args_t;
+
+static void* wake_producer(void* arg) {
+    wake_args_t* a = (wake_args_t*)arg;
+    pin_to_cpu(1);
+    for (int r = 0; r < WAKE_ROUNDS; r++) {
+        struct timespec gap = { 0, WAKE_GAP_NS };
+        nanosleep(&gap, NULL);
+        uint64_t stamp = now_ns();
+        while (mev_queue_push(a->q, (void*)(uintptr_t)stamp) != 0) mev_cpu_pause();
+        mev_wait_notify(a->w);
+    }
+    return NULL;
+}
+
+static int cmp_u64(const void* x, const void* y) {
+    uint64_t a = *(const uint64_t*)x, b = *(const uint64_t*)y;
+    return a < b ? -1 : a > b;
+}
+
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void bench_wake(const char* name, wait_kind_t kind) {
+    static uint64_t lat[WAKE_ROUNDS];
+    wake_args_t a = { mev_queue_create(64), mev_wait_create() };
+    if (!a.q || !a.w) { printf("  %-24s create failed\n", name); return; }
+
+    uint64_t wall0 = now_ns(), cpu0 = thread_cpu_ns();
+    pthread_t producer;
+    pthread_create(&producer, NULL, wake_producer, &a);
+    for (int r = 0; r < WAKE_ROUNDS; r++) {
+        void* item = NULL;
+        switch (kind) {
+        case W_SPIN:
+            while (!(item = mev_queue_pop(a.q))) mev_cpu_pause();
+            break;
+        case W_SLEEP:
+            while (!(item = mev_queue_pop(a.q))) {
+                struct timespec ts = { 0, 1000 };   /* 1 µs, as test_queue_stress does */
+                nanosleep(&ts, NULL);
+            }
+            break;
+        case W_FUTEX:
+            item = mev_queue_pop_wait(a.q, a.w, -1);
+            break;
+        }
+        lat[r] = now_ns() - (uint64_t)(uintptr_t)item;
+    }
+    pthread_join(producer, NULL);
+    uint64_t wall = now_ns() - wall0, cpu = thread_cpu_ns() - cpu0;
+
+    uint64_t wakes, parks;
+    mev_wait_stats(a.w, &wakes, &parks);
+    mev_wait_destroy(a.w);
+    mev_queue_destroy(a.q);
+
+    qsort(lat, WAKE_ROUNDS, sizeof(lat[0]), cmp_u64);
+    printf("  %-24s p50 %7llu ns  p99 %8llu ns  consumer cpu %5.1f%%  parks %llu\n", name,
+           (unsigned long long)lat[WAKE_ROUNDS / 2],
+           (unsigned long long)lat[WAKE_ROUNDS * 99 / 100],
+           100.0 * (double)cpu / (double)wall, (unsigned long long)parks);
+}
+
+// ─── Cross-process round trip ────────────────────────────────────────────────
+
+#define IPC_REQ "/mev_bench_req"
+#define IPC_RSP "/mev_bench_rsp"
+
+/* Child side: echo IPC_ROUNDS messages, over shm if `sock` < 0 */
+static void ipc_echo(int sock) {
+    pin_to_cpu(1);
+    uint8_t buf[IPC_MSG];
+    if (sock >= 0) {
+        for (int r = 0; r < IPC_ROUNDS; r++) {
+            ssize_t n = read(sock, buf, sizeof(buf));
+            if (n <= 0 || write(sock, buf, (size_t)n) != n) _exit(1);
+        }
+        _exit(0);
+    }
+    mev_shmq_t* req = mev_shmq_open(IPC_REQ);
+    mev_shmq_t* rsp = mev_shmq_open(IPC_RSP);
+    if (!req || !rsp) _exit(1);
+    unsigned spins = 0;
+    for (int r = 0; r < IPC_ROUNDS; r++) {
+        int n;
+        while ((n = mev_shmq_recv(req, buf, sizeof(buf))) < 0) backoff(&spins);
+        while (mev_shmq_send(rsp, buf, (uint32_t)n) != 0) backoff(&spins);
+    }
+    mev_shmq_close(req);
+    mev_shmq_close(rsp);
+    _exit(0);
+}
+
+static void bench_ipc(const char* name, int use_socket) {
+    static uint64_t rtt[IPC_ROUNDS];
+    mev_shmq_t* req = NULL;
+    mev_shmq_t* rsp = NULL;
+    int sv[2] = { -1, -1 };
+    if (use_socket) {
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) != 0) { printf("  %-24s socketpair failed\n", name); return; }
+    } else {
+        req = mev_shmq_create(IPC_REQ, MEV_SHMQ_SPSC, 64 * 1024, 0);
+        rsp = mev_shmq_create(IPC_RSP, MEV_SHMQ_SPSC, 64 * 1024, 0);
+        if (!req || !rsp) { printf("  %-24s shm create failed\n", name); return; }
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) ipc_echo(use_socket ? sv[1] : -1);
+
+    uint8_t msg[IPC_MSG], buf[IPC_MSG];
+    memset(msg, 0x5A, sizeof(msg));
+    unsigned spins = 0;
+    int ok = pid > 0;
+    for (int r = 0; ok && r < IPC_ROUNDS; r++) {
+        uint64_t t0 = now_ns();
+        if (use_socket) {
+            ok = write(sv[0], msg, sizeof(msg)) == (ssize_t)sizeof(msg) &&
+                 read(sv[0], buf, sizeof(buf)) == (ssize_t)sizeof(buf);
+        } else {
+            while (mev_shmq_send(req, msg, sizeof(msg)) != 0) backoff(&spins);
+            while (mev_shmq_recv(rsp, buf, sizeof(buf)) < 0) backoff(&spins);
+        }
+        rtt[r] = now_ns() - t0;
+    }
+    int status = 1;
+    if (pid > 0) waitpid(pid, &status, 0);
+
+    if (use_socket) {
+        close(sv[0]);
+        close(sv[1]);
+    } else {
+        mev_shmq_close(req);
+        mev_shmq_close(rsp);
+        mev_shmq_unlink(IPC_REQ);
+        mev_shmq_unlink(IPC_RSP);
+    }
+    if (!ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0) { printf("  %-24s echo failed\n", name); return; }
+
+    qsort(rtt, IPC_ROUNDS, sizeof(rtt[0]), cmp_u64);
+    printf("  %-24s p50 %7llu ns  p99 %8llu ns\n", name,
+           (unsigned long long)rtt[IPC_ROUNDS / 2],
+           (unsigned long long)rtt[IPC_ROUNDS * 99 / 100]);
+}
+
+int main(int argc, char** argv) {
+    uint64_t n_items = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000ULL;
+    if (n_items == 0) n_items = 1;
+
+    printf("MEV Protocol - C Hot Path Benchmarks\n");
+    printf("====================================\n");
+    pin_to_cpu(0);
+
+    printf("\nQueue transfer, 1 producer -> 1 consumer, %llu items, capacity %d\n",
+           (unsigned long long)n_items, BENCH_CAPACITY);
+    bench_transfer("mev_queue push/pop",   Q_MPMC,       n_items);
+    bench_transfer("mev_queue + stats 1/64", Q_MPMC_STATS, n_items);
+    bench_transfer("mev_queue batch x32",  Q_MPMC_BATCH, n_items);
+    bench_transfer("mev_spsc push/pop",    Q_SPSC,       n_items);
+    bench_transfer("mev_spsc batch x32",   Q_SPSC_BATCH, n_items);
+    bench_transfer("mev_segq (unbounded)", Q_SEGQ,       n_items);
+
+    mev_pools_init();
+    printf("\nRecord transfer, %d-byte records, %llu items, capacity %d\n",
+           RECORD_SIZE, (unsigned long long)n_items, RECORD_CAPACITY);
+    bench_records("mev_queue + result pool", 0, n_items);
+    bench_records("mev_recq in place",       1, n_items);
+
+    printf("\nFan-out, 1 producer -> %d consumers, %d-byte records, %llu items, capacity %d\n",
+           FANOUT_READERS, RECORD_SIZE, (unsigned long long)n_items, RECORD_CAPACITY);
+    bench_fanout("mev_recq per consumer",   0, n_items);
+    bench_fanout("mev_bcast in place",      1, n_items);
+
+    printf("\nPool alloc/free, %d threads, %llu pairs, runs of %d\n",
+           POOL_THREADS, (unsigned long long)n_items, POOL_RUN);
+    bench_pool("shared pool only",         0, n_items);
+    bench_pool("per-thread magazines",     1, n_items);
+    printf("  mixed sizes 100 B .. 96 KB:\n");
+    bench_alloc_mixed("mev_alloc / mev_free",  1, n_items);
+    bench_alloc_mixed("malloc / free",         0, n_items);
+
+    mev_region_init(0, 0, MEV_ARENA_DEFAULT);
+    printf("\nPer-block allocation, %d buffers of 64 B .. 2 KB per block, %llu allocations\n",
+           BLOCK_ALLOCS, (unsigned long long)n_items);
+    bench_block_alloc("mev_alloc + mev_free each", 0, n_items);
+    bench_block_alloc("region + reset per block", 1, n_items);
+
+    printf("\nPriority queue, %d producers -> 1 consumer, %llu items, capacity %d\n",
+           PQ_PRODUCERS, (unsigned long long)n_items, BENCH_CAPACITY);
+    bench_pq("mev_queue (FIFO)",         0, n_items);
+    bench_pq("mev_pq (8 shards)",        1, n_items);
+
+    printf("\nWake latency, %d pushes %d us apart\n", WAKE_ROUNDS, WAKE_GAP_NS / 1000);
+    bench_wake("spin (mev_cpu_pause)",    W_SPIN);
+    bench_wake("poll (nanosleep 1us)",    W_SLEEP);
+    bench_wake("mev_queue_pop_wait",      W_FUTEX);
+
+    printf("\nCross-process round trip, %d x %d-byte messages\n", IPC_ROUNDS, IPC_MSG);
+    bench_ipc("unix socket (seqpacket)", 1);
+    bench_ipc("mev_shmq spsc",           0);
+    return 0;
+}
@@ -6,7 +6,9 @@
  * with portable __uint128_t overflow protection.
  *
  * All public symbols are exposed via a plain C ABI (extern "C") so Rust can
- * link against them without a cxx bridge.
+ * link against them without a cxx bridge.  The C ABI block is only emitted by
+ * the owning translation unit (amm_simulator.cpp defines AMM_SIMULATOR_IMPL),
+ * so other C++ kernels can include this header without duplicate symbols.
  *
  * Design decisions:
  *  - __uint128_t for V2 intermediates to avoid u64 overflow at mainnet reserve scale
@@ -217,6 +219,7 @@ namespace amm_math {
 
 // ─── C ABI exports ───────────────────────────────────────────────────────────
 
+#ifdef AMM_SIMULATOR_IMPL
 extern "C" {
 
 /// V2 getAmountOut — C-callable
@@ -252,3 +255,4 @@ uint64_t amm_v3_amount_out(
 }
 
 } // extern "C"
+#endif // AMM_SIMULATOR_IMPL
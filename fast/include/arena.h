@@ -0,0 +1,82 @@
+#ifndef MEV_ARENA_H
+#define MEV_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// One large, pre-faulted, optionally locked region that hot-path
+// allocators carve their slabs from, so the buffers share a few huge TLB
+// entries and never take a first-touch fault after init.
+typedef struct mev_arena_t mev_arena_t;
+
+// Creation flags
+#define MEV_ARENA_HUGE      0x1   // MAP_HUGETLB, else THP madvise
+#define MEV_ARENA_PREFAULT  0x2   // touch every page at create
+#define MEV_ARENA_MLOCK     0x4   // mlock (best effort: RLIMIT_MEMLOCK)
+#define MEV_ARENA_DEFAULT   (MEV_ARENA_HUGE | MEV_ARENA_PREFAULT | MEV_ARENA_MLOCK)
+
+// Backing actually obtained (mev_arena_info_t.backing)
+#define MEV_ARENA_BACKING_HEAP     0   // aligned malloc (no mmap / Windows)
+#define MEV_ARENA_BACKING_4K       1   // anonymous mmap, base pages
+#define MEV_ARENA_BACKING_THP      2   // anonymous mmap + MADV_HUGEPAGE
+#define MEV_ARENA_BACKING_HUGETLB  3   // MAP_HUGETLB (reserved huge pages)
+
+#define MEV_ARENA_MAX_REGIONS 64   // labelled carves kept for the layout report
+
+typedef struct {
+    const char* label;
+    size_t offset;        // from the arena base
+    size_t bytes;
+} mev_arena_region_t;
+
+typedef struct {
+    void* base;
+    size_t size;          // mapped bytes (a multiple of page_size)
+    size_t used;          // carved so far, including alignment padding
+    size_t page_size;     // 2 MB for hugetlb / THP, else the base page size
+    int backing;          // MEV_ARENA_BACKING_*
+    int locked;           // every mlock requested succeeded
+    size_t locked_bytes;
+    long minor_faults;    // taken while pre-faulting (the committing thread)
+    long major_faults;
+    uint64_t prefault_ns;
+    unsigned bind_failures;   // mev_arena_bind calls that left a range unbound
+    unsigned n_regions;
+    mev_arena_region_t regions[MEV_ARENA_MAX_REGIONS];
+} mev_arena_info_t;
+
+// `size` is rounded up to the page size; NULL only if no memory at all
+// could be obtained (each flag degrades on its own)
+mev_arena_t* mev_arena_create(size_t size, unsigned flags);
+void mev_arena_destroy(mev_arena_t* a);
+
+// Pre-fault / mlock (MEV_ARENA_PREFAULT / MEV_ARENA_MLOCK in `flags`) one
+// range of an arena created without them; -1 if the range is outside it
+int mev_arena_commit(mev_arena_t* a, void* p, size_t bytes, unsigned flags);
+
+// Carve `bytes` at `align` (power of 2) — lock-free, NULL once the arena
+// is exhausted.  Carves with a label are recorded in the layout.
+void* mev_arena_carve(mev_arena_t* a, size_t bytes, size_t align, const char* label);
+int mev_arena_contains(const mev_arena_t* a, const void* p);
+
+void mev_arena_info(const mev_arena_t* a, mev_arena_info_t* out);
+const char* mev_arena_backing_name(int backing);
+
+// NUMA: node count (get_mempolicy, else /sys; 1 without NUMA), the
+// calling thread's current node, and binding a range of an arena to a
+// node before it is committed (-1 if it cannot be bound, also counted in
+// bind_failures).  The range is widened to whole arena pages (2 MB on
+// hugetlb / THP): keep ranges bound to different nodes page-aligned.
+int mev_numa_node_count(void);
+int mev_numa_current_node(void);
+int mev_arena_bind(mev_arena_t* a, void* p, size_t bytes, int node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEV_ARENA_H
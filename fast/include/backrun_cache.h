@@ -0,0 +1,271 @@
+#pragma once
+/**
+ * backrun_cache.h — speculative backrun precompute cache for pending swaps
+ *
+ * When a pending swap is seen, its effect on the target pool is simulated
+ * exactly with the AMM kernels and the best backrun cycle against the
+ * post-victim state is searched once.  The answer is stored under the tx
+ * hash together with the version of every pool it depends on (the victim's
+ * pool and each hop of the backrun path).  At bundle-build time a lookup
+ * re-checks those versions against the live graph: if any moved, the entry
+ * is dropped and the caller recomputes — no explicit invalidation needed.
+ *
+ * Simulation:
+ *  - V2: reserve_in += amount_in, reserve_out -= amount_out
+ *  - V3: single-tick move of sqrtPrice, same formula as
+ *        amm_math::v3_amount_out_approx; liquidity unchanged
+ *  - The post-victim state is written into the graph for the duration of
+ *    the search only and restored afterwards (not journaled, version kept)
+ *  - Cycles are searched from both of the pool's tokens; the better wins
+ *
+ * The cache is a fixed table of BR_CACHE_SLOTS entries, BR_CACHE_WAYS-way
+ * set associative on the tx hash, evicting the oldest entry of the set.
+ *
+ * Compile with -std=c++20.
+ */
+
+#include "pathfinder.h"
+
+// ─── Constants ────────────────────────────────────────────────────────────────
+
+static constexpr uint32_t BR_CACHE_SLOTS = 1024;
+static constexpr uint32_t BR_CACHE_WAYS  = 4;
+static constexpr uint32_t BR_MAX_TOUCHED = PF_MAX_HOPS + 1;   ///< victim pool + path hops
+
+/// Return codes
+static constexpr int BR_OK       =  0;
+static constexpr int BR_ENOPOOL  = -1;   ///< victim pool not in the graph
+static constexpr int BR_ETOKEN   = -2;   ///< token_in is not one of the pool's tokens
+static constexpr int BR_ENOFILL  = -3;   ///< victim swap yields nothing
+
+// ─── C-compatible structs ────────────────────────────────────────────────────
+
+#pragma pack(push, 1)
+
+/// A pending swap, as decoded from the mempool
+struct VictimSwap {
+    uint8_t  tx_hash[32];
+    uint8_t  pool_addr[20];
+    uint8_t  token_in[20];
+    uint64_t amount_in;
+};
+
+/// Precomputed answer for one pending swap
+struct BackrunQuote {
+    PathfinderResult backrun;            ///< Best cycle on the post-victim state
+    uint64_t         post_reserve0;      ///< Victim pool state after the swap
+    uint64_t         post_reserve1;
+    uint64_t         victim_amount_out;
+    uint32_t         victim_slot;
+    uint32_t         _pad;
+};
+
+/// Cache counters
+struct BackrunCacheStats {
+    uint64_t hits;
+    uint64_t misses;                     ///< tx hash not cached
+    uint64_t stale;                      ///< cached, but a touched pool moved
+    uint64_t computed;
+};
+
+#pragma pack(pop)
+
+// ─── Cache ───────────────────────────────────────────────────────────────────
+
+struct BackrunEntry {
+    uint8_t      tx_hash[32];
+    uint64_t     stamp;                  ///< Insertion order, 0 = empty
+    BackrunQuote quote;
+    uint32_t     touched_slot   [BR_MAX_TOUCHED];
+    uint32_t     touched_version[BR_MAX_TOUCHED];
+    uint32_t     n_touched;
+};
+
+namespace backrun_cache_internal {
+
+[[nodiscard]] static inline uint32_t set_of(const uint8_t* tx_hash) noexcept {
+    // Tx hashes are uniformly distributed already
+    uint32_t h;
+    memcpy(&h, tx_hash, sizeof(h));
+    return (h % (BR_CACHE_SLOTS / BR_CACHE_WAYS)) * BR_CACHE_WAYS;
+}
+
+/// Post-swap reserves of slot `idx` for `amount_in` of token `tin` yielding `out`.
+static inline void simulate_victim(
+    const PoolGraph& g,
+    uint32_t         idx,
+    uint32_t         tin,
+    uint64_t         amount_in,
+    uint64_t         out,
+    uint64_t&        r0,
+    uint64_t&        r1
+) noexcept {
+    const bool z1 = g.token0_id[idx] == tin;
+    r0 = g.reserve0[idx];
+    r1 = g.reserve1[idx];
+    if (g.is_v3[idx]) {
+        // reserve0 = L, reserve1 = sqrtPriceX64; move sqrtPrice as the kernel does
+        const double sp = static_cast<double>(r1) / static_cast<double>(1ULL << 32);
+        const double L  = static_cast<double>(r0);
+        const double ai = static_cast<double>(amount_in)
+                        * (1.0 - static_cast<double>(g.fee_bps[idx]) / 1000000.0);
+        const double sp_after = z1 ? sp * L / (L + ai * sp) : sp + ai / L;
+        const double q64 = sp_after * static_cast<double>(1ULL << 32);
+        r1 = q64 >= 1.8e19 ? UINT64_MAX : static_cast<uint64_t>(q64);
+    } else {
+        uint64_t& rin  = z1 ? r0 : r1;
+        uint64_t& rout = z1 ? r1 : r0;
+        rin  = rin > UINT64_MAX - amount_in ? UINT64_MAX : rin + amount_in;
+        rout = rout > out ? rout - out : 0;
+    }
+}
+
+} // namespace backrun_cache_internal
+
+/// Thread-safety note: not thread-safe; precompute also mutates the graph
+/// transiently, so it must be serialized with other graph users.
+struct BackrunCache {
+    BackrunEntry      entries[BR_CACHE_SLOTS];
+    uint64_t          clock;
+    BackrunCacheStats stats;
+
+    void clear() noexcept { memset(this, 0, sizeof(*this)); }
+
+    /// Cached quote for `tx_hash` if every pool it depends on is unchanged in
+    /// `g`; a stale entry is dropped.  nullptr on miss.
+    [[nodiscard]] const BackrunQuote* lookup(const PoolGraph& g, const uint8_t* tx_hash) noexcept {
+        const uint32_t base = backrun_cache_internal::set_of(tx_hash);
+        for (uint32_t w = 0; w < BR_CACHE_WAYS; ++w) {
+            BackrunEntry& e = entries[base + w];
+            if (!e.stamp || memcmp(e.tx_hash, tx_hash, 32) != 0) continue;
+            for (uint32_t k = 0; k < e.n_touched; ++k) {
+                const uint32_t s = e.touched_slot[k];
+                if (s >= g.n_pools || g.version[s] != e.touched_version[k]) {
+                    e.stamp = 0;
+                    ++stats.stale;
+                    return nullptr;
+                }
+            }
+            ++stats.hits;
+            return &e.quote;
+        }
+        ++stats.misses;
+        return nullptr;
+    }
+
+    /// Simulate `v` on `g`, search the backrun and cache the result.
+    /// `g` is modified during the search and restored before returning.
+    int precompute(PoolGraph& g, const VictimSwap& v, uint64_t amount_hint, BackrunQuote* out) noexcept;
+};
+
+inline int BackrunCache::precompute(
+    PoolGraph&        g,
+    const VictimSwap& v,
+    uint64_t          amount_hint,
+    BackrunQuote*     out
+) noexcept {
+    using namespace backrun_cache_internal;
+
+    const uint32_t slot = g.find_slot(v.pool_addr);
+    if (slot == PF_INF) return BR_ENOPOOL;
+    const uint32_t tin = g.tokens.find(v.token_in);
+    if (tin == PF_INF || (g.token0_id[slot] != tin && g.token1_id[slot] != tin)) return BR_ETOKEN;
+    const uint32_t tout = g.token0_id[slot] == tin ? g.token1_id[slot] : g.token0_id[slot];
+
+    const uint64_t victim_out = pathfinder_internal::hop_amount_out(g, slot, tin, v.amount_in);
+    if (victim_out == 0) return BR_ENOFILL;
+
+    BackrunQuote q{};
+    q.victim_slot       = slot;
+    q.victim_amount_out = victim_out;
+    simulate_victim(g, slot, tin, v.amount_in, victim_out, q.post_reserve0, q.post_reserve1);
+
+    // Search on the post-victim state, then put the live state back
+    const uint64_t live0 = g.reserve0[slot], live1 = g.reserve1[slot];
+    g.reserve0[slot] = q.post_reserve0;
+    g.reserve1[slot] = q.post_reserve1;
+    PathfinderResult a = find_best_path(g, tout, tout, amount_hint);
+    PathfinderResult b = find_best_path(g, tin,  tin,  amount_hint);
+    g.reserve0[slot] = live0;
+    g.reserve1[slot] = live1;
+
+    // Profits are in different tokens; prefer the cycle through the pushed
+    // side (token_out is now cheap in the victim pool) unless only b is valid
+    q.backrun = (a.valid || !b.valid) ? a : b;
+
+    // Pick the victim set's way: a previous entry for the hash, else oldest
+    const uint32_t base = set_of(v.tx_hash);
+    BackrunEntry* e = &entries[base];
+    for (uint32_t w = 0; w < BR_CACHE_WAYS; ++w) {
+        BackrunEntry& c = entries[base + w];
+        if (c.stamp && memcmp(c.tx_hash, v.tx_hash, 32) == 0) { e = &c; break; }
+        if (c.stamp < e->stamp) e = &c;
+    }
+    memcpy(e->tx_hash, v.tx_hash, 32);
+    e->stamp = ++clock;
+    e->quote = q;
+    e->n_touched = 0;
+    e->touched_slot   [e->n_touched] = slot;
+    e->touched_version[e->n_touched++] = g.version[slot];
+    if (q.backrun.valid) {
+        for (uint32_t h = 0; h < q.backrun.best_path.n_hops; ++h) {
+            const uint32_t s = g.find_slot(q.backrun.best_path.hops[h].pool_addr);
+            if (s == PF_INF || s == slot) continue;
+            e->touched_slot   [e->n_touched] = s;
+            e->touched_version[e->n_touched++] = g.version[s];
+        }
+    }
+    ++stats.computed;
+
+    if (out) *out = q;
+    return BR_OK;
+}
+
+// ─── C ABI exports ────────────────────────────────────────────────────────────
+
+#ifdef BACKRUN_CACHE_IMPL
+extern "C" {
+
+/// Size in bytes of BackrunCache, for callers that allocate it opaquely.
+size_t backrun_cache_size(void) {
+    return sizeof(BackrunCache);
+}
+
+void backrun_cache_clear(BackrunCache* cache) {
+    if (cache) cache->clear();
+}
+
+/// Simulate a pending swap, search its backrun and cache the answer.
+/// `out` may be NULL.  Returns BR_OK or a negative BR_E* code.
+int backrun_precompute(
+    BackrunCache*     cache,
+    PoolGraph*        graph,
+    const VictimSwap* swap,
+    uint64_t          amount_hint,
+    BackrunQuote*     out
+) {
+    if (!cache || !graph || !swap) return BR_ENOPOOL;
+    return cache->precompute(*graph, *swap, amount_hint, out);
+}
+
+/// Copy the cached quote for `tx_hash` into `out` if it is still valid
+/// against `graph`.  Returns 1 on hit, 0 on miss or stale entry.
+int backrun_lookup(
+    BackrunCache*    cache,
+    const PoolGraph* graph,
+    const uint8_t*   tx_hash32,
+    BackrunQuote*    out
+) {
+    if (!cache || !graph || !tx_hash32) return 0;
+    const BackrunQuote* q = cache->lookup(*graph, tx_hash32);
+    if (!q) return 0;
+    if (out) *out = *q;
+    return 1;
+}
+
+BackrunCacheStats backrun_cache_stats(const BackrunCache* cache) {
+    return cache ? cache->stats : BackrunCacheStats{};
+}
+
+} // extern "C"
+#endif // BACKRUN_CACHE_IMPL
@@ -0,0 +1,46 @@
+#ifndef MEV_BROADCAST_RING_H
+#define MEV_BROADCAST_RING_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Single-producer multicast ring (new block headers, state-delta batches →
+// every detector).  Each record is written once and read in place by every
+// subscribed consumer; the slowest consumer gates the producer.
+typedef struct mev_bcast_t mev_bcast_t;
+
+// Create/destroy (capacity rounded up to a power of 2; slots padded to whole
+// cache lines)
+mev_bcast_t* mev_bcast_create(size_t capacity, size_t record_size, size_t max_consumers);
+void mev_bcast_destroy(mev_bcast_t* b);
+
+// Consumers — subscribe returns an id (>= 0), or -1 if all are taken.  A new
+// consumer sees records published after it subscribed.
+int mev_bcast_subscribe(mev_bcast_t* b);
+void mev_bcast_unsubscribe(mev_bcast_t* b, int id);
+
+// Producer (one thread): claim returns the next slot to fill (successive
+// claims return successive slots), NULL if the slowest consumer is a full
+// ring behind.  publish makes every claimed slot visible at once.
+void* mev_bcast_claim(mev_bcast_t* b);
+size_t mev_bcast_publish(mev_bcast_t* b);
+
+// Consumer `id` (one thread per id): read points *first at the oldest unread
+// record and returns how many follow contiguously (records are
+// mev_bcast_stride() bytes apart; capped at max and at the ring's end).
+// release(n) marks them consumed and frees the slots for the producer.
+size_t mev_bcast_read(mev_bcast_t* b, int id, const void** first, size_t max);
+void mev_bcast_release(mev_bcast_t* b, int id, size_t n);
+
+// Layout / status
+size_t mev_bcast_stride(mev_bcast_t* b);
+size_t mev_bcast_lag(mev_bcast_t* b, int id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEV_BROADCAST_RING_H
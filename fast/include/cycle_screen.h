@@ -0,0 +1,358 @@
+#pragma once
+/**
+ * cycle_screen.h — AVX2 spot-rate screen over all hub 2- and 3-cycles
+ *
+ * Keeps a dense token × token matrix of best marginal (spot) rates derived
+ * from the PoolGraph SoA arrays, and screens every cycle
+ *
+ *     hub → X → hub          (2-cycle)
+ *     hub → X → Y → hub      (3-cycle)
+ *
+ * for a rate product above 1 + min_edge before any exact optimization runs.
+ * Only cycles that pass the screen are worth a ternary search.
+ *
+ * Key design choices:
+ *  - rate[a][b] = best fee-adjusted marginal amount of b per unit of a over
+ *    all pools connecting a and b; best_pool[a][b] is the slot providing it
+ *  - into_hub[h][t] holds rate[t][hub h] contiguously so the 3-cycle kernel
+ *    is a pure row × row × scalar product (8 columns per AVX2 op)
+ *  - into_hub zeroes lower-ranked hubs, so a cycle through several hubs is
+ *    reported once, from its lowest-ranked hub
+ *  - Incremental refresh: a slot is dirty when PoolGraph::version moved since
+ *    the last refresh; only token pairs touched by dirty slots are rescanned.
+ *    A PoolGraph::generation bump (clear / rollback) rebuilds the matrix
+ *  - Hubs are kept as addresses and resolved to graph token ids on refresh
+ *    (ids are graph-local and reassigned by clear()); a hub not interned
+ *    yet joins, with a rebuild, once it appears in the graph
+ *  - float lanes: the screen only has to separate >1 from <1, not price trades
+ *
+ * Compile with -std=c++20 -mavx2.
+ */
+
+#include "pathfinder.h"
+
+#include <cmath>
+
+#ifdef __AVX2__
+#  include <immintrin.h>
+#endif
+
+// ─── Constants ────────────────────────────────────────────────────────────────
+
+static constexpr uint32_t CS_MAX_TOKENS = 64;             ///< Matrix dimension (multiple of 8)
+static constexpr uint32_t CS_MAX_HUBS   = 8;
+static constexpr uint8_t  CS_NO_COL     = 0xFF;
+static constexpr uint16_t CS_NO_POOL    = 0xFFFF;
+
+static_assert(CS_MAX_TOKENS % 8 == 0, "matrix rows must be a whole number of AVX2 lanes");
+static_assert(CS_MAX_TOKENS <= 64, "above_mask packs one row into a uint64_t");
+static_assert(CS_MAX_TOKENS < CS_NO_COL, "column ids must fit in uint8_t");
+
+// ─── C-compatible structs ────────────────────────────────────────────────────
+
+/// A cycle whose spot-rate product clears the screening threshold
+#pragma pack(push, 1)
+struct CycleHit {
+    uint32_t token_id[3];     ///< hub, X, Y graph token ids (Y unused for 2-cycles)
+    uint32_t pool_idx[3];     ///< PoolGraph slots for each leg
+    uint32_t n_hops;          ///< 2 or 3
+    float    rate_product;    ///< Product of fee-adjusted spot rates
+};
+#pragma pack(pop)
+
+// ─── Spot-rate matrix ────────────────────────────────────────────────────────
+
+/// Dense best-marginal-rate matrix built from a PoolGraph.
+/// Thread-safety note: refresh mutates; screening is read-only.
+struct alignas(32) SpotRateMatrix {
+    float    rate     [CS_MAX_TOKENS][CS_MAX_TOKENS];  ///< rate[a][b]: b received per a, after fee
+    float    into_hub [CS_MAX_HUBS][CS_MAX_TOKENS];    ///< into_hub[h][t] = rate[t][hub h] (screen row)
+    uint16_t best_pool[CS_MAX_TOKENS][CS_MAX_TOKENS];  ///< slot behind rate[a][b]
+    uint32_t col_id   [CS_MAX_TOKENS];                 ///< graph token id for each column
+    uint8_t  id_col   [PF_MAX_TOKENS];                 ///< column per graph token id, CS_NO_COL if none
+    uint8_t  pool_col0[PF_MAX_POOLS];                  ///< column of token0 per slot
+    uint8_t  pool_col1[PF_MAX_POOLS];                  ///< column of token1 per slot
+    uint32_t seen_version[PF_MAX_POOLS];               ///< PoolGraph::version at last refresh
+    uint8_t  hub_addr [CS_MAX_HUBS][20];               ///< hub token addresses, in rank order
+    uint8_t  hub_col  [CS_MAX_HUBS];                   ///< columns of the resolved hubs
+    int8_t   hub_rank [CS_MAX_TOKENS];                 ///< hub index for a column, -1 otherwise
+    uint32_t n_hub_addrs;
+    uint32_t n_hubs;                                   ///< hubs interned in the graph
+    uint32_t n_cols;
+    uint32_t n_seen;                                   ///< slots covered by the last refresh
+    uint32_t seen_generation;                          ///< PoolGraph::generation at last refresh
+    uint32_t n_unmapped;                               ///< slots skipped because the matrix is full
+
+    /// Reset the matrix and set the hub tokens (20-byte addresses, best
+    /// rank first).  They are resolved by the next refresh.
+    void init(const uint8_t (*hubs)[20], uint32_t n) noexcept {
+        memset(this, 0, sizeof(*this));
+        memset(best_pool, 0xFF, sizeof(best_pool));
+        memset(hub_rank, -1, sizeof(hub_rank));
+        memset(id_col, CS_NO_COL, sizeof(id_col));
+        n_hub_addrs = std::min(n, CS_MAX_HUBS);
+        memcpy(hub_addr, hubs, n_hub_addrs * sizeof(hub_addr[0]));
+    }
+
+    /// Start from an empty matrix whose first columns are the hubs interned
+    /// in `g`.
+    void rebuild(const PoolGraph& g) noexcept {
+        uint8_t hubs[CS_MAX_HUBS][20];
+        const uint32_t n = n_hub_addrs;
+        memcpy(hubs, hub_addr, sizeof(hubs));
+        init(hubs, n);
+        for (uint32_t h = 0; h < n; ++h) {
+            const uint8_t c = column_of(g.tokens.find(hub_addr[h]));
+            if (c == CS_NO_COL) continue;
+            hub_col[n_hubs] = c;
+            if (hub_rank[c] < 0) hub_rank[c] = static_cast<int8_t>(n_hubs);
+            ++n_hubs;
+        }
+        seen_generation = g.generation;
+    }
+
+    /// Number of hubs `g` has interned (a rebuild is due when it grows).
+    [[nodiscard]] uint32_t hubs_interned(const PoolGraph& g) const noexcept {
+        uint32_t n = 0;
+        for (uint32_t h = 0; h < n_hub_addrs; ++h) n += g.tokens.find(hub_addr[h]) != PF_INF;
+        return n;
+    }
+
+    /// Column for a graph token id, allocating one on first sight.
+    uint8_t column_of(uint32_t id) noexcept {
+        if (id >= PF_MAX_TOKENS) return CS_NO_COL;
+        if (id_col[id] != CS_NO_COL) return id_col[id];
+        if (n_cols >= CS_MAX_TOKENS) return CS_NO_COL;
+        col_id[n_cols] = id;
+        id_col[id]     = static_cast<uint8_t>(n_cols);
+        return static_cast<uint8_t>(n_cols++);
+    }
+
+    /// Bring the matrix up to date with `g`.  Returns the number of dirty slots.
+    uint32_t refresh(const PoolGraph& g) noexcept;
+
+    /// Screen all hub cycles.  Writes up to `max_hits` hits and returns the
+    /// total number of cycles that cleared 1 + min_edge_bps / 10000.
+    uint32_t screen(uint32_t min_edge_bps, CycleHit* hits, uint32_t max_hits) const noexcept;
+};
+
+// ─── Internal screening logic ────────────────────────────────────────────────
+
+namespace cycle_screen_internal {
+
+/// Fee-adjusted marginal rate of slot `idx`: token1 per token0 when z1,
+/// token0 per token1 otherwise.  Mirrors amm_math's fee convention.
+[[nodiscard]] static inline double spot_rate(const PoolGraph& g, uint32_t idx, bool z1) noexcept {
+    const double fc = 1.0 - static_cast<double>(g.fee_bps[idx]) / 1000000.0;
+    const double r0 = static_cast<double>(g.reserve0[idx]);
+    const double r1 = static_cast<double>(g.reserve1[idx]);
+    if (r0 <= 0.0 || r1 <= 0.0) return 0.0;
+
+    if (g.is_v3[idx]) {
+        // V3: reserve1 = sqrtPriceX64, same scaling as v3_amount_out_approx
+        const double sp = r1 / static_cast<double>(1ULL << 32);
+        const double p  = sp * sp;
+        return z1 ? p * fc : fc / p;
+    }
+    return z1 ? (r1 / r0) * fc : (r0 / r1) * fc;
+}
+
+/// Recompute rate[a][b] and rate[b][a] from every slot joining columns a and b.
+static inline void rescan_pair(SpotRateMatrix& m, const PoolGraph& g, uint8_t a, uint8_t b) noexcept {
+    float    best_ab = 0.0f, best_ba = 0.0f;
+    uint16_t pool_ab = CS_NO_POOL, pool_ba = CS_NO_POOL;
+
+    for (uint32_t i = 0; i < m.n_seen; ++i) {
+        const uint8_t c0 = m.pool_col0[i], c1 = m.pool_col1[i];
+        if (!((c0 == a && c1 == b) || (c0 == b && c1 == a))) continue;
+
+        const float fwd = static_cast<float>(spot_rate(g, i, true));   // c0 → c1
+        const float rev = static_cast<float>(spot_rate(g, i, false));  // c1 → c0
+        const float r_ab = (c0 == a) ? fwd : rev;
+        const float r_ba = (c0 == a) ? rev : fwd;
+        if (r_ab > best_ab) { best_ab = r_ab; pool_ab = static_cast<uint16_t>(i); }
+        if (r_ba > best_ba) { best_ba = r_ba; pool_ba = static_cast<uint16_t>(i); }
+    }
+
+    m.rate[a][b] = best_ab;  m.best_pool[a][b] = pool_ab;
+    m.rate[b][a] = best_ba;  m.best_pool[b][a] = pool_ba;
+
+    // Keep the transposed screen rows in sync; lower-ranked hubs stay zero.
+    for (uint32_t h = 0; h < m.n_hubs; ++h) {
+        const uint8_t hc = m.hub_col[h];
+        if (hc == b && (m.hub_rank[a] < 0 || m.hub_rank[a] >= static_cast<int8_t>(h)))
+            m.into_hub[h][a] = best_ab;
+        if (hc == a && (m.hub_rank[b] < 0 || m.hub_rank[b] >= static_cast<int8_t>(h)))
+            m.into_hub[h][b] = best_ba;
+    }
+}
+
+static inline void record_hit(
+    const SpotRateMatrix& m, CycleHit* hits, uint32_t max_hits, uint32_t& n,
+    uint8_t hub, uint8_t x, uint8_t y, uint32_t n_hops, float product
+) noexcept {
+    if (n < max_hits) {
+        CycleHit& h = hits[n];
+        h.token_id[0] = m.col_id[hub];
+        h.token_id[1] = m.col_id[x];
+        h.pool_idx[0] = m.best_pool[hub][x];
+        if (n_hops == 2) {
+            h.token_id[2] = PF_INF;
+            h.pool_idx[1] = m.best_pool[x][hub];
+            h.pool_idx[2] = PF_INF;
+        } else {
+            h.token_id[2] = m.col_id[y];
+            h.pool_idx[1] = m.best_pool[x][y];
+            h.pool_idx[2] = m.best_pool[y][hub];
+        }
+        h.n_hops       = n_hops;
+        h.rate_product = product;
+    }
+    ++n;
+}
+
+/// products[y] = scale × row[y] × back[y] over a full matrix row.
+static inline void row_product(const float* row, const float* back, float scale, float* out) noexcept {
+#ifdef __AVX2__
+    const __m256 vs = _mm256_set1_ps(scale);
+    for (uint32_t y = 0; y < CS_MAX_TOKENS; y += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_load_ps(row + y), _mm256_load_ps(back + y));
+        _mm256_store_ps(out + y, _mm256_mul_ps(v, vs));
+    }
+#else
+    for (uint32_t y = 0; y < CS_MAX_TOKENS; ++y) out[y] = scale * row[y] * back[y];
+#endif
+}
+
+/// Bitmask of columns whose product exceeds `thr` (bit y set ⇒ hit).
+[[nodiscard]] static inline uint64_t above_mask(const float* v, float thr) noexcept {
+    uint64_t mask = 0;
+#ifdef __AVX2__
+    const __m256 vt = _mm256_set1_ps(thr);
+    for (uint32_t y = 0; y < CS_MAX_TOKENS; y += 8) {
+        __m256 cmp = _mm256_cmp_ps(_mm256_load_ps(v + y), vt, _CMP_GT_OQ);
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_ps(cmp))) << y;
+    }
+#else
+    for (uint32_t y = 0; y < CS_MAX_TOKENS; ++y)
+        if (v[y] > thr) mask |= 1ULL << y;
+#endif
+    return mask;
+}
+
+} // namespace cycle_screen_internal
+
+inline uint32_t SpotRateMatrix::refresh(const PoolGraph& g) noexcept {
+    using namespace cycle_screen_internal;
+
+    // Graph was cleared or rolled back underneath us (slots may have been
+    // dropped and refilled, token ids handed out again), or a hub has been
+    // interned since: start from an empty matrix with the hubs re-resolved
+    if (g.generation != seen_generation
+        || (n_hubs < n_hub_addrs && hubs_interned(g) != n_hubs)) {
+        rebuild(g);
+    }
+
+    uint32_t dirty = 0;
+    for (uint32_t i = 0; i < g.n_pools; ++i) {
+        if (i < n_seen && seen_version[i] == g.version[i]) continue;
+
+        const uint8_t c0 = column_of(g.token0_id[i]);
+        const uint8_t c1 = column_of(g.token1_id[i]);
+        const bool unmapped = c0 == CS_NO_COL || c1 == CS_NO_COL;
+        if (i >= n_seen) {
+            pool_col0[i] = c0;
+            pool_col1[i] = c1;
+            if (unmapped) ++n_unmapped;
+            n_seen = i + 1;
+        } else if (c0 != pool_col0[i] || c1 != pool_col1[i]) {
+            // Slot now joins another pair: drop it from the old one's best rate
+            const uint8_t o0 = pool_col0[i], o1 = pool_col1[i];
+            const bool was_unmapped = o0 == CS_NO_COL || o1 == CS_NO_COL;
+            pool_col0[i] = c0;
+            pool_col1[i] = c1;
+            n_unmapped = n_unmapped - was_unmapped + unmapped;
+            if (!was_unmapped) rescan_pair(*this, g, o0, o1);
+        }
+        seen_version[i] = g.version[i];
+        ++dirty;
+
+        if (pool_col0[i] != CS_NO_COL && pool_col1[i] != CS_NO_COL)
+            rescan_pair(*this, g, pool_col0[i], pool_col1[i]);
+    }
+    return dirty;
+}
+
+inline uint32_t SpotRateMatrix::screen(
+    uint32_t min_edge_bps, CycleHit* hits, uint32_t max_hits
+) const noexcept {
+    using namespace cycle_screen_internal;
+
+    const float thr = 1.0f + static_cast<float>(min_edge_bps) / 10000.0f;
+    alignas(32) float prod[CS_MAX_TOKENS];
+    uint32_t n = 0;
+
+    for (uint32_t h = 0; h < n_hubs; ++h) {
+        const uint8_t hc   = hub_col[h];
+        const float*  back = into_hub[h];
+        if (hub_rank[hc] != static_cast<int8_t>(h)) continue;  // duplicate hub entry
+
+        // 2-cycles: rate[hub][x] × rate[x][hub]
+        row_product(rate[hc], back, 1.0f, prod);
+        for (uint64_t m = above_mask(prod, thr); m; m &= m - 1) {
+            const uint8_t x = static_cast<uint8_t>(__builtin_ctzll(m));
+            record_hit(*this, hits, max_hits, n, hc, x, 0, 2, prod[x]);
+        }
+
+        // 3-cycles: rate[hub][x] × rate[x][y] × rate[y][hub], one row per x
+        for (uint32_t x = 0; x < n_cols; ++x) {
+            const float a = rate[hc][x];
+            if (a <= 0.0f) continue;
+            if (hub_rank[x] >= 0 && hub_rank[x] < static_cast<int8_t>(h)) continue;
+
+            row_product(rate[x], back, a, prod);
+            for (uint64_t m = above_mask(prod, thr); m; m &= m - 1) {
+                const uint8_t y = static_cast<uint8_t>(__builtin_ctzll(m));
+                record_hit(*this, hits, max_hits, n, hc, static_cast<uint8_t>(x), y, 3, prod[y]);
+            }
+        }
+    }
+    return n;
+}
+
+// ─── C ABI exports ────────────────────────────────────────────────────────────
+
+#ifdef CYCLE_SCREEN_IMPL
+extern "C" {
+
+/// Size in bytes of SpotRateMatrix, for callers that allocate it opaquely.
+size_t cycle_screen_size(void) {
+    return sizeof(SpotRateMatrix);
+}
+
+/// Reset the matrix and register up to CS_MAX_HUBS hub tokens
+/// (`n_hubs` × 20-byte addresses, best rank first).
+void cycle_screen_init(SpotRateMatrix* m, const uint8_t* hub_addrs, uint32_t n_hubs) {
+    if (m) m->init(reinterpret_cast<const uint8_t (*)[20]>(hub_addrs), hub_addrs ? n_hubs : 0u);
+}
+
+/// Re-derive rates for pools whose version changed. Returns the dirty slot count.
+uint32_t cycle_screen_refresh(SpotRateMatrix* m, const PoolGraph* graph) {
+    if (!m || !graph) return 0;
+    return m->refresh(*graph);
+}
+
+/// Screen every hub cycle. Returns the number of cycles above threshold
+/// (may exceed max_hits; only the first max_hits are written).
+uint32_t cycle_screen_run(
+    const SpotRateMatrix* m,
+    uint32_t              min_edge_bps,
+    CycleHit*             hits,
+    uint32_t              max_hits
+) {
+    if (!m) return 0;
+    return m->screen(min_edge_bps, hits, hits ? max_hits : 0u);
+}
+
+} // extern "C"
+#endif // CYCLE_SCREEN_IMPL
@@ -0,0 +1,206 @@
+#pragma once
+/**
+ * delta_stream.h — compact on-disk stream of per-block pool-state deltas
+ *
+ * A recorded run is a start snapshot (graph_snapshot.h) plus a delta stream:
+ * for every block, the slots whose state changed and their new reserves /
+ * tick.  Slots refer to the snapshot's layout, so replay is a bounds check
+ * and a store per delta — no address lookup, no log decoding.
+ *
+ * File layout (little-endian):
+ *
+ *   DeltaStreamHeader   magic "MEVPGDLT", format version, block range,
+ *                       frame / delta counts, file size
+ *   frames              n_frames × { DeltaFrame, n_deltas × PoolDelta }
+ *
+ * Frames are in strictly increasing block order.  The reader walks the
+ * mmapped file in place (FileView from graph_snapshot.h); the writer
+ * appends frames and patches the header on finish().
+ *
+ * Compile with -std=c++20.
+ */
+
+#include "graph_snapshot.h"
+
+// ─── Constants ────────────────────────────────────────────────────────────────
+
+static constexpr uint32_t PF_DELTA_VERSION  = 1;
+static constexpr char     PF_DELTA_MAGIC[8] = { 'M', 'E', 'V', 'P', 'G', 'D', 'L', 'T' };
+
+// ─── On-disk structs ─────────────────────────────────────────────────────────
+
+#pragma pack(push, 1)
+struct DeltaStreamHeader {
+    char     magic[8];
+    uint32_t format_version;
+    uint32_t header_size;      ///< sizeof(DeltaStreamHeader), for forward compatibility
+    uint64_t first_block;
+    uint64_t last_block;
+    uint64_t n_frames;
+    uint64_t n_deltas;
+    uint64_t file_size;
+    uint8_t  _pad[8];
+};
+static_assert(sizeof(DeltaStreamHeader) == 64, "header must stay one cache line");
+
+/// Precedes the deltas of one block
+struct DeltaFrame {
+    uint64_t block;
+    uint32_t n_deltas;
+    uint32_t _pad;
+};
+static_assert(sizeof(DeltaFrame) == 16, "frame header is fixed size");
+
+/// New state of one slot
+struct PoolDelta {
+    uint32_t slot;
+    uint32_t version;          ///< Source graph's version[slot] after the change
+    uint64_t reserve0;
+    uint64_t reserve1;
+    int32_t  tick;
+    uint32_t _pad;
+};
+static_assert(sizeof(PoolDelta) == 32, "delta records are fixed size");
+#pragma pack(pop)
+
+// ─── Capture / apply ─────────────────────────────────────────────────────────
+
+/// Write the state of every slot changed since `since_clock` (a previous
+/// g.version_clock) into `out`.  Returns the count, capped at `max_out`.
+/// Slots reverted by a rollback keep an older version and are not picked
+/// up, and appended pools cannot be expressed as deltas: when g.generation
+/// or g.n_pools moved, take a new snapshot instead.
+static inline uint32_t delta_collect(
+    const PoolGraph& g,
+    uint32_t         since_clock,
+    PoolDelta*       out,
+    uint32_t         max_out
+) noexcept {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < g.n_pools && n < max_out; ++i) {
+        if (g.version[i] <= since_clock) continue;
+        PoolDelta& d = out[n++];
+        d.slot     = i;
+        d.version  = g.version[i];
+        d.reserve0 = g.reserve0[i];
+        d.reserve1 = g.reserve1[i];
+        d.tick     = g.tick[i];
+        d._pad     = 0;
+    }
+    return n;
+}
+
+/// Apply one block's deltas (journaled).  Versions are bumped locally, or,
+/// with `mirror_versions`, copied from the source graph so version-keyed
+/// caches agree across replicas.  Deltas for slots outside the graph are
+/// skipped (the caller missed an append); returns the number applied, so
+/// a count short of `n` means the graph is out of step with the source.
+static inline uint32_t delta_apply(
+    PoolGraph&       g,
+    uint64_t         block,
+    const PoolDelta* deltas,
+    uint32_t         n,
+    bool             mirror_versions = false
+) noexcept {
+    uint32_t applied = 0;
+    for (uint32_t k = 0; k < n; ++k) {
+        PoolDelta d;
+        memcpy(&d, &deltas[k], sizeof(d));
+        if (d.slot >= g.n_pools) continue;
+        g.apply_state(d.slot, d.reserve0, d.reserve1, d.tick, block);
+        if (mirror_versions) {
+            g.version[d.slot] = d.version;
+            g.version_clock   = std::max(g.version_clock, d.version);
+        }
+        ++applied;
+    }
+    return applied;
+}
+
+// ─── Writer ──────────────────────────────────────────────────────────────────
+
+/// Appends frames to `path`; the header is finalised by finish().
+struct DeltaWriter {
+    FILE*             f = nullptr;
+    DeltaStreamHeader hdr{};
+
+    [[nodiscard]] int open(const char* path) noexcept {
+        f = fopen(path, "wb");
+        if (!f) return PF_SNAP_EIO;
+        memcpy(hdr.magic, PF_DELTA_MAGIC, sizeof(hdr.magic));
+        hdr.format_version = PF_DELTA_VERSION;
+        hdr.header_size    = sizeof(DeltaStreamHeader);
+        hdr.file_size      = sizeof(DeltaStreamHeader);
+        // Placeholder; rewritten by finish()
+        return fwrite(&hdr, sizeof(hdr), 1, f) == 1 ? PF_SNAP_OK : PF_SNAP_EIO;
+    }
+
+    /// Append one block.  Blocks must be strictly increasing.
+    [[nodiscard]] int append(uint64_t block, const PoolDelta* deltas, uint32_t n) noexcept {
+        if (!f || (hdr.n_frames && block <= hdr.last_block)) return PF_SNAP_EFORMAT;
+        DeltaFrame fr{ block, n, 0 };
+        if (fwrite(&fr, sizeof(fr), 1, f) != 1) return PF_SNAP_EIO;
+        if (n && fwrite(deltas, sizeof(PoolDelta), n, f) != n) return PF_SNAP_EIO;
+        if (!hdr.n_frames) hdr.first_block = block;
+        hdr.last_block = block;
+        hdr.n_frames  += 1;
+        hdr.n_deltas  += n;
+        hdr.file_size += sizeof(fr) + static_cast<uint64_t>(n) * sizeof(PoolDelta);
+        return PF_SNAP_OK;
+    }
+
+    [[nodiscard]] int finish() noexcept {
+        if (!f) return PF_SNAP_EIO;
+        bool ok = fseek(f, 0, SEEK_SET) == 0
+               && fwrite(&hdr, sizeof(hdr), 1, f) == 1
+               && fflush(f) == 0;
+        ok = (fclose(f) == 0) && ok;
+        f = nullptr;
+        return ok ? PF_SNAP_OK : PF_SNAP_EIO;
+    }
+};
+
+// ─── Reader ──────────────────────────────────────────────────────────────────
+
+/// Zero-copy iterator over a mapped delta stream.
+struct DeltaReader {
+    graph_snapshot_internal::FileView view;
+    DeltaStreamHeader                 hdr{};
+    uint64_t                          pos = 0;
+
+    [[nodiscard]] int open(const char* path) noexcept {
+        if (!view.open(path)) return PF_SNAP_EIO;
+        int rc = PF_SNAP_OK;
+        if (view.size < sizeof(hdr)) {
+            rc = PF_SNAP_EFORMAT;
+        } else {
+            memcpy(&hdr, view.data, sizeof(hdr));
+            if (memcmp(hdr.magic, PF_DELTA_MAGIC, sizeof(hdr.magic)) != 0
+                || hdr.header_size < sizeof(hdr) || hdr.file_size != view.size) {
+                rc = PF_SNAP_EFORMAT;
+            } else if (hdr.format_version != PF_DELTA_VERSION) {
+                rc = PF_SNAP_EVERSION;
+            }
+        }
+        if (rc != PF_SNAP_OK) { view.close(); return rc; }
+        pos = hdr.header_size;
+        return PF_SNAP_OK;
+    }
+
+    /// Next frame: fills `block` / `n` and points `deltas` into the mapping.
+    /// Returns false at end of stream or on a truncated frame.
+    bool next(uint64_t& block, const PoolDelta*& deltas, uint32_t& n) noexcept {
+        if (pos + sizeof(DeltaFrame) > view.size) return false;
+        DeltaFrame fr;
+        memcpy(&fr, view.data + pos, sizeof(fr));
+        const uint64_t body = static_cast<uint64_t>(fr.n_deltas) * sizeof(PoolDelta);
+        if (body > view.size - pos - sizeof(fr)) return false;
+        block  = fr.block;
+        n      = fr.n_deltas;
+        deltas = reinterpret_cast<const PoolDelta*>(view.data + pos + sizeof(fr));
+        pos   += sizeof(fr) + body;
+        return true;
+    }
+
+    void close() noexcept { view.close(); }
+};
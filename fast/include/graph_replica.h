@@ -0,0 +1,345 @@
+#pragma once
+/**
+ * graph_replica.h — leader → follower PoolGraph replication over an fd
+ *
+ * One node decodes logs / polls RPC and owns the authoritative PoolGraph;
+ * followers mirror it by applying sequence-numbered frames instead of
+ * rebuilding state themselves.
+ *
+ * Wire format (little-endian), one frame per publish:
+ *
+ *   ReplFrameHeader   magic, type, seq, block, count, payload length,
+ *                     word-wise FNV-1a checksum of the payload
+ *   payload           DELTA:    count × PoolDelta (delta_stream.h)
+ *                     SNAPSHOT: an encoded snapshot (graph_snapshot.h)
+ *                     RESYNC:   empty (follower → leader request)
+ *
+ * Every DELTA / SNAPSHOT frame carries the next sequence number.  A follower
+ * applies a DELTA only if it is exactly the next one; a gap or a bad
+ * checksum drops it out of sync until the next SNAPSHOT.  On a duplex fd
+ * (socketpair, UNIX/TCP socket) the follower asks for one with a RESYNC
+ * frame; on a one-way medium (a shared file being appended to) the leader's
+ * periodic snapshot interval bounds the outage.
+ *
+ * Deltas only carry state changes of existing slots.  When the leader's
+ * graph was rolled back (g.generation moved) or gained pools, the next
+ * publish is a SNAPSHOT; a DELTA naming a slot the follower does not hold
+ * drops it out of sync like a gap.
+ *
+ * Deltas mirror the leader's slot versions, so version-keyed caches on the
+ * follower agree with the leader's.  POSIX only.
+ *
+ * Compile with -std=c++20.
+ */
+
+#include "delta_stream.h"
+
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+
+// ─── Constants ────────────────────────────────────────────────────────────────
+
+static constexpr uint32_t PF_REPL_MAGIC       = 0x4C504552;      ///< "REPL"
+static constexpr uint32_t PF_REPL_MAX_PAYLOAD = 1u << 20;         ///< Frames above are rejected
+
+enum : uint16_t {
+    PF_REPL_DELTA    = 1,
+    PF_REPL_SNAPSHOT = 2,
+    PF_REPL_RESYNC   = 3,
+};
+
+/// Return codes for graph_replica_*
+enum : int {
+    PF_REPL_APPLIED   =  0,  ///< delta applied
+    PF_REPL_RESYNCED  =  1,  ///< snapshot installed
+    PF_REPL_SKIPPED   =  2,  ///< duplicate, or delta received while out of sync
+    PF_REPL_GAP       = -1,  ///< sequence gap or corrupt payload: out of sync
+    PF_REPL_EOF       = -2,  ///< peer closed / end of file
+    PF_REPL_EIO       = -3,
+    PF_REPL_EFORMAT   = -4,  ///< bad magic, unknown type or oversized frame
+};
+
+// ─── Wire structs ─────────────────────────────────────────────────────────────
+
+#pragma pack(push, 1)
+struct ReplFrameHeader {
+    uint32_t magic;
+    uint16_t type;
+    uint16_t _pad;
+    uint64_t seq;
+    uint64_t block;
+    uint32_t count;            ///< PoolDelta records (DELTA), 0 otherwise
+    uint32_t payload_len;
+    uint64_t checksum;         ///< FNV-1a-64 (word-wise) of the payload
+};
+static_assert(sizeof(ReplFrameHeader) == 40, "frame header is fixed size");
+
+struct ReplStats {
+    uint64_t frames;           ///< DELTA / SNAPSHOT frames sent or received
+    uint64_t deltas;           ///< PoolDelta records sent or applied
+    uint64_t snapshots;
+    uint64_t gaps;             ///< follower: sequence gaps + corrupt frames
+    uint64_t resync_requests;  ///< RESYNC frames sent (follower) / served (leader)
+    uint64_t bytes;
+};
+#pragma pack(pop)
+
+// ─── Internal I/O ────────────────────────────────────────────────────────────
+
+namespace graph_replica_internal {
+
+/// Write all of `buf`; false on error.
+[[nodiscard]] static inline bool write_all(int fd, const void* buf, size_t len) noexcept {
+    const uint8_t* p = static_cast<const uint8_t*>(buf);
+    while (len) {
+        ssize_t w = ::write(fd, p, len);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p   += w;
+        len -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+/// Read exactly `len` bytes: PF_REPL_APPLIED, PF_REPL_EOF (clean EOF before
+/// the first byte) or PF_REPL_EIO.
+[[nodiscard]] static inline int read_all(int fd, void* buf, size_t len) noexcept {
+    uint8_t* p = static_cast<uint8_t*>(buf);
+    size_t got = 0;
+    while (got < len) {
+        ssize_t r = ::read(fd, p + got, len - got);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) return PF_REPL_EIO;
+        if (r == 0) return got == 0 ? PF_REPL_EOF : PF_REPL_EIO;
+        got += static_cast<size_t>(r);
+    }
+    return PF_REPL_APPLIED;
+}
+
+[[nodiscard]] static inline bool send_frame(
+    int fd, uint16_t type, uint64_t seq, uint64_t block,
+    uint32_t count, const uint8_t* payload, uint32_t len
+) noexcept {
+    ReplFrameHeader h{};
+    h.magic       = PF_REPL_MAGIC;
+    h.type        = type;
+    h.seq         = seq;
+    h.block       = block;
+    h.count       = count;
+    h.payload_len = len;
+    h.checksum    = graph_snapshot_internal::checksum(payload, len);
+    return write_all(fd, &h, sizeof(h)) && (len == 0 || write_all(fd, payload, len));
+}
+
+} // namespace graph_replica_internal
+
+// ─── Leader ──────────────────────────────────────────────────────────────────
+
+struct ReplicaLeader {
+    int       fd;
+    uint32_t  snapshot_interval;   ///< Blocks between unsolicited snapshots (0 = never)
+    uint32_t  blocks_since_snap;
+    uint32_t  sent_clock;          ///< graph.version_clock at the last publish
+    uint32_t  sent_generation;     ///< graph.generation at the last publish
+    uint32_t  sent_pools;          ///< graph.n_pools at the last publish
+    bool      need_snapshot;       ///< First publish, or a follower asked
+    uint64_t  seq;
+    ReplStats stats;
+    PoolDelta deltas[PF_MAX_POOLS];
+
+    void init(int out_fd, uint32_t interval) noexcept {
+        memset(this, 0, sizeof(*this));
+        fd                = out_fd;
+        snapshot_interval = interval;
+        need_snapshot     = true;
+    }
+
+    /// Drain pending RESYNC requests without blocking (duplex fds only).
+    void service_requests() noexcept {
+        pollfd p{ fd, POLLIN, 0 };
+        while (::poll(&p, 1, 0) == 1 && (p.revents & POLLIN)) {
+            ReplFrameHeader h;
+            if (graph_replica_internal::read_all(fd, &h, sizeof(h)) != PF_REPL_APPLIED) return;
+            if (h.magic == PF_REPL_MAGIC && h.type == PF_REPL_RESYNC) {
+                need_snapshot = true;
+                ++stats.resync_requests;
+            }
+        }
+    }
+
+    /// Publish the state of `g` after `block`: a SNAPSHOT when one is due or
+    /// the graph was rolled back / grew, otherwise a DELTA of the slots
+    /// changed since the last publish.
+    [[nodiscard]] int publish(const PoolGraph& g, uint64_t block) noexcept {
+        using namespace graph_replica_internal;
+        service_requests();
+
+        if (snapshot_interval && ++blocks_since_snap >= snapshot_interval) need_snapshot = true;
+        // Reverted slots and new pools are invisible to delta_collect
+        if (g.generation != sent_generation || g.n_pools != sent_pools) need_snapshot = true;
+
+        bool ok;
+        uint64_t len;
+        if (need_snapshot) {
+            uint8_t* buf = nullptr;
+            if (snapshot_encode(g, block, &buf, &len) != PF_SNAP_OK) return PF_REPL_EIO;
+            ok = len <= PF_REPL_MAX_PAYLOAD
+              && send_frame(fd, PF_REPL_SNAPSHOT, ++seq, block, 0, buf, static_cast<uint32_t>(len));
+            free(buf);
+            if (ok) {
+                need_snapshot     = false;
+                blocks_since_snap = 0;
+                ++stats.snapshots;
+            }
+        } else {
+            const uint32_t n = delta_collect(g, sent_clock, deltas, PF_MAX_POOLS);
+            len = static_cast<uint64_t>(n) * sizeof(PoolDelta);
+            ok  = send_frame(fd, PF_REPL_DELTA, ++seq, block, n,
+                             reinterpret_cast<const uint8_t*>(deltas), static_cast<uint32_t>(len));
+            if (ok) stats.deltas += n;
+        }
+        if (!ok) return PF_REPL_EIO;
+        sent_clock      = g.version_clock;
+        sent_generation = g.generation;
+        sent_pools      = g.n_pools;
+        ++stats.frames;
+        stats.bytes += sizeof(ReplFrameHeader) + len;
+        return PF_REPL_APPLIED;
+    }
+};
+
+// ─── Follower ────────────────────────────────────────────────────────────────
+
+struct ReplicaFollower {
+    int       fd;
+    bool      synced;              ///< Holds a snapshot and every delta since
+    bool      duplex;              ///< fd is writable: send RESYNC on a gap
+    uint64_t  next_seq;
+    uint64_t  last_block;
+    ReplStats stats;
+    uint8_t*  buf;                 ///< Payload buffer (grown on demand)
+    uint32_t  buf_cap;
+
+    void init(int in_fd, bool can_request) noexcept {
+        memset(this, 0, sizeof(*this));
+        fd     = in_fd;
+        duplex = can_request;
+    }
+
+    void release() noexcept {
+        free(buf);
+        buf     = nullptr;
+        buf_cap = 0;
+    }
+
+    void request_resync() noexcept {
+        if (!duplex) return;
+        if (graph_replica_internal::send_frame(fd, PF_REPL_RESYNC, 0, 0, 0, nullptr, 0))
+            ++stats.resync_requests;
+    }
+
+    /// Read and apply one frame (blocking).  Returns PF_REPL_*.
+    [[nodiscard]] int poll_once(PoolGraph& g) noexcept {
+        using namespace graph_replica_internal;
+
+        ReplFrameHeader h;
+        int rc = read_all(fd, &h, sizeof(h));
+        if (rc != PF_REPL_APPLIED) return rc;
+        if (h.magic != PF_REPL_MAGIC || h.payload_len > PF_REPL_MAX_PAYLOAD
+            || (h.type != PF_REPL_DELTA && h.type != PF_REPL_SNAPSHOT)) {
+            return PF_REPL_EFORMAT;
+        }
+        if (h.payload_len > buf_cap) {
+            uint8_t* nb = static_cast<uint8_t*>(realloc(buf, h.payload_len));
+            if (!nb) return PF_REPL_EIO;
+            buf     = nb;
+            buf_cap = h.payload_len;
+        }
+        if (h.payload_len && read_all(fd, buf, h.payload_len) != PF_REPL_APPLIED) return PF_REPL_EIO;
+        stats.bytes += sizeof(h) + h.payload_len;
+
+        const bool intact = h.payload_len % 8 == 0
+                         && graph_snapshot_internal::checksum(buf, h.payload_len) == h.checksum;
+
+        if (h.type == PF_REPL_SNAPSHOT) {
+            uint64_t blk = 0;
+            if (!intact || snapshot_decode(g, buf, h.payload_len, &blk) != PF_SNAP_OK) {
+                return out_of_sync();
+            }
+            synced     = true;
+            next_seq   = h.seq + 1;
+            last_block = blk;
+            ++stats.frames;
+            ++stats.snapshots;
+            return PF_REPL_RESYNCED;
+        }
+
+        if (synced && h.seq < next_seq) return PF_REPL_SKIPPED;      // duplicate
+        if (!synced) return PF_REPL_SKIPPED;                         // waiting for a snapshot
+        if (h.seq != next_seq || !intact
+            || h.payload_len != static_cast<uint64_t>(h.count) * sizeof(PoolDelta)) {
+            return out_of_sync();
+        }
+        const uint32_t applied = delta_apply(g, h.block, reinterpret_cast<const PoolDelta*>(buf), h.count, true);
+        stats.deltas += applied;
+        if (applied != h.count) return out_of_sync();               // missed an append
+        next_seq   = h.seq + 1;
+        last_block = h.block;
+        ++stats.frames;
+        return PF_REPL_APPLIED;
+    }
+
+    int out_of_sync() noexcept {
+        synced = false;
+        ++stats.gaps;
+        request_resync();
+        return PF_REPL_GAP;
+    }
+};
+
+// ─── C ABI exports ────────────────────────────────────────────────────────────
+
+#ifdef GRAPH_REPLICA_IMPL
+extern "C" {
+
+size_t graph_replica_leader_size(void)   { return sizeof(ReplicaLeader); }
+size_t graph_replica_follower_size(void) { return sizeof(ReplicaFollower); }
+
+/// Publish to `fd`; a snapshot goes out first and then every
+/// `snapshot_interval` blocks (0 = only on request).
+void graph_replica_leader_init(ReplicaLeader* l, int fd, uint32_t snapshot_interval) {
+    if (l) l->init(fd, snapshot_interval);
+}
+
+/// Publish the state of `graph` as of `block`. Returns PF_REPL_*.
+int graph_replica_publish(ReplicaLeader* l, const PoolGraph* graph, uint64_t block) {
+    if (!l || !graph) return PF_REPL_EIO;
+    return l->publish(*graph, block);
+}
+
+/// Follow `fd`; set `duplex` if the fd is writable so gaps trigger a RESYNC request.
+void graph_replica_follower_init(ReplicaFollower* f, int fd, int duplex) {
+    if (f) f->init(fd, duplex != 0);
+}
+
+/// Read and apply one frame into `graph` (blocking). Returns PF_REPL_*.
+int graph_replica_poll(ReplicaFollower* f, PoolGraph* graph) {
+    if (!f || !graph) return PF_REPL_EIO;
+    return f->poll_once(*graph);
+}
+
+/// Free the follower's payload buffer.
+void graph_replica_follower_release(ReplicaFollower* f) {
+    if (f) f->release();
+}
+
+/// Copy counters of a leader (`is_leader` = 1) or follower.
+void graph_replica_stats(const void* endpoint, int is_leader, ReplStats* out) {
+    if (!endpoint || !out) return;
+    *out = is_leader ? static_cast<const ReplicaLeader*>(endpoint)->stats
+                     : static_cast<const ReplicaFollower*>(endpoint)->stats;
+}
+
+} // extern "C"
+#endif // GRAPH_REPLICA_IMPL
@@ -0,0 +1,656 @@
+#pragma once
+/**
+ * graph_shard.h — token-community sharding of the pool graph for parallel search
+ *
+ * A single PoolGraph is capped at PF_MAX_POOLS slots and, at full pool-universe
+ * scale, any flat layout stops fitting in L2.  ShardedGraph splits an arbitrary
+ * pool set into many small PoolGraphs, one per token community, and runs
+ * shard-local searches on worker threads pinned to fixed CPUs.
+ *
+ * Partitioning:
+ *  - Hub tokens (WETH, USDC, ...) are excluded from clustering — they connect
+ *    everything and would collapse all communities into one
+ *  - Remaining tokens are clustered by weighted label propagation; the edge
+ *    weight is log2(1 + pool depth), so deep pools pull tokens together
+ *    without a single whale pool dominating
+ *  - Communities are bin-packed first-fit-decreasing into shards; a community
+ *    larger than one shard is split at token granularity
+ *
+ * Pool placement:
+ *  - both tokens in the same shard      → that shard
+ *  - one hub token                      → the other token's shard + a hub shard
+ *  - two hub tokens                     → replicated to every shard
+ *  - tokens in different shards (cross) → a hub shard only
+ * The leading n_hub_shards shards are hub shards; they are the only place
+ * cross-community routes can be found, so every query searches them.  Hub
+ * pools that do not fit one hub shard spill into further ones, each pool
+ * preferring a hub shard that already knows its non-hub tokens so routes
+ * stay together.  If even GS_MAX_HUB_SHARDS cannot hold them at the target
+ * fill, the partition is refused rather than dropping pools.
+ *
+ * Each shard's SoA arrays are one contiguous PoolGraph inside a single
+ * 64-byte-aligned allocation.  Worker w owns shards s ≡ w (mod n_workers)
+ * and is pinned to CPU first_cpu + w.
+ *
+ * Token ids are local to each shard's PoolGraph, so queries name tokens by
+ * address and each worker resolves them in its own shards.  Address
+ * fingerprints are only used as partitioner keys: a collision can at worst
+ * co-locate two tokens, never route a pool to the wrong token.
+ *
+ * Compile with -std=c++20 -pthread.
+ */
+
+#include "pathfinder.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __AVX2__
+#  include <immintrin.h>
+#  define GS_CPU_PAUSE() _mm_pause()
+#else
+#  define GS_CPU_PAUSE() ((void)0)
+#endif
+
+// ─── Constants ────────────────────────────────────────────────────────────────
+
+static constexpr uint32_t GS_MAX_SHARDS  = 256;   ///< Community shards (hub shards are extra)
+static constexpr uint32_t GS_MAX_HUB_SHARDS = 16;
+static constexpr uint32_t GS_MAX_WORKERS = 64;
+static constexpr uint32_t GS_MAX_HUBS    = 8;
+static constexpr uint32_t GS_HUB_SHARD   = 0;     ///< First hub shard
+static constexpr uint32_t GS_MASK_WORDS  = (GS_MAX_SHARDS + GS_MAX_HUB_SHARDS + 63) / 64;
+static constexpr uint32_t GS_SPIN_ITERS  = 4096;  ///< Pause-spins before a worker parks
+
+// ─── C-compatible structs ────────────────────────────────────────────────────
+
+/// Partitioner / worker configuration
+#pragma pack(push, 1)
+struct ShardConfig {
+    uint8_t  hub_tokens[GS_MAX_HUBS][20];  ///< Token addresses replicated in the hub shard
+    uint32_t n_hubs;
+    uint32_t n_workers;             ///< 0 → min(shards, online CPUs)
+    uint32_t fill_pct;              ///< Target shard fill of PF_MAX_POOLS (0 → 75), headroom for new pools
+    uint32_t lp_rounds;             ///< Label-propagation rounds (0 → 8)
+    int32_t  first_cpu;             ///< Pin worker w to CPU first_cpu + w; -1 disables pinning
+    uint8_t  _pad[4];
+};
+#pragma pack(pop)
+
+/// Per-shard search statistics
+#pragma pack(push, 1)
+struct ShardStats {
+    uint64_t searches;
+    uint64_t total_ns;
+    uint64_t last_ns;
+    uint64_t max_ns;
+    uint32_t n_pools;
+    uint32_t worker;                ///< Worker thread that owns this shard
+};
+#pragma pack(pop)
+
+/// Partition summary
+#pragma pack(push, 1)
+struct ShardReport {
+    uint32_t n_shards;              ///< Including the hub shards
+    uint32_t n_workers;
+    uint32_t n_input;               ///< Pools handed to the partitioner
+    uint32_t n_cross;               ///< Non-hub pools whose tokens landed in different shards
+    uint32_t n_replicated;          ///< Extra copies made for hub-touching pools
+    uint32_t n_dropped;             ///< Pools that did not fit any shard
+    float    cross_ratio;           ///< n_cross / n_input
+    uint32_t n_hub_shards;          ///< Leading shards holding hub and cross pools
+};
+#pragma pack(pop)
+
+// ─── Internal partitioning logic ─────────────────────────────────────────────
+
+namespace graph_shard_internal {
+
+[[nodiscard]] static inline uint64_t now_ns() noexcept {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/// Open-addressing fingerprint → uint32 map (power-of-two capacity, no deletes)
+struct FpMap {
+    uint64_t* keys = nullptr;
+    uint32_t* vals = nullptr;
+    uint32_t  mask = 0;
+
+    bool init(uint32_t min_entries) noexcept {
+        uint32_t cap = 16;
+        while (cap < min_entries * 2u) cap <<= 1;
+        keys = static_cast<uint64_t*>(calloc(cap, sizeof(uint64_t)));
+        vals = static_cast<uint32_t*>(malloc(cap * sizeof(uint32_t)));
+        if (!keys || !vals) return false;
+        memset(vals, 0xFF, cap * sizeof(uint32_t));
+        mask = cap - 1;
+        return true;
+    }
+    void release() noexcept { free(keys); free(vals); keys = nullptr; vals = nullptr; }
+
+    [[nodiscard]] uint32_t find(uint64_t fp) const noexcept {
+        for (uint32_t i = static_cast<uint32_t>(fp) & mask;; i = (i + 1) & mask) {
+            if (vals[i] == PF_INF) return PF_INF;
+            if (keys[i] == fp)     return vals[i];
+        }
+    }
+    /// Insert if absent; returns the stored value
+    uint32_t intern(uint64_t fp, uint32_t next) noexcept {
+        for (uint32_t i = static_cast<uint32_t>(fp) & mask;; i = (i + 1) & mask) {
+            if (vals[i] == PF_INF) { keys[i] = fp; vals[i] = next; return next; }
+            if (keys[i] == fp)     return vals[i];
+        }
+    }
+};
+
+/// Liquidity weight of a pool for clustering
+[[nodiscard]] static inline float pool_weight(const AMMPool& p) noexcept {
+    const double depth = p.is_v3
+        ? static_cast<double>(p.reserve0)
+        : std::sqrt(static_cast<double>(p.reserve0)) * std::sqrt(static_cast<double>(p.reserve1));
+    return static_cast<float>(std::log2(1.0 + depth));
+}
+
+} // namespace graph_shard_internal
+
+// ─── Sharded graph ───────────────────────────────────────────────────────────
+
+struct ShardedGraph;
+
+/// Worker thread state — one cache line of hot fields per worker
+struct alignas(64) ShardWorker {
+    ShardedGraph* owner;
+    pthread_t     thread;
+    uint32_t      id;
+    int32_t       cpu;
+    bool          started;
+};
+
+struct ShardedGraph {
+    PoolGraph*        graphs;          ///< [n_shards] contiguous; hub shards first
+    ShardStats*       stats;           ///< [n_shards]
+    PathfinderResult* results;         ///< [n_shards] scratch for the current query
+    graph_shard_internal::FpMap token_shard;  ///< token fp → shard (GS_HUB_SHARD for hubs/overflow)
+    uint64_t          hub_fps[GS_MAX_HUBS];
+    uint32_t          n_hubs;
+    uint32_t          n_shards;
+    uint32_t          n_hub_shards;
+    uint32_t          hub_fill;        ///< Target pools per hub shard before spilling
+    uint32_t          n_workers;
+    ShardReport       report;
+    ShardWorker       workers[GS_MAX_WORKERS];
+
+    // ── Query hand-off (written by the dispatcher, read by workers) ──────
+    alignas(64) std::atomic<uint64_t> job_gen{0};
+    std::atomic<uint32_t> pending{0};
+    std::atomic<uint32_t> parked{0};
+    std::atomic<bool>     stop{false};
+    uint64_t              job_mask[GS_MASK_WORDS];
+    uint8_t               job_in[20], job_out[20];
+    uint64_t              job_hint;
+    pthread_mutex_t       park_mu;
+    pthread_cond_t        park_cv;
+
+    /// Partition and start workers; NULL on allocation or thread failure
+    static ShardedGraph* create(const AMMPool* pools, uint32_t n, const ShardConfig& cfg) noexcept;
+    static void destroy(ShardedGraph* sg) noexcept;
+
+    bool build(const AMMPool* pools, uint32_t n, const ShardConfig& cfg) noexcept;
+    bool start_workers(const ShardConfig& cfg) noexcept;
+    void shutdown() noexcept;
+
+    [[nodiscard]] bool is_hub(uint64_t fp) const noexcept {
+        for (uint32_t h = 0; h < n_hubs; ++h) if (hub_fps[h] == fp) return true;
+        return false;
+    }
+
+    /// Shard of a non-hub token; GS_HUB_SHARD if unknown or overflowed
+    [[nodiscard]] uint32_t shard_of(uint64_t fp) const noexcept {
+        uint32_t s = token_shard.find(fp);
+        return s == PF_INF ? GS_HUB_SHARD : s;
+    }
+
+    /// Hub shard for a hub-bound pool: the one already holding it (*held set),
+    /// else one below hub_fill that knows a non-hub token, else any with room
+    [[nodiscard]] uint32_t hub_slot(const AMMPool& p, bool h0, bool h1, bool& held) const noexcept;
+
+    /// Apply the placement rule; returns the number of shards written.
+    /// *fresh (optional) is set when the pool was not held before.
+    uint32_t place(const AMMPool& p, uint32_t& cross, uint32_t& dropped, bool* fresh = nullptr) noexcept;
+
+    PathfinderResult find_best(const uint8_t* token_in, const uint8_t* token_out, uint64_t hint) noexcept;
+    void worker_loop(ShardWorker& w) noexcept;
+};
+
+inline uint32_t ShardedGraph::hub_slot(const AMMPool& p, bool h0, bool h1, bool& held) const noexcept {
+    held = false;
+    for (uint32_t h = 0; h < n_hub_shards; ++h) {
+        if (graphs[h].find_slot(p.pool_addr) != PF_INF) { held = true; return h; }
+    }
+    uint32_t first = PF_INF;
+    for (uint32_t h = 0; h < n_hub_shards; ++h) {
+        const PoolGraph& g = graphs[h];
+        if (g.n_pools >= hub_fill) continue;
+        if ((!h0 && g.tokens.find(p.token0) != PF_INF) ||
+            (!h1 && g.tokens.find(p.token1) != PF_INF)) return h;
+        if (first == PF_INF) first = h;
+    }
+    if (first != PF_INF) return first;
+    // Past the target fill everywhere: use up the headroom
+    for (uint32_t h = 0; h < n_hub_shards; ++h)
+        if (graphs[h].n_pools < PF_MAX_POOLS) return h;
+    return GS_HUB_SHARD;  // all full; the upsert fails and is counted
+}
+
+inline uint32_t ShardedGraph::place(const AMMPool& p, uint32_t& cross, uint32_t& dropped, bool* fresh) noexcept {
+    const uint64_t fp0 = PoolGraph::pf_fnv1a(p.token0, 20);
+    const uint64_t fp1 = PoolGraph::pf_fnv1a(p.token1, 20);
+    const bool h0 = is_hub(fp0), h1 = is_hub(fp1);
+    uint32_t written = 0;
+    bool held = false;
+
+    auto put = [&](uint32_t s) {
+        if (graphs[s].upsert(p)) ++written; else ++dropped;
+    };
+
+    if (h0 && h1) {
+        held = graphs[GS_HUB_SHARD].find_slot(p.pool_addr) != PF_INF;
+        for (uint32_t s = 0; s < n_shards; ++s) put(s);
+    } else if (h0 || h1) {
+        const uint32_t s = shard_of(h0 ? fp1 : fp0);
+        put(hub_slot(p, h0, h1, held));
+        if (s != GS_HUB_SHARD) put(s);
+    } else {
+        const uint32_t s0 = shard_of(fp0), s1 = shard_of(fp1);
+        if (s0 == s1 && s0 != GS_HUB_SHARD) {
+            held = graphs[s0].find_slot(p.pool_addr) != PF_INF;
+            put(s0);
+        } else {
+            const uint32_t h = hub_slot(p, false, false, held);
+            if (!held) ++cross;
+            put(h);
+        }
+    }
+    if (fresh) *fresh = !held;
+    return written;
+}
+
+inline bool ShardedGraph::build(const AMMPool* pools, uint32_t n, const ShardConfig& cfg) noexcept {
+    using namespace graph_shard_internal;
+
+    n_hubs = std::min(cfg.n_hubs, GS_MAX_HUBS);
+    for (uint32_t h = 0; h < n_hubs; ++h) hub_fps[h] = PoolGraph::pf_fnv1a(cfg.hub_tokens[h], 20);
+    memset(&report, 0, sizeof(report));
+    report.n_input = n;
+
+    const uint32_t fill   = cfg.fill_pct ? std::min(cfg.fill_pct, 100u) : 75u;
+    const uint32_t rounds = cfg.lp_rounds ? cfg.lp_rounds : 8u;
+
+    // ── 1. Intern non-hub tokens ──────────────────────────────────────────
+    FpMap tok;
+    if (!tok.init(n * 2u + 1u)) { tok.release(); return false; }
+    uint32_t* pool_t0 = static_cast<uint32_t*>(malloc((n + 1) * sizeof(uint32_t)));
+    uint32_t* pool_t1 = static_cast<uint32_t*>(malloc((n + 1) * sizeof(uint32_t)));
+    uint64_t* tok_fp  = static_cast<uint64_t*>(malloc((n * 2u + 1u) * sizeof(uint64_t)));
+    uint32_t n_tok = 0, n_hubhub = 0;
+
+    for (uint32_t i = 0; i < n && pool_t0 && pool_t1 && tok_fp; ++i) {
+        const uint64_t fp0 = PoolGraph::pf_fnv1a(pools[i].token0, 20);
+        const uint64_t fp1 = PoolGraph::pf_fnv1a(pools[i].token1, 20);
+        pool_t0[i] = is_hub(fp0) ? PF_INF : tok.intern(fp0, n_tok);
+        if (pool_t0[i] == n_tok) tok_fp[n_tok++] = fp0;
+        pool_t1[i] = is_hub(fp1) ? PF_INF : tok.intern(fp1, n_tok);
+        if (pool_t1[i] == n_tok) tok_fp[n_tok++] = fp1;
+        if (pool_t0[i] == PF_INF && pool_t1[i] == PF_INF) ++n_hubhub;
+    }
+
+    // ── 2. CSR adjacency over non-hub pools ───────────────────────────────
+    uint32_t* off    = static_cast<uint32_t*>(calloc(n_tok + 1, sizeof(uint32_t)));
+    uint32_t* load   = static_cast<uint32_t*>(calloc(n_tok + 1, sizeof(uint32_t)));
+    uint32_t* label  = static_cast<uint32_t*>(malloc((n_tok + 1) * sizeof(uint32_t)));
+    float*    acc    = static_cast<float*>   (calloc(n_tok + 1, sizeof(float)));
+    uint32_t* adj    = static_cast<uint32_t*>(malloc((n * 2u + 1u) * sizeof(uint32_t)));
+    float*    adj_w  = static_cast<float*>   (malloc((n * 2u + 1u) * sizeof(float)));
+    uint32_t* order  = static_cast<uint32_t*>(malloc((n_tok + 1) * sizeof(uint32_t)));
+    uint32_t* comm_load = static_cast<uint32_t*>(calloc(n_tok + 1, sizeof(uint32_t)));
+    uint32_t* shard_rem = static_cast<uint32_t*>(calloc(GS_MAX_SHARDS + 1, sizeof(uint32_t)));
+    uint32_t* comm_shard = static_cast<uint32_t*>(malloc((n_tok + 1) * sizeof(uint32_t)));
+
+    bool ok = pool_t0 && pool_t1 && tok_fp && off && load && label && acc && adj && adj_w
+           && order && comm_load && shard_rem && comm_shard;
+
+    if (ok) {
+        for (uint32_t i = 0; i < n; ++i) {
+            // Each pool loads exactly one token: the lower-indexed non-hub end
+            const uint32_t a = pool_t0[i], b = pool_t1[i];
+            if (a != PF_INF || b != PF_INF) ++load[std::min(a, b)];
+            if (a == PF_INF || b == PF_INF || a == b) continue;
+            ++off[a + 1]; ++off[b + 1];
+        }
+        for (uint32_t t = 0; t < n_tok; ++t) off[t + 1] += off[t];
+        uint32_t* cur = order;  // reuse as fill cursor
+        for (uint32_t t = 0; t < n_tok; ++t) cur[t] = off[t];
+        for (uint32_t i = 0; i < n; ++i) {
+            const uint32_t a = pool_t0[i], b = pool_t1[i];
+            if (a == PF_INF || b == PF_INF || a == b) continue;
+            const float w = pool_weight(pools[i]);
+            adj[cur[a]] = b; adj_w[cur[a]++] = w;
+            adj[cur[b]] = a; adj_w[cur[b]++] = w;
+        }
+
+        // ── 3. Weighted label propagation (in place, deterministic order) ─
+        for (uint32_t t = 0; t < n_tok; ++t) label[t] = t;
+        for (uint32_t r = 0; r < rounds; ++r) {
+            uint32_t changed = 0;
+            for (uint32_t t = 0; t < n_tok; ++t) {
+                if (off[t] == off[t + 1]) continue;
+                for (uint32_t e = off[t]; e < off[t + 1]; ++e) acc[label[adj[e]]] += adj_w[e];
+                uint32_t best = label[t];
+                float    best_w = acc[best];
+                for (uint32_t e = off[t]; e < off[t + 1]; ++e) {
+                    const uint32_t l = label[adj[e]];
+                    if (acc[l] > best_w || (acc[l] == best_w && l < best)) { best = l; best_w = acc[l]; }
+                }
+                for (uint32_t e = off[t]; e < off[t + 1]; ++e) acc[label[adj[e]]] = 0.0f;
+                if (best != label[t]) { label[t] = best; ++changed; }
+            }
+            if (!changed) break;
+        }
+
+        // ── 4. First-fit-decreasing pack of communities into shards ───────
+        const uint32_t cap = PF_MAX_POOLS * fill / 100u > n_hubhub
+                           ? PF_MAX_POOLS * fill / 100u - n_hubhub : 1u;
+        for (uint32_t t = 0; t < n_tok; ++t) comm_load[label[t]] += load[t];
+        uint32_t n_comm = 0;
+        for (uint32_t t = 0; t < n_tok; ++t) if (comm_load[t]) order[n_comm++] = t;
+        std::sort(order, order + n_comm, [&](uint32_t x, uint32_t y) {
+            return comm_load[x] != comm_load[y] ? comm_load[x] > comm_load[y] : x < y;
+        });
+        for (uint32_t t = 0; t < n_tok; ++t) comm_shard[t] = PF_INF;
+
+        n_shards = 1;  // hub shard
+        for (uint32_t c = 0; c < n_comm; ++c) {
+            const uint32_t l = order[c], need = comm_load[l];
+            if (need > cap) continue;  // split at token granularity below
+            uint32_t s = 1;
+            while (s < n_shards && shard_rem[s] < need) ++s;
+            if (s == n_shards) {
+                if (n_shards > GS_MAX_SHARDS) continue;
+                shard_rem[n_shards++] = cap;
+            }
+            shard_rem[s] -= need;
+            comm_shard[l] = s;
+        }
+
+        uint32_t split_shard = 0;
+        for (uint32_t t = 0; t < n_tok; ++t) {
+            uint32_t s = comm_shard[label[t]];
+            if (s == PF_INF && comm_load[label[t]] > cap) {
+                // Oversized community: fill dedicated shards token by token
+                if (split_shard == 0 || shard_rem[split_shard] < load[t]) {
+                    split_shard = n_shards <= GS_MAX_SHARDS ? n_shards++ : 0;
+                    if (split_shard) shard_rem[split_shard] = cap;
+                }
+                s = split_shard ? split_shard : PF_INF;
+                if (split_shard) shard_rem[split_shard] -= std::min(shard_rem[split_shard], load[t]);
+            }
+            order[t] = s == PF_INF ? GS_HUB_SHARD : s;  // order[] is free again
+        }
+
+        // ── 5. Enough hub shards for every hub-bound pool at the target fill
+        uint32_t hub_load = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            const uint32_t a = pool_t0[i], b = pool_t1[i];
+            if (a == PF_INF && b == PF_INF) continue;  // replicated everywhere
+            if (a != PF_INF && b != PF_INF && order[a] == order[b] && order[a] != GS_HUB_SHARD) continue;
+            ++hub_load;
+        }
+        n_hub_shards = std::max(1u, (hub_load + cap - 1) / cap);
+        hub_fill     = cap + n_hubhub;
+        if (n_hub_shards > GS_MAX_HUB_SHARDS) ok = false;  // refuse rather than drop
+
+        // Community shards follow the hub shards
+        if (ok && !token_shard.init(n_tok + 1u)) ok = false;
+        for (uint32_t t = 0; ok && t < n_tok; ++t)
+            token_shard.intern(tok_fp[t], order[t] == GS_HUB_SHARD ? GS_HUB_SHARD
+                                                                   : order[t] + n_hub_shards - 1);
+        n_shards += n_hub_shards - 1;
+    }
+
+    free(pool_t0); free(pool_t1); free(tok_fp); free(off); free(load); free(label);
+    free(acc); free(adj); free(adj_w); free(order); free(comm_load); free(shard_rem); free(comm_shard);
+    tok.release();
+    if (!ok) return false;
+
+    // ── 6. One contiguous allocation for every shard's SoA arrays ─────────
+    void* mem = nullptr;
+    if (posix_memalign(&mem, 64, sizeof(PoolGraph) * n_shards) != 0) return false;
+    graphs  = static_cast<PoolGraph*>(mem);
+    memset(graphs, 0, sizeof(PoolGraph) * n_shards);
+    stats   = static_cast<ShardStats*>(calloc(n_shards, sizeof(ShardStats)));
+    results = static_cast<PathfinderResult*>(calloc(n_shards, sizeof(PathfinderResult)));
+    if (!stats || !results) return false;
+
+    // ── 7. Place pools ────────────────────────────────────────────────────
+    for (uint32_t i = 0; i < n; ++i) {
+        const uint32_t copies = place(pools[i], report.n_cross, report.n_dropped);
+        if (copies > 1) report.n_replicated += copies - 1;
+    }
+    for (uint32_t s = 0; s < n_shards; ++s) stats[s].n_pools = graphs[s].n_pools;
+
+    report.n_shards     = n_shards;
+    report.n_hub_shards = n_hub_shards;
+    report.cross_ratio  = n ? static_cast<float>(report.n_cross) / static_cast<float>(n) : 0.0f;
+    return true;
+}
+
+inline void ShardedGraph::worker_loop(ShardWorker& w) noexcept {
+    uint64_t seen = 0;
+    for (;;) {
+        // Spin, then park until a new generation is published
+        uint64_t gen = job_gen.load(std::memory_order_acquire);
+        for (uint32_t i = 0; gen == seen && i < GS_SPIN_ITERS && !stop.load(std::memory_order_relaxed); ++i) {
+            GS_CPU_PAUSE();
+            gen = job_gen.load(std::memory_order_acquire);
+        }
+        if (gen == seen && !stop.load()) {
+            pthread_mutex_lock(&park_mu);
+            parked.fetch_add(1);
+            while ((gen = job_gen.load()) == seen && !stop.load())
+                pthread_cond_wait(&park_cv, &park_mu);
+            parked.fetch_sub(1);
+            pthread_mutex_unlock(&park_mu);
+        }
+        if (stop.load(std::memory_order_acquire)) return;
+        seen = gen;
+
+        for (uint32_t s = w.id; s < n_shards; s += n_workers) {
+            if (!(job_mask[s >> 6] & (1ULL << (s & 63)))) continue;
+            const uint64_t t0 = graph_shard_internal::now_ns();
+            const PoolGraph& g = graphs[s];
+            results[s] = find_best_path(g, g.tokens.find(job_in), g.tokens.find(job_out), job_hint);
+            const uint64_t dt = graph_shard_internal::now_ns() - t0;
+            ShardStats& st = stats[s];
+            ++st.searches;
+            st.total_ns += dt;
+            st.last_ns   = dt;
+            st.max_ns    = std::max(st.max_ns, dt);
+        }
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+static inline void* graph_shard_worker_main(void* arg) {
+    ShardWorker* w = static_cast<ShardWorker*>(arg);
+    w->owner->worker_loop(*w);
+    return nullptr;
+}
+
+inline bool ShardedGraph::start_workers(const ShardConfig& cfg) noexcept {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    n_workers = cfg.n_workers ? cfg.n_workers : std::min<uint32_t>(n_shards, static_cast<uint32_t>(cpus));
+    n_workers = std::max(1u, std::min(n_workers, GS_MAX_WORKERS));
+    report.n_workers = n_workers;
+
+    for (uint32_t w = 0; w < n_workers; ++w) {
+        ShardWorker& wk = workers[w];
+        wk.owner   = this;
+        wk.id      = w;
+        wk.cpu     = cfg.first_cpu >= 0 ? static_cast<int32_t>((cfg.first_cpu + w) % cpus) : -1;
+        wk.started = pthread_create(&wk.thread, nullptr, graph_shard_worker_main, &wk) == 0;
+        if (!wk.started) return false;
+#ifdef __linux__
+        if (wk.cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(wk.cpu, &set);
+            pthread_setaffinity_np(wk.thread, sizeof(set), &set);  // best effort
+        }
+#endif
+        for (uint32_t s = w; s < n_shards; s += n_workers) stats[s].worker = w;
+    }
+    return true;
+}
+
+inline void ShardedGraph::shutdown() noexcept {
+    stop.store(true, std::memory_order_release);
+    pthread_mutex_lock(&park_mu);
+    pthread_cond_broadcast(&park_cv);
+    pthread_mutex_unlock(&park_mu);
+    for (uint32_t w = 0; w < n_workers; ++w)
+        if (workers[w].started) pthread_join(workers[w].thread, nullptr);
+    pthread_mutex_destroy(&park_mu);
+    pthread_cond_destroy(&park_cv);
+}
+
+inline ShardedGraph* ShardedGraph::create(const AMMPool* pools, uint32_t n, const ShardConfig& cfg) noexcept {
+    ShardedGraph* sg = new (std::nothrow) ShardedGraph{};
+    if (!sg) return nullptr;
+    pthread_mutex_init(&sg->park_mu, nullptr);
+    pthread_cond_init(&sg->park_cv, nullptr);
+    if (!sg->build(pools, n, cfg) || !sg->start_workers(cfg)) {
+        destroy(sg);
+        return nullptr;
+    }
+    return sg;
+}
+
+inline void ShardedGraph::destroy(ShardedGraph* sg) noexcept {
+    if (!sg) return;
+    sg->shutdown();
+    free(sg->graphs); free(sg->stats); free(sg->results);
+    sg->token_shard.release();
+    delete sg;
+}
+
+/// Search every shard that can hold a path from token_in (its own shard plus
+/// the hub shards; all shards for hub or unknown tokens) in parallel.
+/// Not reentrant: one query at a time per ShardedGraph.
+inline PathfinderResult ShardedGraph::find_best(
+    const uint8_t* token_in, const uint8_t* token_out, uint64_t hint
+) noexcept {
+    memset(job_mask, 0, sizeof(job_mask));
+    const uint64_t in_fp = PoolGraph::pf_fnv1a(token_in, 20);
+    const uint32_t own = is_hub(in_fp) ? GS_HUB_SHARD : shard_of(in_fp);
+    const uint32_t upto = own == GS_HUB_SHARD ? n_shards : n_hub_shards;
+    for (uint32_t s = 0; s < upto; ++s) job_mask[s >> 6] |= 1ULL << (s & 63);
+    job_mask[own >> 6] |= 1ULL << (own & 63);
+    memcpy(job_in, token_in, 20);
+    memcpy(job_out, token_out, 20);
+    job_hint = hint;
+
+    pending.store(n_workers, std::memory_order_relaxed);
+    job_gen.fetch_add(1);  // seq_cst: orders against the parked check below
+    if (parked.load() > 0) {
+        pthread_mutex_lock(&park_mu);
+        pthread_cond_broadcast(&park_cv);
+        pthread_mutex_unlock(&park_mu);
+    }
+    while (pending.load(std::memory_order_acquire) != 0) GS_CPU_PAUSE();
+
+    PathfinderResult best{};
+    for (uint32_t s = 0; s < n_shards; ++s) {
+        if (!(job_mask[s >> 6] & (1ULL << (s & 63)))) continue;
+        if (results[s].valid && results[s].gross_profit > best.gross_profit) best = results[s];
+    }
+    return best;
+}
+
+// ─── C ABI exports ────────────────────────────────────────────────────────────
+
+#ifdef GRAPH_SHARD_IMPL
+extern "C" {
+
+/// Partition `pools` into community shards and start pinned workers.
+/// Returns NULL on allocation failure.  `report` (optional) receives the summary.
+ShardedGraph* graph_shard_create(
+    const AMMPool*     pools,
+    uint32_t           n_pools,
+    const ShardConfig* cfg,
+    ShardReport*       report
+) {
+    if (!cfg || (!pools && n_pools)) return nullptr;
+    ShardedGraph* sg = ShardedGraph::create(pools, n_pools, *cfg);
+    if (!sg) return nullptr;
+    if (report) *report = sg->report;
+    return sg;
+}
+
+/// Stop workers and free all shard memory.
+void graph_shard_destroy(ShardedGraph* sg) {
+    ShardedGraph::destroy(sg);
+}
+
+/// Route a pool update to every shard holding a copy. Returns copies written.
+/// A pool new to the graph counts towards n_input and, if cross, n_cross.
+uint32_t graph_shard_upsert(ShardedGraph* sg, const AMMPool* pool) {
+    if (!sg || !pool) return 0;
+    ShardReport& r = sg->report;
+    bool fresh = false;
+    uint32_t n = sg->place(*pool, r.n_cross, r.n_dropped, &fresh);
+    if (fresh) {
+        ++r.n_input;
+        r.cross_ratio = static_cast<float>(r.n_cross) / static_cast<float>(r.n_input);
+    }
+    for (uint32_t s = 0; s < sg->n_shards; ++s) sg->stats[s].n_pools = sg->graphs[s].n_pools;
+    return n;
+}
+
+/// Parallel best-path search across the relevant shards (20-byte token
+/// addresses). Returns 1 if profitable.
+int graph_shard_find_best(
+    ShardedGraph*     sg,
+    const uint8_t*    token_in,
+    const uint8_t*    token_out,
+    uint64_t          amount_hint,
+    PathfinderResult* out
+) {
+    if (!sg || !token_in || !token_out || !out) return 0;
+    *out = sg->find_best(token_in, token_out, amount_hint);
+    return out->valid ? 1 : 0;
+}
+
+/// Copy up to `max` per-shard stats (hub shards first). Returns shard count.
+uint32_t graph_shard_stats(const ShardedGraph* sg, ShardStats* out, uint32_t max) {
+    if (!sg) return 0;
+    if (out) memcpy(out, sg->stats, sizeof(ShardStats) * std::min(max, sg->n_shards));
+    return sg->n_shards;
+}
+
+/// Partition summary, including the cross-shard edge ratio.
+void graph_shard_report(const ShardedGraph* sg, ShardReport* out) {
+    if (sg && out) *out = sg->report;
+}
+
+} // extern "C"
+#endif // GRAPH_SHARD_IMPL
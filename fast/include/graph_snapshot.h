@@ -0,0 +1,390 @@
+#pragma once
+/**
+ * graph_snapshot.h — versioned, checksummed on-disk snapshot of a PoolGraph
+ *
+ * Lets a restarted node load the last known pool graph in milliseconds and
+ * only catch up the blocks since `last_block`, instead of re-discovering and
+ * re-fetching every pool over RPC.
+ *
+ * File layout (little-endian, every section 64-byte aligned):
+ *
+ *   SnapshotHeader   magic "MEVPGSNP", format version, n_pools, last_block,
+ *                    version_clock, checksum of the whole file (the
+ *                    checksum field itself read as zero)
+ *   SnapshotSection  n_sections × { id, elem_size, offset, length }
+ *   section data     one SoA array per section, n_pools elements each
+ *
+ * Loading is an mmap + validation + one memcpy per section: section offsets
+ * are turned into pointers into the mapping and copied straight into the
+ * graph's SoA arrays.  Saving writes `<path>.tmp`, fsyncs, then renames, so
+ * a crash mid-save never leaves a torn snapshot behind.
+ *
+ * The reorg undo journal is not persisted: after a load the graph cannot be
+ * rolled back past `last_block`.
+ *
+ * The checksum is FNV-1a over 64-bit words (sections are zero-padded to 64
+ * bytes), ~8× faster than the byte-wise fingerprint hash.
+ *
+ * Compile with -std=c++20.
+ */
+
+#include "pathfinder.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#  include <io.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+// ─── Constants ────────────────────────────────────────────────────────────────
+
+static constexpr uint32_t PF_SNAP_VERSION = 1;
+static constexpr uint32_t PF_SNAP_ALIGN   = 64;
+static constexpr char     PF_SNAP_MAGIC[8] = { 'M', 'E', 'V', 'P', 'G', 'S', 'N', 'P' };
+
+/// Return codes for pathfinder_snapshot_*
+enum : int {
+    PF_SNAP_OK        =  0,
+    PF_SNAP_EIO       = -1,  ///< open/read/write/mmap failed
+    PF_SNAP_EFORMAT   = -2,  ///< bad magic, truncated file or inconsistent section table
+    PF_SNAP_EVERSION  = -3,  ///< written by an incompatible format version
+    PF_SNAP_ECHECKSUM = -4,  ///< payload does not match the stored checksum
+    PF_SNAP_ECAPACITY = -5,  ///< snapshot holds more pools than PF_MAX_POOLS
+};
+
+/// Section identifiers — stable across format versions
+enum : uint32_t {
+    PF_SEC_RESERVE0  = 1,
+    PF_SEC_RESERVE1  = 2,
+    PF_SEC_FEE_BPS   = 3,
+    PF_SEC_IS_V3     = 4,
+    PF_SEC_POOL_ADDR = 5,
+    PF_SEC_TOK0_ADDR = 6,
+    PF_SEC_TOK1_ADDR = 7,
+    PF_SEC_VERSION   = 8,
+    PF_SEC_BLOCK_UPD = 9,
+    PF_SEC_POOL_FP   = 10,
+    PF_SEC_TICK      = 11,
+};
+
+// ─── On-disk structs ─────────────────────────────────────────────────────────
+
+#pragma pack(push, 1)
+struct SnapshotHeader {
+    char     magic[8];
+    uint32_t format_version;
+    uint32_t header_size;      ///< sizeof(SnapshotHeader), for forward compatibility
+    uint32_t n_sections;
+    uint32_t n_pools;
+    uint64_t last_block;       ///< Chain head the graph reflects
+    uint64_t checksum;         ///< FNV-1a-64 (word-wise) over the file, this field as 0
+    uint64_t file_size;
+    uint32_t version_clock;
+    uint8_t  _pad[12];
+};
+static_assert(sizeof(SnapshotHeader) == 64, "header must stay one cache line");
+
+struct SnapshotSection {
+    uint32_t id;
+    uint32_t elem_size;        ///< Bytes per pool slot
+    uint64_t offset;           ///< From start of file, PF_SNAP_ALIGN aligned
+    uint64_t length;           ///< elem_size × n_pools
+    uint64_t _reserved;
+};
+static_assert(sizeof(SnapshotSection) == 32, "section entries are fixed size");
+#pragma pack(pop)
+
+// ─── Internal snapshot logic ─────────────────────────────────────────────────
+
+namespace graph_snapshot_internal {
+
+/// A SoA array of the graph and its section id
+struct SectionRef {
+    uint32_t id;
+    uint32_t elem_size;
+    uint8_t* base;
+};
+
+static constexpr uint32_t N_SECTIONS = 11;
+
+/// Every persisted SoA array.  Adding a field = adding a line here + an id.
+static inline void graph_sections(PoolGraph& g, SectionRef (&out)[N_SECTIONS]) noexcept {
+    out[0] = { PF_SEC_RESERVE0,  sizeof(g.reserve0[0]),  reinterpret_cast<uint8_t*>(g.reserve0)  };
+    out[1] = { PF_SEC_RESERVE1,  sizeof(g.reserve1[0]),  reinterpret_cast<uint8_t*>(g.reserve1)  };
+    out[2] = { PF_SEC_FEE_BPS,   sizeof(g.fee_bps[0]),   reinterpret_cast<uint8_t*>(g.fee_bps)   };
+    out[3] = { PF_SEC_IS_V3,     sizeof(g.is_v3[0]),     reinterpret_cast<uint8_t*>(g.is_v3)     };
+    out[4] = { PF_SEC_POOL_ADDR, sizeof(g.pool_addr[0]), reinterpret_cast<uint8_t*>(g.pool_addr) };
+    out[5] = { PF_SEC_TOK0_ADDR, sizeof(g.tok0_addr[0]), reinterpret_cast<uint8_t*>(g.tok0_addr) };
+    out[6] = { PF_SEC_TOK1_ADDR, sizeof(g.tok1_addr[0]), reinterpret_cast<uint8_t*>(g.tok1_addr) };
+    out[7] = { PF_SEC_VERSION,   sizeof(g.version[0]),   reinterpret_cast<uint8_t*>(g.version)   };
+    out[8] = { PF_SEC_BLOCK_UPD, sizeof(g.block_updated[0]), reinterpret_cast<uint8_t*>(g.block_updated) };
+    out[9] = { PF_SEC_POOL_FP,   sizeof(g.pool_fp[0]),   reinterpret_cast<uint8_t*>(g.pool_fp)   };
+    out[10]= { PF_SEC_TICK,      sizeof(g.tick[0]),      reinterpret_cast<uint8_t*>(g.tick)      };
+}
+
+[[nodiscard]] static inline uint64_t align_up(uint64_t v) noexcept {
+    return (v + PF_SNAP_ALIGN - 1) & ~static_cast<uint64_t>(PF_SNAP_ALIGN - 1);
+}
+
+/// FNV-1a over 64-bit words; `len` must be a multiple of 8.  Pass a
+/// previous result as `h` to continue over the next range.
+[[nodiscard]] static inline uint64_t checksum(
+    const uint8_t* p, uint64_t len, uint64_t h = 14695981039346656037ULL
+) noexcept {
+    for (uint64_t i = 0; i < len; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h ^= w;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/// Checksum of an encoded snapshot: header (checksum field as zero), then
+/// everything after it.  `size` >= sizeof(SnapshotHeader), multiple of 8.
+[[nodiscard]] static inline uint64_t file_checksum(const uint8_t* data, uint64_t size) noexcept {
+    SnapshotHeader hdr;
+    memcpy(&hdr, data, sizeof(hdr));
+    hdr.checksum = 0;
+    const uint64_t h = checksum(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr));
+    return checksum(data + sizeof(hdr), size - sizeof(hdr), h);
+}
+
+/// Read-only view of a whole file (mmap on POSIX, heap copy on Windows)
+struct FileView {
+    const uint8_t* data = nullptr;
+    uint64_t       size = 0;
+#ifndef _WIN32
+    bool           mapped = false;
+#endif
+
+    bool open(const char* path) noexcept {
+#ifdef _WIN32
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        fseek(f, 0, SEEK_END);
+        long len = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        if (len <= 0) { fclose(f); return false; }
+        uint8_t* buf = static_cast<uint8_t*>(malloc(static_cast<size_t>(len)));
+        bool ok = buf && fread(buf, 1, static_cast<size_t>(len), f) == static_cast<size_t>(len);
+        fclose(f);
+        if (!ok) { free(buf); return false; }
+        data = buf;
+        size = static_cast<uint64_t>(len);
+        return true;
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+        void* m = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (m == MAP_FAILED) return false;
+        data   = static_cast<const uint8_t*>(m);
+        size   = static_cast<uint64_t>(st.st_size);
+        mapped = true;
+        return true;
+#endif
+    }
+
+    void close() noexcept {
+#ifdef _WIN32
+        free(const_cast<uint8_t*>(data));
+#else
+        if (mapped) munmap(const_cast<uint8_t*>(data), size);
+        mapped = false;
+#endif
+        data = nullptr;
+        size = 0;
+    }
+};
+
+} // namespace graph_snapshot_internal
+
+// ─── Save / load ─────────────────────────────────────────────────────────────
+
+/// Serialize `g` into a malloc'd buffer (caller frees) in the on-disk format.
+[[nodiscard]] static inline int snapshot_encode(
+    const PoolGraph& g,
+    uint64_t         last_block,
+    uint8_t**        out,
+    uint64_t*        out_size
+) noexcept {
+    using namespace graph_snapshot_internal;
+
+    SectionRef refs[N_SECTIONS];
+    graph_sections(const_cast<PoolGraph&>(g), refs);
+
+    const uint64_t table_off = sizeof(SnapshotHeader);
+    uint64_t off = align_up(table_off + sizeof(SnapshotSection) * N_SECTIONS);
+    SnapshotSection table[N_SECTIONS] = {};
+    for (uint32_t i = 0; i < N_SECTIONS; ++i) {
+        table[i].id        = refs[i].id;
+        table[i].elem_size = refs[i].elem_size;
+        table[i].offset    = off;
+        table[i].length    = static_cast<uint64_t>(refs[i].elem_size) * g.n_pools;
+        off = align_up(off + table[i].length);
+    }
+    const uint64_t file_size = off;
+
+    // Assemble in memory: the graph is at most a few hundred KB
+    uint8_t* buf = static_cast<uint8_t*>(calloc(1, file_size));
+    if (!buf) return PF_SNAP_EIO;
+    memcpy(buf + table_off, table, sizeof(table));
+    for (uint32_t i = 0; i < N_SECTIONS; ++i)
+        memcpy(buf + table[i].offset, refs[i].base, table[i].length);
+
+    SnapshotHeader hdr{};
+    memcpy(hdr.magic, PF_SNAP_MAGIC, sizeof(hdr.magic));
+    hdr.format_version = PF_SNAP_VERSION;
+    hdr.header_size    = sizeof(SnapshotHeader);
+    hdr.n_sections     = N_SECTIONS;
+    hdr.n_pools        = g.n_pools;
+    hdr.last_block     = last_block;
+    hdr.file_size      = file_size;
+    hdr.version_clock  = g.version_clock;
+    memcpy(buf, &hdr, sizeof(hdr));
+    hdr.checksum       = file_checksum(buf, file_size);
+    memcpy(buf, &hdr, sizeof(hdr));
+
+    *out      = buf;
+    *out_size = file_size;
+    return PF_SNAP_OK;
+}
+
+/// Serialize `g` to `path` atomically (write tmp + fsync + rename).
+[[nodiscard]] static inline int snapshot_save(const PoolGraph& g, const char* path, uint64_t last_block) noexcept {
+    uint8_t* buf = nullptr;
+    uint64_t file_size = 0;
+    if (snapshot_encode(g, last_block, &buf, &file_size) != PF_SNAP_OK) return PF_SNAP_EIO;
+
+    char tmp[4096];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= static_cast<int>(sizeof(tmp))) {
+        free(buf);
+        return PF_SNAP_EIO;
+    }
+    FILE* f = fopen(tmp, "wb");
+    bool ok = f && fwrite(buf, 1, file_size, f) == file_size && fflush(f) == 0;
+#ifndef _WIN32
+    ok = ok && fsync(fileno(f)) == 0;
+#endif
+    if (f) ok = (fclose(f) == 0) && ok;
+    free(buf);
+#ifdef _WIN32
+    if (ok) remove(path);  // rename() does not overwrite on Windows
+#endif
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return PF_SNAP_EIO;
+    }
+    return PF_SNAP_OK;
+}
+
+/// Replace `g` with the encoded snapshot in `data`.  `g` is untouched on error.
+[[nodiscard]] static inline int snapshot_decode(
+    PoolGraph&     g,
+    const uint8_t* data,
+    uint64_t       size,
+    uint64_t*      last_block
+) noexcept {
+    using namespace graph_snapshot_internal;
+
+    int rc = PF_SNAP_OK;
+    SnapshotHeader hdr;
+    const SnapshotSection* table = nullptr;
+
+    if (size < sizeof(hdr)) {
+        rc = PF_SNAP_EFORMAT;
+    } else {
+        memcpy(&hdr, data, sizeof(hdr));
+        const uint64_t table_end = static_cast<uint64_t>(hdr.header_size)
+                                 + static_cast<uint64_t>(hdr.n_sections) * sizeof(SnapshotSection);
+        if (memcmp(hdr.magic, PF_SNAP_MAGIC, sizeof(hdr.magic)) != 0
+            || hdr.header_size < sizeof(hdr) || hdr.file_size != size || table_end > size
+            || size % 8 != 0 || hdr.header_size % 8 != 0) {
+            rc = PF_SNAP_EFORMAT;
+        } else if (hdr.format_version != PF_SNAP_VERSION) {
+            rc = PF_SNAP_EVERSION;
+        } else if (hdr.n_pools > PF_MAX_POOLS) {
+            rc = PF_SNAP_ECAPACITY;
+        } else if (file_checksum(data, size) != hdr.checksum) {
+            rc = PF_SNAP_ECHECKSUM;
+        } else {
+            table = reinterpret_cast<const SnapshotSection*>(data + hdr.header_size);
+        }
+    }
+
+    // Validate every section we need before touching the graph
+    SectionRef refs[N_SECTIONS];
+    graph_sections(g, refs);
+    const uint8_t* src[N_SECTIONS] = {};
+    for (uint32_t i = 0; rc == PF_SNAP_OK && i < N_SECTIONS; ++i) {
+        for (uint32_t s = 0; s < hdr.n_sections; ++s) {
+            SnapshotSection sec;
+            memcpy(&sec, &table[s], sizeof(sec));
+            if (sec.id != refs[i].id) continue;
+            if (sec.elem_size != refs[i].elem_size
+                || sec.length != static_cast<uint64_t>(sec.elem_size) * hdr.n_pools
+                || sec.offset > size || sec.length > size - sec.offset) {
+                rc = PF_SNAP_EFORMAT;
+            } else {
+                src[i] = data + sec.offset;  // pointer fix-up: offset → mapped address
+            }
+            break;
+        }
+        if (rc == PF_SNAP_OK && !src[i]) rc = PF_SNAP_EFORMAT;
+    }
+
+    if (rc == PF_SNAP_OK) {
+        g.clear();
+        for (uint32_t i = 0; i < N_SECTIONS; ++i)
+            memcpy(refs[i].base, src[i], static_cast<size_t>(refs[i].elem_size) * hdr.n_pools);
+        g.n_pools       = hdr.n_pools;
+        g.version_clock = hdr.version_clock;
+        // Token ids are graph-local: re-intern from the per-slot addresses
+        for (uint32_t i = 0; i < g.n_pools; ++i) {
+            g.token0_id[i] = g.tokens.intern(g.tok0_addr[i]);
+            g.token1_id[i] = g.tokens.intern(g.tok1_addr[i]);
+        }
+        g.journal_floor = hdr.last_block;
+        if (last_block) *last_block = hdr.last_block;
+    }
+    return rc;
+}
+
+/// Load `path` into `g`, replacing its contents.  `g` is untouched on error.
+[[nodiscard]] static inline int snapshot_load(PoolGraph& g, const char* path, uint64_t* last_block) noexcept {
+    graph_snapshot_internal::FileView v;
+    if (!v.open(path)) return PF_SNAP_EIO;
+    int rc = snapshot_decode(g, v.data, v.size, last_block);
+    v.close();
+    return rc;
+}
+
+// ─── C ABI exports ────────────────────────────────────────────────────────────
+
+#ifdef GRAPH_SNAPSHOT_IMPL
+extern "C" {
+
+/// Write a snapshot of `graph` reflecting chain head `last_block`. Returns PF_SNAP_*.
+int pathfinder_snapshot_save(const PoolGraph* graph, const char* path, uint64_t last_block) {
+    if (!graph || !path) return PF_SNAP_EIO;
+    return snapshot_save(*graph, path, last_block);
+}
+
+/// Replace `graph` with the snapshot at `path`; `last_block` (optional) receives
+/// the block to resume catch-up from. Returns PF_SNAP_*.
+int pathfinder_snapshot_load(PoolGraph* graph, const char* path, uint64_t* last_block) {
+    if (!graph || !path) return PF_SNAP_EIO;
+    return snapshot_load(*graph, path, last_block);
+}
+
+} // extern "C"
+#endif // GRAPH_SNAPSHOT_IMPL
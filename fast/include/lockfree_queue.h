@@ -2,6 +2,7 @@
 #define MEV_LOCKFREE_QUEUE_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,13 +19,34 @@ int mev_queue_push(mev_queue_t* q, void* item);
 void* mev_queue_pop(mev_queue_t* q);
 void* mev_queue_try_pop(mev_queue_t* q);
 
-// Batch operations
+// Batch operations — claim a run of slots with one CAS; return the count moved
+size_t mev_queue_push_batch(mev_queue_t* q, void* const* items, size_t n_items);
 size_t mev_queue_pop_batch(mev_queue_t* q, void** items, size_t max_items);
 
 // Status
 size_t mev_queue_size(mev_queue_t* q);
 int mev_queue_empty(mev_queue_t* q);
 
+// Telemetry (off unless enabled).  Enable before the queue is shared; one
+// push in 2^sample_shift is rdtsc-stamped and its enqueue → dequeue time
+// recorded in a log2 histogram.
+#define MEV_QUEUE_LAT_BUCKETS 32
+
+typedef struct {
+    uint64_t pushes;
+    uint64_t pops;
+    uint64_t full;                               // push / push_batch calls cut short by a full queue
+    uint64_t depth;                              // occupancy at snapshot time
+    uint64_t high_water;                         // deepest occupancy seen after a push
+    uint64_t capacity;
+    uint64_t sampled;                            // sojourn samples recorded
+    double   ticks_per_ns;                       // TSC rate measured since enable
+    uint64_t sojourn[MEV_QUEUE_LAT_BUCKETS];     // bucket b: [2^b, 2^(b+1)) ticks
+} mev_queue_stats_t;
+
+int mev_queue_enable_stats(mev_queue_t* q, unsigned sample_shift);
+int mev_queue_stats(mev_queue_t* q, mev_queue_stats_t* out);   // -1 if not enabled
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,234 @@
+#pragma once
+/**
+ * log_decoder.h — batch pool-event decoder that writes straight into PoolGraph
+ *
+ * Pool state arrives as receipts' logs.  Instead of decoding each log into an
+ * AMMPool and round-tripping through upsert(), a block's raw log records are
+ * handed over in one call: topic0 is matched against the four known event
+ * hashes, the fields are decoded in place from the ABI words and applied to
+ * the pool's slot (journaled, version bumped).  The caller gets back a
+ * bitset of the slots that changed, ready for incremental re-evaluation
+ * (SpotRateMatrix::refresh, cache invalidation, ...).
+ *
+ * Handled events:
+ *
+ *   V2 Sync(uint112 reserve0, uint112 reserve1)
+ *        → reserve0 / reserve1
+ *   V3 Swap(address indexed, address indexed, int256, int256,
+ *           uint160 sqrtPriceX96, uint128 liquidity, int24 tick)
+ *        → reserve0 = liquidity, reserve1 = sqrtPriceX96 >> 32, tick
+ *   V3 Mint(address, address indexed, int24 indexed, int24 indexed,
+ *           uint128 amount, uint256, uint256)
+ *   V3 Burn(address indexed, int24 indexed, int24 indexed,
+ *           uint128 amount, uint256, uint256)
+ *        → liquidity ± amount when tickLower <= tick < tickUpper
+ *
+ * The V3 encoding matches amm_simulator's (reserve0 = active liquidity,
+ * reserve1 = sqrtPrice in Q64).  A log carrying a value that does not fit
+ * 64 bits (or pushing liquidity past it) is counted as overflowed and
+ * skipped — a clamped reserve would look like a real, mispriced pool.
+ * Logs from unknown addresses, unknown events, V2/V3 mismatches and
+ * truncated payloads are skipped too.
+ *
+ * Compile with -std=c++20.
+ */
+
+#include "pathfinder.h"
+
+// ─── Constants ────────────────────────────────────────────────────────────────
+
+static constexpr uint32_t LD_MAX_TOPICS  = 4;
+static constexpr uint32_t LD_DIRTY_WORDS = PF_MAX_POOLS / 64;
+
+/// keccak256 of the event signatures (topic0)
+static constexpr uint8_t LD_TOPIC_SYNC[32] = {
+    0x1c,0x41,0x1e,0x9a,0x96,0xe0,0x71,0x24,0x1c,0x2f,0x21,0xf7,0x72,0x6b,0x17,0xae,
+    0x89,0xe3,0xca,0xb4,0xc7,0x8b,0xe5,0x0e,0x06,0x2b,0x03,0xa9,0xff,0xfb,0xba,0xd1 };
+static constexpr uint8_t LD_TOPIC_SWAP_V3[32] = {
+    0xc4,0x20,0x79,0xf9,0x4a,0x63,0x50,0xd7,0xe6,0x23,0x5f,0x29,0x17,0x49,0x24,0xf9,
+    0x28,0xcc,0x2a,0xc8,0x18,0xeb,0x64,0xfe,0xd8,0x00,0x4e,0x11,0x5f,0xbc,0xca,0x67 };
+static constexpr uint8_t LD_TOPIC_MINT_V3[32] = {
+    0x7a,0x53,0x08,0x0b,0xa4,0x14,0x15,0x8b,0xe7,0xec,0x69,0xb9,0x87,0xb5,0xfb,0x7d,
+    0x07,0xde,0xe1,0x01,0xfe,0x85,0x48,0x8f,0x08,0x53,0xae,0x16,0x23,0x9d,0x0b,0xde };
+static constexpr uint8_t LD_TOPIC_BURN_V3[32] = {
+    0x0c,0x39,0x6c,0xd9,0x89,0xa3,0x9f,0x44,0x59,0xb5,0xfa,0x1a,0xed,0x6a,0x9a,0x8d,
+    0xcd,0xbc,0x45,0x90,0x8a,0xcf,0xd6,0x7e,0x02,0x8c,0xd5,0x68,0xda,0x98,0x98,0x2c };
+
+// ─── C-compatible types ───────────────────────────────────────────────────────
+
+#pragma pack(push, 1)
+
+/// One raw log record, as found in a receipt.  `data` is borrowed.
+struct EvmLog {
+    uint8_t        address[20];
+    uint8_t        n_topics;
+    uint8_t        _pad[3];
+    uint8_t        topics[LD_MAX_TOPICS][32];
+    const uint8_t* data;
+    uint32_t       data_len;
+    uint32_t       _pad2;
+    uint64_t       block_number;
+};
+
+/// Per-batch outcome counters
+struct LogDecodeStats {
+    uint32_t applied;     ///< logs that changed a pool
+    uint32_t unknown;     ///< topic0 not a handled event
+    uint32_t no_pool;     ///< emitter not in the graph
+    uint32_t malformed;   ///< short payload / missing topics / V2-V3 mismatch
+    uint32_t overflowed;  ///< a value wider than 64 bits: not applied
+    uint32_t n_dirty;     ///< distinct slots set in the dirty bitset
+};
+
+#pragma pack(pop)
+
+// ─── Decoder ──────────────────────────────────────────────────────────────────
+
+namespace log_decoder_internal {
+
+enum class Event : uint8_t { None, Sync, SwapV3, MintV3, BurnV3 };
+
+[[nodiscard]] inline Event classify(const uint8_t* topic0) noexcept {
+    // The first byte differs between all four hashes — dispatch on it and
+    // confirm with a full compare.
+    switch (topic0[0]) {
+    case 0x1c: return memcmp(topic0, LD_TOPIC_SYNC,    32) == 0 ? Event::Sync   : Event::None;
+    case 0xc4: return memcmp(topic0, LD_TOPIC_SWAP_V3, 32) == 0 ? Event::SwapV3 : Event::None;
+    case 0x7a: return memcmp(topic0, LD_TOPIC_MINT_V3, 32) == 0 ? Event::MintV3 : Event::None;
+    case 0x0c: return memcmp(topic0, LD_TOPIC_BURN_V3, 32) == 0 ? Event::BurnV3 : Event::None;
+    default:   return Event::None;
+    }
+}
+
+/// Big-endian 256-bit word → u64; false if any high byte is set.
+[[nodiscard]] inline bool word_u64(const uint8_t* w, uint64_t& out) noexcept {
+    for (int i = 0; i < 24; ++i)
+        if (w[i]) return false;
+    uint64_t v = 0;
+    for (int i = 24; i < 32; ++i) v = (v << 8) | w[i];
+    out = v;
+    return true;
+}
+
+/// Big-endian 256-bit word → (u256 >> shift) as u64; false if it does not
+/// fit.  shift < 64.
+[[nodiscard]] inline bool word_shr_u64(const uint8_t* w, uint32_t shift, uint64_t& out) noexcept {
+    // Bytes covering bits [shift + 64, 256) must be zero.
+    const uint32_t keep_bytes = (64 + shift + 7) / 8;   // low bytes that may be set
+    for (uint32_t i = 0; i < 32 - keep_bytes; ++i)
+        if (w[i]) return false;
+    unsigned __int128 v = 0;
+    for (uint32_t i = 32 - keep_bytes; i < 32; ++i) v = (v << 8) | w[i];
+    v >>= shift;
+    if (v > UINT64_MAX) return false;
+    out = static_cast<uint64_t>(v);
+    return true;
+}
+
+/// Sign-extended int24 in the low 3 bytes of a word.
+[[nodiscard]] inline int32_t word_i24(const uint8_t* w) noexcept {
+    uint32_t v = (uint32_t(w[29]) << 16) | (uint32_t(w[30]) << 8) | w[31];
+    return static_cast<int32_t>(v << 8) >> 8;
+}
+
+/// Decode one log and apply it to its slot. Returns the slot, or PF_INF.
+inline uint32_t apply_log(PoolGraph& g, const EvmLog& lg, LogDecodeStats& st) noexcept {
+    if (lg.n_topics == 0) { ++st.unknown; return PF_INF; }
+    const Event ev = classify(lg.topics[0]);
+    if (ev == Event::None) { ++st.unknown; return PF_INF; }
+
+    const uint32_t slot = g.find_slot(lg.address);
+    if (slot == PF_INF) { ++st.no_pool; return PF_INF; }
+
+    const uint8_t* d  = lg.data;
+    const bool     v3 = g.is_v3[slot] != 0;
+    uint64_t r0 = g.reserve0[slot], r1 = g.reserve1[slot];
+    int32_t  t  = g.tick[slot];
+
+    switch (ev) {
+    case Event::Sync:
+        if (v3 || !d || lg.data_len < 64) { ++st.malformed; return PF_INF; }
+        if (!word_u64(d, r0) || !word_u64(d + 32, r1)) { ++st.overflowed; return PF_INF; }
+        break;
+
+    case Event::SwapV3:
+        if (!v3 || !d || lg.data_len < 160) { ++st.malformed; return PF_INF; }
+        if (!word_shr_u64(d + 64, 32, r1)    // sqrtPriceX96 → Q64
+            || !word_u64(d + 96, r0)) {      // liquidity
+            ++st.overflowed; return PF_INF;
+        }
+        t  = word_i24(d + 128);
+        break;
+
+    case Event::MintV3:
+    case Event::BurnV3: {
+        // Mint data: sender, amount, amount0, amount1; Burn data: amount, amount0, amount1
+        const uint32_t amt_off = ev == Event::MintV3 ? 32u : 0u;
+        if (!v3 || lg.n_topics < 4 || !d || lg.data_len < amt_off + 32) {
+            ++st.malformed; return PF_INF;
+        }
+        const int32_t lower = word_i24(lg.topics[2]);
+        const int32_t upper = word_i24(lg.topics[3]);
+        // Out-of-range positions do not change active liquidity: nothing to apply
+        if (t < lower || t >= upper) return PF_INF;
+        uint64_t amt;
+        if (!word_u64(d + amt_off, amt) || (ev == Event::MintV3 && r0 > UINT64_MAX - amt)) {
+            ++st.overflowed; return PF_INF;
+        }
+        if (ev == Event::MintV3) r0 += amt;
+        else                     r0 = (r0 < amt) ? 0 : r0 - amt;
+        break;
+    }
+
+    case Event::None:
+        return PF_INF;
+    }
+
+    g.apply_state(slot, r0, r1, t, lg.block_number);
+    ++st.applied;
+    return slot;
+}
+
+} // namespace log_decoder_internal
+
+/// Decode `n` logs in order and apply them to `g`.  `dirty` (LD_DIRTY_WORDS
+/// words) is cleared, then bit i is set for every slot that changed.
+inline LogDecodeStats decode_logs(
+    PoolGraph&    g,
+    const EvmLog* logs,
+    uint32_t      n,
+    uint64_t*     dirty
+) noexcept {
+    LogDecodeStats st{};
+    uint64_t bits[LD_DIRTY_WORDS] = {};
+
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t slot = log_decoder_internal::apply_log(g, logs[i], st);
+        if (slot != PF_INF) bits[slot >> 6] |= 1ULL << (slot & 63);
+    }
+
+    for (uint32_t w = 0; w < LD_DIRTY_WORDS; ++w)
+        st.n_dirty += static_cast<uint32_t>(__builtin_popcountll(bits[w]));
+    if (dirty) memcpy(dirty, bits, sizeof(bits));
+    return st;
+}
+
+// ─── C ABI exports ────────────────────────────────────────────────────────────
+
+#ifdef LOG_DECODER_IMPL
+extern "C" {
+
+/// Apply a block's logs to the graph. `dirty` may be NULL; otherwise it must
+/// hold PF_MAX_POOLS/64 words and receives the changed-slot bitset.
+LogDecodeStats pathfinder_apply_logs(
+    PoolGraph*    graph,
+    const EvmLog* logs,
+    uint32_t      n_logs,
+    uint64_t*     dirty
+) {
+    if (!graph || (!logs && n_logs)) return LogDecodeStats{};
+    return decode_logs(*graph, logs, n_logs, dirty);
+}
+
+} // extern "C"
+#endif // LOG_DECODER_IMPL
@@ -2,13 +2,57 @@
 #define MEV_MEMORY_POOL_H
 
 #include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Initialize all pools - call once at startup
+// Size classes: ascending block sizes (rounded up to 64 bytes), each with
+// `initial` blocks committed at init and room reserved to grow to `max`
+#define MEV_POOL_MAX_CLASSES 16
+#define MEV_POOL_MAX_NODES   8    // NUMA nodes with their own copy of every class
+
+typedef struct {
+    size_t block_size;
+    uint32_t initial;     // pre-faulted and on the free list at init
+    uint32_t max;         // slab ceiling; past it blocks are malloc'd (fallbacks)
+} mev_size_class_t;
+
+typedef struct {
+    unsigned n_classes;
+    mev_size_class_t classes[MEV_POOL_MAX_CLASSES];
+    unsigned arena_flags;   // MEV_ARENA_*: HUGE for the mapping, PREFAULT / MLOCK for initial blocks
+    unsigned nodes;         // NUMA nodes, each with its own bound arena span: 0 = detect
+} mev_pools_config_t;
+
+// Default: 256 B .. 128 KB in 9 classes, MEV_ARENA_DEFAULT, one copy per
+// detected NUMA node (initial / max counts are per node)
+void mev_pools_default_config(mev_pools_config_t* cfg);
+
+// Initialize all pools - call once at startup (later calls with a valid
+// config are no-ops returning 0); -1 on an invalid config or if the arena
+// cannot be mapped.
+// mev_pools_init uses the default config; _arena the default classes
+// with the given MEV_ARENA_* flags (0: plain 4K pages, faulted lazily).
 int mev_pools_init(void);
+int mev_pools_init_arena(unsigned flags);
+int mev_pools_init_ex(const mev_pools_config_t* cfg);
+
+// Arena layout (one region per class slab per node) and pre-fault counts;
+// -1 before init
+int mev_pools_arena_info(mev_arena_info_t* out);
+
+// Any size: smallest class that fits, malloc (counted as oversize) above
+// the largest.  mev_free takes any block from mev_alloc* and finds its
+// class in O(1) — by address for slab blocks, by header otherwise.
+void* mev_alloc(size_t size);
+void mev_free(void* ptr);
+
+// Named classes: the smallest class holding 512 B / 2 KB / 256 B; each
+// free is mev_free and accepts any pool block
 
 // Transaction buffer pool (512 bytes each)
 void* mev_alloc_tx(void);
@@ -22,13 +66,62 @@ void mev_free_calldata(void* ptr);
 void* mev_alloc_result(void);
 void mev_free_result(void* ptr);
 
-// Batch operations
+// Batch operations (by class for `size`; free ignores it)
 int mev_alloc_batch(void** ptrs, size_t count, size_t size);
 void mev_free_batch(void** ptrs, size_t count, size_t size);
 
-// Stats
+// Stats for the named classes (blocks cached in per-thread magazines are
+// not counted as available)
 void mev_pool_stats(size_t* tx_avail, size_t* calldata_avail, size_t* result_avail);
 
+// Per-thread magazines — on by default; flush returns the calling thread's
+// cached blocks (done automatically at thread exit)
+void mev_pools_set_magazines(int enabled);
+void mev_pools_flush_thread(void);
+
+// Contention counters per pool
+typedef struct {
+    size_t cas_retries;   // failed CAS on the shared free-list head
+    size_t refills;       // magazine refills from the shared pool
+    size_t spills;        // magazine spills to the shared pool
+    size_t remote_frees;  // blocks freed by a thread on another NUMA node
+} mev_pool_contention_t;
+
+void mev_pool_contention(mev_pool_contention_t* tx, mev_pool_contention_t* calldata,
+                         mev_pool_contention_t* result);
+
+// Slab accounting per class: blocks (initial + grown, up to max_blocks)
+// - free are held by threads (magazines or callers); fallbacks are
+// malloc'd blocks handed out while the class was at its maximum
+typedef struct {
+    size_t block_size;
+    size_t blocks;
+    size_t free;
+    size_t fallback_allocs;
+    size_t fallback_live;
+    size_t max_blocks;
+} mev_pool_usage_t;
+
+void mev_pool_usage(mev_pool_usage_t* tx, mev_pool_usage_t* calldata, mev_pool_usage_t* result);
+
+// Per-class counters by index (ascending size), summed over nodes; -1 if
+// out of range
+unsigned mev_pools_class_count(void);
+int mev_pool_class_usage(unsigned cls, mev_pool_usage_t* out);
+int mev_pool_class_contention(unsigned cls, mev_pool_contention_t* out);
+
+// NUMA: a thread allocates from the node it runs on (rechecked on magazine
+// refills) unless pinned with set_thread_node (-1 unpins); frees go back
+// to the block's own node.  Per-node counters; -1 if out of range.
+unsigned mev_pools_node_count(void);
+int mev_pools_set_thread_node(int node);
+int mev_pools_thread_node(void);
+int mev_pool_node_usage(unsigned node, unsigned cls, mev_pool_usage_t* out);
+int mev_pool_node_contention(unsigned node, unsigned cls, mev_pool_contention_t* out);
+
+// mev_alloc sizes above the largest class
+void mev_pools_oversize(size_t* allocs, size_t* live);
+
 #ifdef __cplusplus
 }
 #endif
@@ -10,8 +10,11 @@
  *  - SoA layout for pool graph → cache-friendly iteration over token pairs
  *  - Paths are short (≤4 hops), so BFS is exhaustive without SSSP overhead
  *  - Ternary search (48 iters) finds optimal amount with sub-wei precision
- *  - Token fingerprints are 64-bit fnv1a hashes of the 20-byte EVM address
+ *  - Tokens are interned to dense 32-bit ids (TokenTable, address-verified),
+ *    so inner loops compare 4-byte ids and ids index per-token arrays directly
  *  - No heap allocation; all state on stack or in statically sized arrays
+ *  - C ABI exports are emitted only where PATHFINDER_IMPL is defined
+ *    (pathfinder.cpp), so sibling kernels can include this header freely
  *
  * Compile with -std=c++20.
  */
@@ -27,10 +30,14 @@
 // ─── Constants ────────────────────────────────────────────────────────────────
 
 static constexpr uint32_t PF_MAX_POOLS  = 256;
-static constexpr uint32_t PF_MAX_TOKENS = 64;
+static constexpr uint32_t PF_MAX_TOKENS = 2 * PF_MAX_POOLS;  ///< Two new tokens per pool at most
+static constexpr uint32_t PF_TOKEN_BUCKETS = 2 * PF_MAX_TOKENS; ///< Intern hash slots (load ≤ 0.5)
 static constexpr uint32_t PF_MAX_HOPS   = 4;
 static constexpr uint32_t PF_INF        = 0xFFFFFFFF;
 
+static constexpr uint32_t PF_JOURNAL_CAP   = 2048;  ///< Undo entries kept (ring)
+static constexpr uint64_t PF_JOURNAL_DEPTH = 64;    ///< Blocks of history kept for reorgs
+
 // ─── C-compatible structs ────────────────────────────────────────────────────
 
 /// Per-hop pool info embedded in a found path
@@ -59,20 +66,87 @@ struct Path {
 struct PathfinderResult {
     Path     best_path;
     uint64_t optimal_amount;   ///< Input amount that maximises gross_profit
-    int64_t  gross_profit;     ///< Expected profit at optimal_amount
+    int64_t  gross_profit;     ///< Expected profit at optimal_amount, in token_in units
+    int64_t  profit_base;      ///< gross_profit in base-token units (price_table_normalize)
     uint8_t  valid;            ///< 1 if a profitable path was found
-    uint8_t  _pad[7];
+    uint8_t  normalized;       ///< 1 if profit_base is set
+    uint8_t  _pad[6];
 };
 #pragma pack(pop)
 
 // ─── Pool graph (struct-of-arrays) ───────────────────────────────────────────
 
+/// One undo record: the slot's state *before* a change made in `block`.
+/// prev_version == 0 marks an append, undone by dropping the slot.
+struct PoolUndo {
+    uint64_t block;
+    uint64_t prev_reserve0;
+    uint64_t prev_reserve1;
+    uint64_t prev_block_updated;
+    uint32_t slot;
+    uint32_t prev_version;
+    int32_t  prev_tick;
+    uint32_t _pad;
+};
+
+/// Token intern table: 20-byte address → dense id in [0, n_tokens).
+/// Open addressing on an address hash; every probe hit is confirmed against
+/// the stored address, so two tokens can never share an id.
+struct TokenTable {
+    uint8_t  addr  [PF_MAX_TOKENS][20];
+    uint16_t bucket[PF_TOKEN_BUCKETS];  ///< id + 1, 0 = empty
+    uint32_t n_tokens;
+
+    static_assert((PF_TOKEN_BUCKETS & (PF_TOKEN_BUCKETS - 1)) == 0, "bucket count must be a power of two");
+    static_assert(PF_MAX_TOKENS < 0xFFFF, "ids must fit the uint16_t buckets");
+
+    void clear() noexcept {
+        memset(bucket, 0, sizeof(bucket));
+        n_tokens = 0;
+    }
+
+    /// Word-wise mix of the address; only used to pick the first bucket.
+    [[nodiscard]] static uint32_t hash(const uint8_t* a) noexcept {
+        uint64_t w0, w1;
+        uint32_t w2;
+        memcpy(&w0, a, 8);
+        memcpy(&w1, a + 8, 8);
+        memcpy(&w2, a + 16, 4);
+        uint64_t h = (w0 ^ (w1 * 0x9E3779B97F4A7C15ULL) ^ (static_cast<uint64_t>(w2) << 29))
+                   * 0xBF58476D1CE4E5B9ULL;
+        return static_cast<uint32_t>(h >> 32);
+    }
+
+    /// Id of `a`, or PF_INF if it was never interned.
+    [[nodiscard]] uint32_t find(const uint8_t* a) const noexcept {
+        for (uint32_t b = hash(a) & (PF_TOKEN_BUCKETS - 1);; b = (b + 1) & (PF_TOKEN_BUCKETS - 1)) {
+            const uint32_t e = bucket[b];
+            if (e == 0) return PF_INF;
+            if (memcmp(addr[e - 1], a, 20) == 0) return e - 1;
+        }
+    }
+
+    /// Id of `a`, assigning the next one on first sight; PF_INF when full.
+    uint32_t intern(const uint8_t* a) noexcept {
+        uint32_t b = hash(a) & (PF_TOKEN_BUCKETS - 1);
+        for (;; b = (b + 1) & (PF_TOKEN_BUCKETS - 1)) {
+            const uint32_t e = bucket[b];
+            if (e == 0) break;
+            if (memcmp(addr[e - 1], a, 20) == 0) return e - 1;
+        }
+        if (n_tokens >= PF_MAX_TOKENS) return PF_INF;
+        memcpy(addr[n_tokens], a, 20);
+        bucket[b] = static_cast<uint16_t>(n_tokens + 1);
+        return n_tokens++;
+    }
+};
+
 /// Pool graph stored in SoA layout for cache-efficient token-pair scanning.
 /// Thread-safety note: not thread-safe; callers must serialize mutations.
 struct PoolGraph {
     // SoA arrays — one element per pool slot
-    uint64_t token0_fp[PF_MAX_POOLS];   ///< FNV1a fingerprint of token0 address
-    uint64_t token1_fp[PF_MAX_POOLS];   ///< FNV1a fingerprint of token1 address
+    uint32_t token0_id[PF_MAX_POOLS];   ///< Interned id of token0 (tokens.addr[id])
+    uint32_t token1_id[PF_MAX_POOLS];   ///< Interned id of token1
     uint64_t reserve0 [PF_MAX_POOLS];
     uint64_t reserve1 [PF_MAX_POOLS];
     uint32_t fee_bps  [PF_MAX_POOLS];
@@ -80,47 +154,148 @@ struct PoolGraph {
     uint8_t  pool_addr[PF_MAX_POOLS][20];
     uint8_t  tok0_addr[PF_MAX_POOLS][20];
     uint8_t  tok1_addr[PF_MAX_POOLS][20];
+    uint32_t version  [PF_MAX_POOLS];   ///< Stamp of the last mutation (from version_clock)
+    uint64_t block_updated[PF_MAX_POOLS]; ///< Block of the last applied state
+    uint64_t pool_fp  [PF_MAX_POOLS];   ///< FNV1a fingerprint of pool_addr (slot lookup)
+    int32_t  tick     [PF_MAX_POOLS];   ///< V3 current tick (AMMPool.extra), 0 for V2
     uint32_t n_pools;
+    uint32_t version_clock;             ///< Graph-wide mutation counter, never reset
+    uint32_t generation;                ///< Bumped by clear() / rollback(): versions may have gone back
+
+    // Token ids are graph-local: tokens stay interned after their pools are
+    // rolled back and are only released by clear()
+    TokenTable tokens;
+
+    // Reorg undo journal — ring of the last PF_JOURNAL_DEPTH blocks of changes
+    PoolUndo journal[PF_JOURNAL_CAP];
+    uint32_t journal_tail;              ///< Oldest live entry (monotonic, index & (CAP-1))
+    uint32_t journal_head;              ///< Next entry to write (monotonic)
+    uint64_t journal_floor;             ///< Oldest block the graph can roll back to
+
+    static_assert((PF_JOURNAL_CAP & (PF_JOURNAL_CAP - 1)) == 0, "journal ring must be a power of two");
 
     void clear() noexcept {
         n_pools = 0;
-        memset(token0_fp, 0, sizeof(token0_fp));
-        memset(token1_fp, 0, sizeof(token1_fp));
+        memset(token0_id, 0, sizeof(token0_id));
+        memset(token1_id, 0, sizeof(token1_id));
+        memset(pool_fp,   0, sizeof(pool_fp));
+        tokens.clear();
+        journal_tail = journal_head = 0;
+        journal_floor = 0;
+        ++generation;
+    }
+
+    /// Record the current state of `slot` before a change made in `block`.
+    /// Blocks are clamped to be non-decreasing so the ring stays LIFO-ordered
+    /// even when a late update for an older block arrives.
+    void journal_push(uint32_t slot, uint64_t block, bool appended) noexcept {
+        if (journal_head != journal_tail) {
+            const uint64_t newest = journal[(journal_head - 1) & (PF_JOURNAL_CAP - 1)].block;
+            block = std::max(block, newest);
+        }
+        // Age out entries older than the reorg window, then make room
+        while (journal_head != journal_tail) {
+            const PoolUndo& old = journal[journal_tail & (PF_JOURNAL_CAP - 1)];
+            const bool stale = old.block + PF_JOURNAL_DEPTH < block;
+            const bool full  = journal_head - journal_tail >= PF_JOURNAL_CAP;
+            if (!stale && !full) break;
+            journal_floor = std::max(journal_floor, old.block);
+            ++journal_tail;
+        }
+        PoolUndo& u = journal[journal_head++ & (PF_JOURNAL_CAP - 1)];
+        u.block              = block;
+        u.slot               = slot;
+        u.prev_version       = appended ? 0u : version[slot];
+        u.prev_reserve0      = appended ? 0u : reserve0[slot];
+        u.prev_reserve1      = appended ? 0u : reserve1[slot];
+        u.prev_block_updated = appended ? 0u : block_updated[slot];
+        u.prev_tick          = appended ? 0  : tick[slot];
+    }
+
+    /// Revert every change made after `to_block`, newest first.
+    /// Returns the number of changes undone, or -1 if the journal no longer
+    /// reaches back to `to_block` (caller must reload those pools).
+    int rollback(uint64_t to_block) noexcept {
+        if (to_block < journal_floor) return -1;
+        int undone = 0;
+        while (journal_head != journal_tail) {
+            const PoolUndo& u = journal[(journal_head - 1) & (PF_JOURNAL_CAP - 1)];
+            if (u.block <= to_block) break;
+            if (u.prev_version == 0) {
+                // Appends are journaled in slot order, so the undo pops the last slot
+                n_pools = u.slot;
+                token0_id[u.slot] = token1_id[u.slot] = 0;
+                pool_fp[u.slot] = 0;
+            } else {
+                reserve0     [u.slot] = u.prev_reserve0;
+                reserve1     [u.slot] = u.prev_reserve1;
+                block_updated[u.slot] = u.prev_block_updated;
+                tick         [u.slot] = u.prev_tick;
+                version      [u.slot] = u.prev_version;
+            }
+            --journal_head;
+            ++undone;
+        }
+        if (undone) ++generation;
+        return undone;
+    }
+
+    /// Slot holding `addr`, or PF_INF.  The fingerprint narrows the scan; the
+    /// full address is compared so a fingerprint collision cannot alias pools.
+    [[nodiscard]] uint32_t find_slot(const uint8_t* addr) const noexcept {
+        const uint64_t fpa = pf_fnv1a(addr, 20);
+        for (uint32_t i = 0; i < n_pools; ++i)
+            if (pool_fp[i] == fpa && memcmp(pool_addr[i], addr, 20) == 0) return i;
+        return PF_INF;
+    }
+
+    /// Set the mutable state of an existing slot as of `block` (journaled).
+    /// Only the first change to a slot within a block is journaled: undoing
+    /// that entry already restores the pre-block state.
+    void apply_state(uint32_t slot, uint64_t r0, uint64_t r1, int32_t t, uint64_t block) noexcept {
+        if (block == 0 || block_updated[slot] != block) journal_push(slot, block, false);
+        reserve0     [slot] = r0;
+        reserve1     [slot] = r1;
+        tick         [slot] = t;
+        block_updated[slot] = block;
+        version      [slot] = ++version_clock;
     }
 
     /// Upsert a pool — updates reserves if pool_addr already exists, appends otherwise
     bool upsert(const AMMPool& p) noexcept {
-        // Compute fingerprints
-        uint64_t fp0 = pf_fnv1a(p.token0, 20);
-        uint64_t fp1 = pf_fnv1a(p.token1, 20);
-        uint64_t fpa = pf_fnv1a(p.pool_addr, 20);
-
-        // Search for existing entry
-        for (uint32_t i = 0; i < n_pools; ++i) {
-            if (pf_fnv1a(pool_addr[i], 20) == fpa) {
-                // Update reserves only
-                reserve0[i] = p.reserve0;
-                reserve1[i] = p.reserve1;
-                return true;
-            }
+        const int32_t t = p.is_v3 ? static_cast<int32_t>(static_cast<uint32_t>(p.extra)) : 0;
+
+        uint32_t i = find_slot(p.pool_addr);
+        if (i != PF_INF) {
+            // Update reserves only
+            apply_state(i, p.reserve0, p.reserve1, t, p.block_updated);
+            return true;
         }
 
         if (n_pools >= PF_MAX_POOLS) return false;  // graph full
+        const uint32_t t0 = tokens.intern(p.token0);
+        const uint32_t t1 = tokens.intern(p.token1);
+        if (t0 == PF_INF || t1 == PF_INF) return false;  // token table full
 
         uint32_t idx       = n_pools++;
-        token0_fp[idx]     = fp0;
-        token1_fp[idx]     = fp1;
+        journal_push(idx, p.block_updated, true);
+        token0_id[idx]     = t0;
+        token1_id[idx]     = t1;
+        pool_fp  [idx]     = pf_fnv1a(p.pool_addr, 20);
         reserve0 [idx]     = p.reserve0;
         reserve1 [idx]     = p.reserve1;
         fee_bps  [idx]     = p.fee_bps;
         is_v3    [idx]     = p.is_v3;
+        tick     [idx]     = t;
+        version  [idx]     = ++version_clock;
+        block_updated[idx] = p.block_updated;
         memcpy(pool_addr[idx], p.pool_addr, 20);
         memcpy(tok0_addr[idx], p.token0,    20);
         memcpy(tok1_addr[idx], p.token1,    20);
         return true;
     }
 
-    /// FNV-1a 64-bit hash of a byte array — used for address fingerprinting
+    /// FNV-1a 64-bit hash of a byte array — used for pool address fingerprinting
     static uint64_t pf_fnv1a(const uint8_t* data, size_t len) noexcept {
         uint64_t h = 14695981039346656037ULL;
         for (size_t i = 0; i < len; ++i) {
@@ -139,10 +314,10 @@ namespace pathfinder_internal {
 [[nodiscard]] static inline uint64_t hop_amount_out(
     const PoolGraph& g,
     uint32_t         idx,
-    uint64_t         token_in_fp,
+    uint32_t         token_in_id,
     uint64_t         amount_in
 ) noexcept {
-    bool z1 = (g.token0_fp[idx] == token_in_fp);
+    bool z1 = (g.token0_id[idx] == token_in_id);
     uint64_t r0 = g.reserve0[idx];
     uint64_t r1 = g.reserve1[idx];
 
@@ -162,13 +337,13 @@ namespace pathfinder_internal {
 [[nodiscard]] static inline uint64_t eval_path(
     const PoolGraph& g,
     const uint32_t*  pool_indices,
-    const uint64_t*  token_fps,   ///< token fingerprint at each step (n_hops+1 entries)
+    const uint32_t*  token_ids,   ///< token id at each step (n_hops+1 entries)
     uint32_t         n_hops,
     uint64_t         amount_in
 ) noexcept {
     uint64_t amount = amount_in;
     for (uint32_t h = 0; h < n_hops; ++h) {
-        amount = hop_amount_out(g, pool_indices[h], token_fps[h], amount);
+        amount = hop_amount_out(g, pool_indices[h], token_ids[h], amount);
         if (amount == 0) return 0;
     }
     return amount;
@@ -180,7 +355,7 @@ namespace pathfinder_internal {
 static inline void ternary_search_amount(
     const PoolGraph& g,
     const uint32_t*  pool_indices,
-    const uint64_t*  token_fps,
+    const uint32_t*  token_ids,
     uint32_t         n_hops,
     uint64_t         max_amount,
     uint64_t&        out_optimal,
@@ -195,8 +370,8 @@ static inline void ternary_search_amount(
         uint64_t m1 = lo + range / 3u;
         uint64_t m2 = hi - range / 3u;
 
-        uint64_t o1 = eval_path(g, pool_indices, token_fps, n_hops, m1);
-        uint64_t o2 = eval_path(g, pool_indices, token_fps, n_hops, m2);
+        uint64_t o1 = eval_path(g, pool_indices, token_ids, n_hops, m1);
+        uint64_t o2 = eval_path(g, pool_indices, token_ids, n_hops, m2);
 
         int64_t p1 = o1 > m1 ? static_cast<int64_t>(o1 - m1) : -static_cast<int64_t>(m1 - o1);
         int64_t p2 = o2 > m2 ? static_cast<int64_t>(o2 - m2) : -static_cast<int64_t>(m2 - o2);
@@ -205,7 +380,7 @@ static inline void ternary_search_amount(
     }
 
     uint64_t opt = (lo + hi) / 2u;
-    uint64_t out = eval_path(g, pool_indices, token_fps, n_hops, opt);
+    uint64_t out = eval_path(g, pool_indices, token_ids, n_hops, opt);
 
     out_optimal = opt;
     out_profit  = out > opt
@@ -217,11 +392,11 @@ static inline void ternary_search_amount(
 static inline HopPool make_hop(
     const PoolGraph& g,
     uint32_t         idx,
-    uint64_t         token_in_fp
+    uint32_t         token_in_id
 ) noexcept {
     HopPool h{};
     memcpy(h.pool_addr, g.pool_addr[idx], 20);
-    bool z1 = (g.token0_fp[idx] == token_in_fp);
+    bool z1 = (g.token0_id[idx] == token_in_id);
     memcpy(h.token_in,  z1 ? g.tok0_addr[idx] : g.tok1_addr[idx], 20);
     memcpy(h.token_out, z1 ? g.tok1_addr[idx] : g.tok0_addr[idx], 20);
     h.fee_bps = g.fee_bps[idx];
@@ -233,13 +408,13 @@ static inline HopPool make_hop(
 
 // ─── Main pathfinder function ─────────────────────────────────────────────────
 
-/// Find the best 1-hop or 2-hop path from token_in_fp to token_out_fp.
+/// Find the best 1-hop or 2-hop path from token_in_id to token_out_id.
 /// Evaluates all candidate paths (≤n²) and picks the one with maximum profit
 /// at its ternary-search optimal amount, bounded by amount_hint * 2.
 [[nodiscard]] static inline PathfinderResult find_best_path(
     const PoolGraph& g,
-    uint64_t         token_in_fp,
-    uint64_t         token_out_fp,
+    uint32_t         token_in_id,
+    uint32_t         token_out_id,
     uint64_t         amount_hint     ///< Starting search bound for ternary search
 ) noexcept {
     PathfinderResult best{};
@@ -249,57 +424,57 @@ static inline HopPool make_hop(
 
     // ── 1-hop paths ───────────────────────────────────────────────────────
     for (uint32_t i = 0; i < g.n_pools; ++i) {
-        bool connects = (g.token0_fp[i] == token_in_fp && g.token1_fp[i] == token_out_fp)
-                     || (g.token1_fp[i] == token_in_fp && g.token0_fp[i] == token_out_fp);
+        bool connects = (g.token0_id[i] == token_in_id && g.token1_id[i] == token_out_id)
+                     || (g.token1_id[i] == token_in_id && g.token0_id[i] == token_out_id);
         if (!connects) continue;
 
         uint32_t pidx[1] = { i };
-        uint64_t tfps[2] = { token_in_fp, token_out_fp };
+        uint32_t tids[2] = { token_in_id, token_out_id };
 
         uint64_t opt; int64_t profit;
         pathfinder_internal::ternary_search_amount(
-            g, pidx, tfps, 1, max_amount, opt, profit);
+            g, pidx, tids, 1, max_amount, opt, profit);
 
         if (profit > best.gross_profit) {
             best.gross_profit    = profit;
             best.optimal_amount  = opt;
             best.valid           = (profit > 0) ? 1u : 0u;
             best.best_path.n_hops = 1;
-            best.best_path.hops[0] = pathfinder_internal::make_hop(g, i, token_in_fp);
+            best.best_path.hops[0] = pathfinder_internal::make_hop(g, i, token_in_id);
         }
     }
 
     // ── 2-hop paths (A→X→B) ──────────────────────────────────────────────
     for (uint32_t i = 0; i < g.n_pools; ++i) {
         // First hop must start from token_in
-        bool i_fwd = (g.token0_fp[i] == token_in_fp);
-        bool i_rev = (g.token1_fp[i] == token_in_fp);
+        bool i_fwd = (g.token0_id[i] == token_in_id);
+        bool i_rev = (g.token1_id[i] == token_in_id);
         if (!i_fwd && !i_rev) continue;
 
-        uint64_t mid_fp = i_fwd ? g.token1_fp[i] : g.token0_fp[i];
-        if (mid_fp == token_out_fp) continue;  // already a 1-hop
+        uint32_t mid_id = i_fwd ? g.token1_id[i] : g.token0_id[i];
+        if (mid_id == token_out_id) continue;  // already a 1-hop
 
         for (uint32_t j = 0; j < g.n_pools; ++j) {
             if (j == i) continue;
             bool j_connects =
-                (g.token0_fp[j] == mid_fp && g.token1_fp[j] == token_out_fp) ||
-                (g.token1_fp[j] == mid_fp && g.token0_fp[j] == token_out_fp);
+                (g.token0_id[j] == mid_id && g.token1_id[j] == token_out_id) ||
+                (g.token1_id[j] == mid_id && g.token0_id[j] == token_out_id);
             if (!j_connects) continue;
 
             uint32_t pidx[2] = { i, j };
-            uint64_t tfps[3] = { token_in_fp, mid_fp, token_out_fp };
+            uint32_t tids[3] = { token_in_id, mid_id, token_out_id };
 
             uint64_t opt; int64_t profit;
             pathfinder_internal::ternary_search_amount(
-                g, pidx, tfps, 2, max_amount, opt, profit);
+                g, pidx, tids, 2, max_amount, opt, profit);
 
             if (profit > best.gross_profit) {
                 best.gross_profit    = profit;
                 best.optimal_amount  = opt;
                 best.valid           = (profit > 0) ? 1u : 0u;
                 best.best_path.n_hops = 2;
-                best.best_path.hops[0] = pathfinder_internal::make_hop(g, i, token_in_fp);
-                best.best_path.hops[1] = pathfinder_internal::make_hop(g, j, mid_fp);
+                best.best_path.hops[0] = pathfinder_internal::make_hop(g, i, token_in_id);
+                best.best_path.hops[1] = pathfinder_internal::make_hop(g, j, mid_id);
             }
         }
     }
@@ -314,24 +489,31 @@ static inline HopPool make_hop(
 
 // ─── C ABI exports ────────────────────────────────────────────────────────────
 
+#ifdef PATHFINDER_IMPL
 extern "C" {
 
 /// Compute 64-bit FNV1a fingerprint of a 20-byte EVM address.
-/// Use this from Rust to convert Address → u64 before calling pathfinder_find_best.
 uint64_t pathfinder_token_fp(const uint8_t* addr20) {
     return PoolGraph::pf_fnv1a(addr20, 20);
 }
 
+/// Interned id of a 20-byte token address in `graph`, or 0xFFFFFFFF if no
+/// pool in the graph references it.  Ids are stable until the graph is cleared.
+uint32_t pathfinder_token_id(const PoolGraph* graph, const uint8_t* addr20) {
+    if (!graph || !addr20) return PF_INF;
+    return graph->tokens.find(addr20);
+}
+
 /// Find best path in a pool graph. Returns 1 if a profitable path was found.
 int pathfinder_find_best(
     const PoolGraph*   graph,
-    uint64_t           token_in_fp,
-    uint64_t           token_out_fp,
+    uint32_t           token_in_id,
+    uint32_t           token_out_id,
     uint64_t           amount_hint,
     PathfinderResult*  out
 ) {
     if (!graph || !out) return 0;
-    *out = find_best_path(*graph, token_in_fp, token_out_fp, amount_hint);
+    *out = find_best_path(*graph, token_in_id, token_out_id, amount_hint);
     return out->valid ? 1 : 0;
 }
 
@@ -346,9 +528,18 @@ void pathfinder_graph_clear(PoolGraph* graph) {
     if (graph) graph->clear();
 }
 
+/// Revert all pool changes made after `to_block` (chain reorg).
+/// Returns the number of changes undone, or -1 if `to_block` predates the
+/// journal window — the affected pools must then be reloaded.
+int pathfinder_graph_rollback(PoolGraph* graph, uint64_t to_block) {
+    if (!graph) return -1;
+    return graph->rollback(to_block);
+}
+
 /// Return current number of pools in the graph.
 uint32_t pathfinder_graph_size(const PoolGraph* graph) {
     return graph ? graph->n_pools : 0u;
 }
 
 } // extern "C"
+#endif // PATHFINDER_IMPL
@@ -0,0 +1,248 @@
+#pragma once
+/**
+ * price_table.h — per-token → base-token (WETH) conversion rates from PoolGraph
+ *
+ * gross_profit is denominated in the path's input token, so opportunities
+ * starting from different tokens cannot be ranked against each other.  The
+ * PriceTable keeps, for every interned token, the mid-price in base-token
+ * units quoted by its deepest pool, and converts amounts in batch.
+ *
+ * Quote selection (depth measured in base-token units):
+ *  - level 0: the base token itself, rate 1
+ *  - level 1: deepest pool pairing the token directly with the base token
+ *  - level 2: otherwise, deepest pool pairing it with a level-1 token
+ *  - tokens further out stay unpriced (rate 0)
+ *
+ * Incremental refresh: a slot is dirty when PoolGraph::version moved since
+ * the last refresh.  Only the endpoints of dirty slots are re-quoted, plus
+ * level-2 candidates next to a level-1 token whose rate changed — every
+ * re-quote rescans that token's pools, so the choice stays the deepest.
+ * A PoolGraph::generation bump (clear / rollback) or a new base token id
+ * starts the table over.
+ *
+ * V3 pools use amm_simulator's encoding (reserve0 = L, reserve1 =
+ * sqrtPriceX64), scaled as in cycle_screen's spot_rate; depth uses the
+ * virtual reserves L/√P and L·√P.
+ *
+ * Compile with -std=c++20.
+ */
+
+#include "pathfinder.h"
+
+#include <cmath>
+
+// ─── Constants ────────────────────────────────────────────────────────────────
+
+static constexpr uint8_t PT_UNPRICED = 0xFF;
+
+// ─── Price table ─────────────────────────────────────────────────────────────
+
+/// Thread-safety note: refresh mutates; conversion is read-only.
+struct PriceTable {
+    double   to_base [PF_MAX_TOKENS];       ///< Base units per token unit, 0 = unpriced
+    double   depth   [PF_MAX_TOKENS];       ///< Base-denominated depth of the quoting pool
+    uint32_t via_pool[PF_MAX_TOKENS];       ///< Slot quoting the token, PF_INF for none / base
+    uint8_t  level   [PF_MAX_TOKENS];       ///< 0 base, 1 direct, 2 via a level-1 token, PT_UNPRICED
+    uint32_t seen_version[PF_MAX_POOLS];    ///< PoolGraph::version at last refresh
+    uint8_t  base_addr[20];
+    uint32_t base_id;                       ///< PF_INF until the base token is interned
+    uint32_t n_seen;                        ///< Slots covered by the last refresh
+    uint32_t seen_generation;               ///< PoolGraph::generation at last refresh
+    uint32_t n_priced;
+
+    /// Reset and set the base token (e.g. WETH) by address.
+    void init(const uint8_t* base) noexcept {
+        memset(this, 0, sizeof(*this));
+        memcpy(base_addr, base, 20);
+        memset(level, PT_UNPRICED, sizeof(level));
+        memset(via_pool, 0xFF, sizeof(via_pool));
+        base_id = PF_INF;
+    }
+
+    /// Bring the table up to date with `g`.  Returns the number of dirty slots.
+    uint32_t refresh(const PoolGraph& g) noexcept;
+
+    /// `amount` of token `id` in base-token units; false if unpriced.
+    [[nodiscard]] bool convert(uint32_t id, int64_t amount, int64_t& out) const noexcept {
+        if (id >= PF_MAX_TOKENS || level[id] == PT_UNPRICED) { out = 0; return false; }
+        const double v = static_cast<double>(amount) * to_base[id];
+        out = v >= 9.2e18 ? INT64_MAX : v <= -9.2e18 ? INT64_MIN : static_cast<int64_t>(std::llround(v));
+        return true;
+    }
+};
+
+// ─── Internal quoting logic ──────────────────────────────────────────────────
+
+namespace price_table_internal {
+
+/// Mid-price of slot `idx` (no fee): units of the other token per unit of
+/// token0 when z1, per unit of token1 otherwise.
+[[nodiscard]] static inline double mid_rate(const PoolGraph& g, uint32_t idx, bool z1) noexcept {
+    const double r0 = static_cast<double>(g.reserve0[idx]);
+    const double r1 = static_cast<double>(g.reserve1[idx]);
+    if (r0 <= 0.0 || r1 <= 0.0) return 0.0;
+    if (g.is_v3[idx]) {
+        const double sp = r1 / static_cast<double>(1ULL << 32);
+        const double p  = sp * sp;
+        return z1 ? p : 1.0 / p;
+    }
+    return z1 ? r1 / r0 : r0 / r1;
+}
+
+/// Reserve of token1 (z1) or token0 held by slot `idx`; virtual for V3.
+[[nodiscard]] static inline double side_reserve(const PoolGraph& g, uint32_t idx, bool token1) noexcept {
+    if (g.is_v3[idx]) {
+        const double L  = static_cast<double>(g.reserve0[idx]);
+        const double sp = static_cast<double>(g.reserve1[idx]) / static_cast<double>(1ULL << 32);
+        if (sp <= 0.0) return 0.0;
+        return token1 ? L * sp : L / sp;
+    }
+    return static_cast<double>(token1 ? g.reserve1[idx] : g.reserve0[idx]);
+}
+
+/// Re-quote token `t` from scratch.  Returns true if its rate changed.
+static inline bool requote(PriceTable& pt, const PoolGraph& g, uint32_t t) noexcept {
+    const double  old_rate  = pt.to_base[t];
+    const uint8_t old_level = pt.level[t];
+
+    double   rate = 0.0, best = 0.0;
+    uint32_t pool = PF_INF;
+    uint8_t  lvl  = PT_UNPRICED;
+
+    if (t == pt.base_id) {
+        rate = 1.0; lvl = 0;
+    } else {
+        // Level 1 beats level 2 regardless of depth: one quote hop, no compounding
+        for (int pass = 1; pass <= 2 && lvl == PT_UNPRICED; ++pass) {
+            for (uint32_t i = 0; i < g.n_pools; ++i) {
+                const bool z1 = g.token0_id[i] == t;
+                if (!z1 && g.token1_id[i] != t) continue;
+                const uint32_t u = z1 ? g.token1_id[i] : g.token0_id[i];
+                if (pass == 1 ? u != pt.base_id : pt.level[u] != 1) continue;
+
+                const double d = side_reserve(g, i, z1) * pt.to_base[u];
+                const double r = mid_rate(g, i, z1) * pt.to_base[u];
+                if (r > 0.0 && d > best) { best = d; rate = r; pool = i; }
+            }
+            if (pool != PF_INF) lvl = static_cast<uint8_t>(pass);
+        }
+    }
+
+    if (old_level == PT_UNPRICED && lvl != PT_UNPRICED) ++pt.n_priced;
+    if (old_level != PT_UNPRICED && lvl == PT_UNPRICED) --pt.n_priced;
+    pt.to_base[t]  = rate;
+    pt.depth[t]    = best;
+    pt.via_pool[t] = pool;
+    pt.level[t]    = lvl;
+    return rate != old_rate || lvl != old_level;
+}
+
+} // namespace price_table_internal
+
+inline uint32_t PriceTable::refresh(const PoolGraph& g) noexcept {
+    using namespace price_table_internal;
+
+    // Graph cleared or rolled back underneath us, base token not seen yet,
+    // or re-interned under another id: start over
+    const uint32_t id = g.tokens.find(base_addr);
+    if (g.generation != seen_generation || id != base_id || base_id == PF_INF) {
+        uint8_t base[20];
+        memcpy(base, base_addr, 20);
+        init(base);
+        seen_generation = g.generation;
+        base_id = id;
+        if (base_id == PF_INF) return 0;
+        // Seed the base so level-1 quotes resolve regardless of id order
+        to_base[base_id] = 1.0;
+        level[base_id]   = 0;
+        n_priced         = 1;
+    }
+
+    uint64_t dirty_tok[PF_MAX_TOKENS / 64] = {};
+    uint32_t dirty = 0;
+    for (uint32_t i = 0; i < g.n_pools; ++i) {
+        if (i < n_seen && seen_version[i] == g.version[i]) continue;
+        seen_version[i] = g.version[i];
+        ++dirty;
+        dirty_tok[g.token0_id[i] >> 6] |= 1ULL << (g.token0_id[i] & 63);
+        dirty_tok[g.token1_id[i] >> 6] |= 1ULL << (g.token1_id[i] & 63);
+    }
+    n_seen = g.n_pools;
+    if (!dirty) return 0;
+
+    auto is_set = [](const uint64_t* bits, uint32_t t) { return (bits[t >> 6] >> (t & 63)) & 1; };
+
+    // ── Base and level-1 candidates: endpoints of dirty pools ────────────
+    uint64_t changed[PF_MAX_TOKENS / 64] = {};
+    for (uint32_t t = 0; t < g.tokens.n_tokens; ++t) {
+        if (!is_set(dirty_tok, t)) continue;
+        if (requote(*this, g, t)) changed[t >> 6] |= 1ULL << (t & 63);
+    }
+
+    // ── Level-2 candidates next to a token whose quote moved ─────────────
+    for (uint32_t i = 0; i < g.n_pools; ++i) {
+        const uint32_t a = g.token0_id[i], b = g.token1_id[i];
+        if (is_set(changed, a) && level[b] > 1 && b != base_id) requote(*this, g, b);
+        if (is_set(changed, b) && level[a] > 1 && a != base_id) requote(*this, g, a);
+    }
+    return dirty;
+}
+
+// ─── C ABI exports ────────────────────────────────────────────────────────────
+
+#ifdef PRICE_TABLE_IMPL
+extern "C" {
+
+/// Size in bytes of PriceTable, for callers that allocate it opaquely.
+size_t price_table_size(void) {
+    return sizeof(PriceTable);
+}
+
+/// Reset the table and set the base token (20-byte address, e.g. WETH).
+void price_table_init(PriceTable* pt, const uint8_t* base_addr20) {
+    if (pt && base_addr20) pt->init(base_addr20);
+}
+
+/// Re-quote tokens touched by pools whose version changed. Returns dirty slots.
+uint32_t price_table_refresh(PriceTable* pt, const PoolGraph* graph) {
+    if (!pt || !graph) return 0;
+    return pt->refresh(*graph);
+}
+
+/// Convert `n` amounts of tokens `ids` into base-token units.  Unpriced
+/// tokens yield 0.  Returns the number of amounts that were priced.
+uint32_t price_table_convert(
+    const PriceTable* pt,
+    const uint32_t*   ids,
+    const int64_t*    amounts,
+    int64_t*          out,
+    uint32_t          n
+) {
+    if (!pt || !ids || !amounts || !out) return 0;
+    uint32_t priced = 0;
+    for (uint32_t k = 0; k < n; ++k) priced += pt->convert(ids[k], amounts[k], out[k]) ? 1u : 0u;
+    return priced;
+}
+
+/// Fill profit_base / normalized of `n` results whose input tokens are
+/// `token_in_ids`.  Returns the number normalized.
+uint32_t price_table_normalize(
+    const PriceTable* pt,
+    const uint32_t*   token_in_ids,
+    PathfinderResult* results,
+    uint32_t          n
+) {
+    if (!pt || !token_in_ids || !results) return 0;
+    uint32_t priced = 0;
+    for (uint32_t k = 0; k < n; ++k) {
+        PathfinderResult& r = results[k];
+        int64_t v;
+        r.normalized  = pt->convert(token_in_ids[k], r.gross_profit, v) ? 1u : 0u;
+        r.profit_base = v;
+        priced += r.normalized;
+    }
+    return priced;
+}
+
+} // extern "C"
+#endif // PRICE_TABLE_IMPL
@@ -0,0 +1,41 @@
+#ifndef MEV_PRIORITY_QUEUE_H
+#define MEV_PRIORITY_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bounded concurrent priority queue for opportunities, ordered by
+// (profit descending, deadline block ascending).  A multi-queue: items live
+// in per-shard sorted arrays; pop takes the better top of two random shards,
+// so order is approximate across shards and exact within one.
+typedef struct mev_pq_t mev_pq_t;
+
+// Create/destroy — capacity bounds the whole queue; each of n_shards
+// (0 = default 8) holds up to capacity / n_shards, rounded up
+mev_pq_t* mev_pq_create(size_t capacity, size_t n_shards);
+void mev_pq_destroy(mev_pq_t* q);
+
+// Push (multi-producer safe).  Returns 0 if stored, 1 if the queue held
+// `capacity` entries and the lowest entry of the lower of two sampled
+// shards — possibly `item` itself — was shed; the shed item is written to *evicted (may be NULL)
+// so the caller can free it.
+int mev_pq_push(mev_pq_t* q, int64_t profit, uint64_t deadline_block,
+                void* item, void** evicted);
+
+// Pop the (approximately) best item (multi-consumer safe).  NULL if empty.
+// profit / deadline_block may be NULL.
+void* mev_pq_pop(mev_pq_t* q, int64_t* profit, uint64_t* deadline_block);
+
+// Status
+size_t mev_pq_size(mev_pq_t* q);
+uint64_t mev_pq_dropped(mev_pq_t* q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEV_PRIORITY_QUEUE_H
@@ -0,0 +1,38 @@
+#ifndef MEV_QUEUE_WAIT_H
+#define MEV_QUEUE_WAIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lockfree_queue.h"
+#include "spsc_queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Optional blocking layer for mev_queue_t / mev_spsc_t consumers.
+// One mev_wait_t is paired with one queue: producers call mev_wait_notify()
+// after a successful push; consumers call the *_pop_wait() functions, which
+// spin, then yield, then park on a futex until notified or timed out.
+typedef struct mev_wait_t mev_wait_t;
+
+// Create/destroy
+mev_wait_t* mev_wait_create(void);
+void mev_wait_destroy(mev_wait_t* w);
+
+// Producer side — wakes parked consumers; a single load when none is parked
+void mev_wait_notify(mev_wait_t* w);
+
+// Consumer side — timeout_ns < 0 waits forever; returns NULL on timeout
+void* mev_queue_pop_wait(mev_queue_t* q, mev_wait_t* w, int64_t timeout_ns);
+void* mev_spsc_pop_wait(mev_spsc_t* q, mev_wait_t* w, int64_t timeout_ns);
+
+// Stats — futex wakes issued by notify, times a consumer parked
+void mev_wait_stats(mev_wait_t* w, uint64_t* wakes, uint64_t* parks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEV_QUEUE_WAIT_H
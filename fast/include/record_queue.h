@@ -0,0 +1,43 @@
+#ifndef MEV_RECORD_QUEUE_H
+#define MEV_RECORD_QUEUE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bounded MPMC queue whose slots embed a fixed-size record (e.g. a tx or an
+// opportunity) instead of a pointer: no pool allocation, no pointer chase.
+// Records are written / read in place between claim and commit.
+typedef struct mev_recq_t mev_recq_t;
+
+// Create/destroy (capacity rounded up to a power of 2; each record starts on
+// its own 64-byte-aligned cache line).  NULL if the ring size would overflow.
+mev_recq_t* mev_recq_create(size_t capacity, size_t record_size);
+void mev_recq_destroy(mev_recq_t* q);
+
+// Producer: claim a slot, fill the record in place, commit.
+// claim returns NULL if full; *ticket identifies the slot for commit.
+void* mev_recq_claim(mev_recq_t* q, size_t* ticket);
+void mev_recq_commit(mev_recq_t* q, size_t ticket);
+
+// Consumer: acquire the oldest record, read it in place, release the slot.
+// acquire returns NULL if empty.
+const void* mev_recq_acquire(mev_recq_t* q, size_t* ticket);
+void mev_recq_release(mev_recq_t* q, size_t ticket);
+
+// Copying convenience wrappers — 0 on success, -1 if full / empty
+int mev_recq_push(mev_recq_t* q, const void* record);
+int mev_recq_pop(mev_recq_t* q, void* record);
+
+// Status
+size_t mev_recq_record_size(mev_recq_t* q);
+size_t mev_recq_size(mev_recq_t* q);
+int mev_recq_empty(mev_recq_t* q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEV_RECORD_QUEUE_H
@@ -0,0 +1,58 @@
+#ifndef MEV_REGION_H
+#define MEV_REGION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-block region allocator: everything allocated while one block is
+// processed (decoded txs, what-if overlays, candidate paths) is released
+// at once by mev_region_reset at the next block — there is no free.
+//
+// Reset contract: call it at the block boundary once no thread is still
+// allocating from, or reading, the previous block's region memory.
+
+#define MEV_REGION_DEFAULT_BYTES (64u << 20)   // arena size
+#define MEV_REGION_DEFAULT_CHUNK (64u << 10)   // per-thread bump chunk
+
+// Reserve the region arena (0 picks the defaults above; chunk_bytes is
+// rounded up to 4 KB) with MEV_ARENA_* flags.  Call once; later calls are
+// no-ops returning 0.
+int mev_region_init(size_t bytes, size_t chunk_bytes, unsigned arena_flags);
+
+// Bump-allocate from the calling thread's chunk — NULL before init, if
+// malloc fails once the arena is exhausted (overflow chunks), or if align
+// is not a power of 2 no larger than 4096
+void* mev_region_alloc(size_t size);                       // 16-byte aligned
+void* mev_region_alloc_aligned(size_t size, size_t align); // power of 2, <= 4096
+
+// Recycle every chunk and start `epoch` (e.g. the new block number)
+void mev_region_reset(uint64_t epoch);
+uint64_t mev_region_epoch(void);
+
+typedef struct {
+    uint64_t epoch;
+    uint64_t resets;
+    size_t chunk_bytes;
+    size_t chunks;              // in the arena
+    size_t chunks_used;         // claimed this epoch
+    size_t chunks_high_water;   // most claimed in any one epoch
+    size_t overflow_chunks;     // malloc'd this epoch (arena exhausted)
+    size_t overflow_total;
+} mev_region_stats_t;
+
+void mev_region_stats(mev_region_stats_t* out);
+
+// Arena layout / pre-fault report; -1 before init
+int mev_region_arena_info(mev_arena_info_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEV_REGION_H
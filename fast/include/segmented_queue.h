@@ -0,0 +1,36 @@
+#ifndef MEV_SEGMENTED_QUEUE_H
+#define MEV_SEGMENTED_QUEUE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Unbounded multi-producer / single-consumer queue: a chain of fixed ring
+// segments (2 KB calldata-pool buffers) that grows on bursts instead of
+// rejecting pushes, recycles drained segments, and stops at a hard ceiling.
+// Segments are kept until destroy, so memory stays at the high-water mark.
+typedef struct mev_segq_t mev_segq_t;
+
+#define MEV_SEGQ_SEGMENT_SLOTS 240   // items per segment
+
+// Create/destroy.  max_items caps memory (rounded up to whole segments,
+// at least 2); 0 = no ceiling.  Initializes the memory pools if needed.
+mev_segq_t* mev_segq_create(size_t max_items);
+void mev_segq_destroy(mev_segq_t* q);
+
+// Push (any thread): 0, or -1 when the ceiling is reached or item is NULL.
+// Pop (one consumer thread): NULL if empty.
+int mev_segq_push(mev_segq_t* q, void* item);
+void* mev_segq_pop(mev_segq_t* q);
+
+// Stats — segments currently allocated (linked or cached), the most ever
+// allocated at once, and pushes refused at the ceiling
+void mev_segq_stats(mev_segq_t* q, size_t* segments, size_t* high_water, size_t* ceiling_hits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEV_SEGMENTED_QUEUE_H
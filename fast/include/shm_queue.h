@@ -0,0 +1,56 @@
+#ifndef MEV_SHM_QUEUE_H
+#define MEV_SHM_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cross-process queue in a POSIX shared-memory object (/dev/shm/<name>),
+// e.g. pending txs from the Go network layer to the Rust core.  The mapping
+// holds only offsets, so each process maps it wherever it likes; the
+// handle is process-local.
+typedef struct mev_shmq_t mev_shmq_t;
+
+#define MEV_SHMQ_VERSION 1
+
+// Queue kinds
+#define MEV_SHMQ_SPSC 1   // one producer, one consumer, variable-length records
+#define MEV_SHMQ_MPMC 2   // any number of each, records up to slot_size bytes
+
+// Return codes (send / recv)
+#define MEV_SHMQ_FULL     -1
+#define MEV_SHMQ_EMPTY    -1
+#define MEV_SHMQ_TOOBIG   -2   // record larger than mev_shmq_max_record()
+#define MEV_SHMQ_NOSPACE  -2   // receive buffer smaller than the next record
+
+// Create/open/close.  create replaces any object of the same name;
+// `capacity` is ring bytes (SPSC) or slots (MPMC), rounded up to a power of
+// 2; `slot_size` is ignored for SPSC.  open returns NULL unless the object
+// exists, is fully initialized and has a matching version.
+mev_shmq_t* mev_shmq_create(const char* name, int kind, size_t capacity, size_t slot_size);
+mev_shmq_t* mev_shmq_open(const char* name);
+void mev_shmq_close(mev_shmq_t* q);
+int mev_shmq_unlink(const char* name);
+
+// Copying send / receive — 0 / record length on success, codes above otherwise
+int mev_shmq_send(mev_shmq_t* q, const void* data, uint32_t len);
+int mev_shmq_recv(mev_shmq_t* q, void* buf, uint32_t buf_len);
+
+// Zero-copy receive (SPSC only): peek points at the next record in the
+// mapping and returns its length (MEV_SHMQ_EMPTY if none); consume drops it.
+int mev_shmq_peek(mev_shmq_t* q, const void** data);
+void mev_shmq_consume(mev_shmq_t* q);
+
+// Status
+int mev_shmq_kind(mev_shmq_t* q);
+uint32_t mev_shmq_max_record(mev_shmq_t* q);
+int mev_shmq_empty(mev_shmq_t* q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEV_SHM_QUEUE_H
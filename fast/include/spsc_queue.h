@@ -0,0 +1,34 @@
+#ifndef MEV_SPSC_QUEUE_H
+#define MEV_SPSC_QUEUE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Single-producer / single-consumer ring (e.g. feed thread → one detector).
+// Exactly one thread may push and exactly one thread may pop.
+typedef struct mev_spsc_t mev_spsc_t;
+
+// Create/destroy (capacity rounded up to a power of 2)
+mev_spsc_t* mev_spsc_create(size_t capacity);
+void mev_spsc_destroy(mev_spsc_t* q);
+
+// Push/pop — push returns 0 on success, -1 if full; pop returns NULL if empty
+int mev_spsc_push(mev_spsc_t* q, void* item);
+void* mev_spsc_pop(mev_spsc_t* q);
+
+// Batch operations — one index publish per call; return the count moved
+size_t mev_spsc_push_batch(mev_spsc_t* q, void* const* items, size_t n_items);
+size_t mev_spsc_pop_batch(mev_spsc_t* q, void** items, size_t max_items);
+
+// Status
+size_t mev_spsc_size(mev_spsc_t* q);
+int mev_spsc_empty(mev_spsc_t* q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEV_SPSC_QUEUE_H
@@ -7,4 +7,5 @@
 //
 // Compile flag required: -std=c++20 (GCC/Clang) or /std:c++20 (MSVC)
 
+#define AMM_SIMULATOR_IMPL
 #include "amm_simulator.h"
@@ -0,0 +1,369 @@
+/**
+ * Hugepage Arena
+ * One pre-faulted, locked region for every hot-path slab
+ *
+ * Slabs from posix_memalign are scattered over 4K pages: each block costs
+ * a TLB entry of its own and its first touch on the hot path is a page
+ * fault.  The arena reserves a single region up front and the allocators
+ * carve their slabs out of it:
+ *
+ *   1. MAP_HUGETLB (reserved 2 MB pages, /proc/sys/vm/nr_hugepages); if
+ *      none are reserved, an ordinary anonymous mapping aligned to 2 MB
+ *      with madvise(MADV_HUGEPAGE) so THP backs it; without MEV_ARENA_HUGE
+ *      base pages.  Windows (and a failed mmap) falls back to the heap.
+ *   2. Pre-fault: write every base page once, so all faults (counted with
+ *      getrusage) happen here and not on the first allocation.
+ *   3. mlock, best effort: without CAP_IPC_LOCK the RLIMIT_MEMLOCK cap
+ *      applies, and a failure only leaves `locked` at 0.
+ *
+ * Steps 2 and 3 can instead be applied per range with mev_arena_commit, so
+ * a large reservation only makes its initially-used part resident.  On a
+ * NUMA machine a range can be bound to one node (mbind) before it is
+ * committed, so its pages are placed there whichever thread faults them.
+ *
+ * Carving is a lock-free bump of `used`; memory is never returned to the
+ * arena, only with the whole arena.  Labelled carves are kept (up to
+ * MEV_ARENA_MAX_REGIONS) so the layout can be reported.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE   // RUSAGE_THREAD
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "arena.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+#define ARENA_HUGE_PAGE  (2u << 20)
+
+// <numaif.h> values, so the library needs no -lnuma
+#define ARENA_MPOL_BIND             2
+#define ARENA_MPOL_F_MEMS_ALLOWED   4
+#define ARENA_MAX_NODES             64
+
+struct mev_arena_t {
+    uint8_t* base;
+    size_t size;
+    size_t page_size;
+    void* map;                 // what to munmap / free
+    size_t map_size;
+    int backing;
+    int lock_failed;           // some mlock was refused
+    size_t locked_bytes;
+    long minor_faults;
+    long major_faults;
+    uint64_t prefault_ns;
+
+    atomic_size_t used;
+    atomic_uint bind_failures;
+    atomic_uint n_regions;
+    mev_arena_region_t regions[MEV_ARENA_MAX_REGIONS];
+};
+
+static size_t round_up(size_t n, size_t align) {
+    return (n + align - 1) & ~(align - 1);
+}
+
+static uint64_t arena_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#ifndef _WIN32
+static void arena_faults(long* minflt, long* majflt) {
+    struct rusage ru;
+#ifdef RUSAGE_THREAD
+    getrusage(RUSAGE_THREAD, &ru);
+#else
+    getrusage(RUSAGE_SELF, &ru);
+#endif
+    *minflt = ru.ru_minflt;
+    *majflt = ru.ru_majflt;
+}
+
+/**
+ * Map the region: hugetlb, then THP-advised 2 MB-aligned, then base pages
+ */
+static int arena_map(mev_arena_t* a, size_t size, unsigned flags) {
+    const size_t base_page = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (flags & MEV_ARENA_HUGE) {
+        const size_t len = round_up(size, ARENA_HUGE_PAGE);
+        void* p;
+#ifdef MAP_HUGETLB
+        p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            a->map = a->base = (uint8_t*)p;
+            a->map_size = a->size = len;
+            a->page_size = ARENA_HUGE_PAGE;
+            a->backing = MEV_ARENA_BACKING_HUGETLB;
+            return 0;
+        }
+#endif
+#ifdef MADV_HUGEPAGE
+        // Over-map by one huge page and trim, so the region is 2 MB aligned
+        p = mmap(NULL, len + ARENA_HUGE_PAGE, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED) {
+            uint8_t* start = (uint8_t*)round_up((uintptr_t)p, ARENA_HUGE_PAGE);
+            size_t head = (size_t)(start - (uint8_t*)p);
+            if (head) munmap(p, head);
+            if (ARENA_HUGE_PAGE - head) munmap(start + len, ARENA_HUGE_PAGE - head);
+            a->map = a->base = start;
+            a->map_size = a->size = len;
+            if (madvise(start, len, MADV_HUGEPAGE) == 0) {
+                a->page_size = ARENA_HUGE_PAGE;
+                a->backing = MEV_ARENA_BACKING_THP;
+            } else {
+                a->page_size = base_page;
+                a->backing = MEV_ARENA_BACKING_4K;
+            }
+            return 0;
+        }
+#endif
+    }
+
+    size_t len = round_up(size, base_page);
+    void* p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return -1;
+    a->map = a->base = (uint8_t*)p;
+    a->map_size = a->size = len;
+    a->page_size = base_page;
+    a->backing = MEV_ARENA_BACKING_4K;
+    return 0;
+}
+#endif
+
+/**
+ * Reserve, pre-fault and lock an arena of at least `size` bytes
+ */
+mev_arena_t* mev_arena_create(size_t size, unsigned flags) {
+    if (size == 0) return NULL;
+    mev_arena_t* a = (mev_arena_t*)calloc(1, sizeof(mev_arena_t));
+    if (!a) return NULL;
+
+#ifndef _WIN32
+    if (arena_map(a, size, flags) != 0)
+#endif
+    {
+        // Heap fallback: still one contiguous, page-aligned region
+        size = round_up(size, 4096);
+#ifdef _WIN32
+        a->map = _aligned_malloc(size, 4096);
+#else
+        if (posix_memalign(&a->map, 4096, size) != 0) a->map = NULL;
+#endif
+        if (!a->map) {
+            free(a);
+            return NULL;
+        }
+        a->base = (uint8_t*)a->map;
+        a->map_size = a->size = size;
+        a->page_size = 4096;
+        a->backing = MEV_ARENA_BACKING_HEAP;
+    }
+
+    mev_arena_commit(a, a->base, a->size, flags);
+    return a;
+}
+
+/**
+ * Pre-fault and / or lock [p, p + bytes) — the whole arena at create, or
+ * just the part of a reservation that must be resident from the start.
+ * Faults and time add up in the arena's report.
+ */
+int mev_arena_commit(mev_arena_t* a, void* p, size_t bytes, unsigned flags) {
+    if (!mev_arena_contains(a, p) || (size_t)((uint8_t*)p - a->base) + bytes > a->size) return -1;
+    if (bytes == 0) return 0;
+
+    if (flags & MEV_ARENA_PREFAULT) {
+        size_t touch_page = 4096;
+        long min0 = 0, maj0 = 0, min1 = 0, maj1 = 0;
+        uint64_t t0 = arena_now_ns();
+#ifndef _WIN32
+        touch_page = (size_t)sysconf(_SC_PAGESIZE);
+        arena_faults(&min0, &maj0);
+#endif
+        for (size_t off = 0; off < bytes; off += touch_page) {
+            ((volatile uint8_t*)p)[off] = 0;
+        }
+#ifndef _WIN32
+        arena_faults(&min1, &maj1);
+#endif
+        a->prefault_ns += arena_now_ns() - t0;
+        a->minor_faults += min1 - min0;
+        a->major_faults += maj1 - maj0;
+    }
+
+#ifndef _WIN32
+    if (flags & MEV_ARENA_MLOCK) {
+        if (mlock(p, bytes) == 0) {
+            a->locked_bytes += bytes;
+        } else {
+            a->lock_failed = 1;
+        }
+    }
+#endif
+    return 0;
+}
+
+void mev_arena_destroy(mev_arena_t* a) {
+    if (!a) return;
+    if (a->backing == MEV_ARENA_BACKING_HEAP) {
+#ifdef _WIN32
+        _aligned_free(a->map);
+#else
+        free(a->map);
+#endif
+    } else {
+#ifndef _WIN32
+        if (a->locked_bytes) munlock(a->base, a->size);
+        munmap(a->map, a->map_size);
+#endif
+    }
+    free(a);
+}
+
+/**
+ * Bump-carve `bytes` at `align` (lock-free)
+ */
+void* mev_arena_carve(mev_arena_t* a, size_t bytes, size_t align, const char* label) {
+    if (!a || bytes == 0) return NULL;
+    if (align < 8) align = 8;
+
+    size_t used = atomic_load_explicit(&a->used, memory_order_relaxed);
+    size_t off;
+    do {
+        off = round_up(used, align);
+        if (off > a->size || a->size - off < bytes) return NULL;
+    } while (!atomic_compare_exchange_weak_explicit(&a->used, &used, off + bytes,
+                                                    memory_order_relaxed, memory_order_relaxed));
+
+    if (label) {
+        unsigned r = atomic_fetch_add_explicit(&a->n_regions, 1, memory_order_relaxed);
+        if (r < MEV_ARENA_MAX_REGIONS) {
+            a->regions[r].label = label;
+            a->regions[r].offset = off;
+            a->regions[r].bytes = bytes;
+        }
+    }
+    return a->base + off;
+}
+
+int mev_arena_contains(const mev_arena_t* a, const void* p) {
+    const uint8_t* b = (const uint8_t*)p;
+    return a && b >= a->base && b < a->base + a->size;
+}
+
+/**
+ * Layout and pre-fault report
+ */
+void mev_arena_info(const mev_arena_t* a, mev_arena_info_t* out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!a) return;
+    out->base = a->base;
+    out->size = a->size;
+    out->used = atomic_load(&((mev_arena_t*)a)->used);
+    out->page_size = a->page_size;
+    out->backing = a->backing;
+    out->locked = a->locked_bytes && !a->lock_failed;
+    out->locked_bytes = a->locked_bytes;
+    out->minor_faults = a->minor_faults;
+    out->major_faults = a->major_faults;
+    out->prefault_ns = a->prefault_ns;
+    out->bind_failures = atomic_load(&((mev_arena_t*)a)->bind_failures);
+    unsigned n = atomic_load(&((mev_arena_t*)a)->n_regions);
+    out->n_regions = n < MEV_ARENA_MAX_REGIONS ? n : MEV_ARENA_MAX_REGIONS;
+    memcpy(out->regions, a->regions, out->n_regions * sizeof(mev_arena_region_t));
+}
+
+const char* mev_arena_backing_name(int backing) {
+    switch (backing) {
+    case MEV_ARENA_BACKING_HUGETLB: return "hugetlb";
+    case MEV_ARENA_BACKING_THP:     return "thp";
+    case MEV_ARENA_BACKING_4K:      return "4k";
+    default:                        return "heap";
+    }
+}
+
+/*
+ * NUMA placement — raw syscalls (mbind, get_mempolicy, getcpu)
+ */
+
+/**
+ * Memory nodes this process may use: highest allowed node + 1 from
+ * get_mempolicy(MPOL_F_MEMS_ALLOWED), else from /sys, else 1
+ */
+int mev_numa_node_count(void) {
+#if !defined(_WIN32) && defined(SYS_get_mempolicy)
+    unsigned long mask = 0;
+    if (syscall(SYS_get_mempolicy, NULL, &mask, ARENA_MAX_NODES + 1, NULL, ARENA_MPOL_F_MEMS_ALLOWED) == 0 && mask) {
+        return ARENA_MAX_NODES - __builtin_clzl(mask);
+    }
+    // "0", "0-1", "0,2-3": the last number is the highest online node
+    FILE* f = fopen("/sys/devices/system/node/online", "r");
+    if (f) {
+        int n = -1, v;
+        char sep;
+        while (fscanf(f, "%d%c", &v, &sep) >= 1) {
+            n = v;
+            if (sep == '\n') break;
+        }
+        fclose(f);
+        if (n >= 0) return n + 1;
+    }
+#endif
+    return 1;
+}
+
+/**
+ * Node of the CPU the calling thread runs on (0 if unknown)
+ */
+int mev_numa_current_node(void) {
+#if !defined(_WIN32) && defined(SYS_getcpu)
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) return (int)node;
+#endif
+    return 0;
+}
+
+/**
+ * Bind [p, p + bytes) to `node` (MPOL_BIND) — call before the range is
+ * faulted in.  The range is widened to whole arena pages: mbind cannot
+ * split a hugetlb mapping inside a huge page, so callers keep ranges of
+ * different nodes page_size-aligned.  Failures are counted in the info.
+ */
+int mev_arena_bind(mev_arena_t* a, void* p, size_t bytes, int node) {
+    if (!mev_arena_contains(a, p) || node < 0 || node >= ARENA_MAX_NODES) goto fail;
+#if !defined(_WIN32) && defined(SYS_mbind)
+    if (a->backing == MEV_ARENA_BACKING_HEAP) goto fail;
+    uintptr_t start = (uintptr_t)p & ~(uintptr_t)(a->page_size - 1);
+    uintptr_t end = round_up((uintptr_t)p + bytes, a->page_size);
+    if (end > (uintptr_t)(a->base + a->size)) end = (uintptr_t)(a->base + a->size);
+    unsigned long mask = 1UL << node;
+    if (syscall(SYS_mbind, (void*)start, end - start, ARENA_MPOL_BIND, &mask, ARENA_MAX_NODES + 1, 0) == 0) return 0;
+#else
+    (void)bytes;
+#endif
+fail:
+    if (a) atomic_fetch_add_explicit(&a->bind_failures, 1, memory_order_relaxed);
+    return -1;
+}
@@ -0,0 +1,9 @@
+// backrun_cache.cpp — translation unit for backrun_cache.h
+//
+// This file exists solely to produce a concrete object file for the
+// header-only backrun precompute cache.  All logic lives in backrun_cache.h.
+//
+// Compile flag required: -std=c++20 (GCC/Clang) or /std:c++20 (MSVC)
+
+#define BACKRUN_CACHE_IMPL
+#include "backrun_cache.h"
@@ -0,0 +1,228 @@
+/**
+ * Disruptor-Style Broadcast Ring
+ * One producer (block / delta feed), N consumers (detectors) reading every record
+ *
+ * State is a set of monotonically increasing sequence numbers, each written
+ * by exactly one thread and each on its own cache line:
+ *
+ *   published        producer: records [0, published) are readable
+ *   cursor[i]        consumer i: records [0, cursor[i]) are consumed
+ *
+ * The producer may fill slot s only once min(cursor) > s - capacity, i.e.
+ * every active consumer has released the record that previously lived
+ * there.  It caches that minimum and rescans the cursors only when the
+ * cached value says the ring is full.  Consumers compare their own cursor
+ * with `published` (cached likewise) and read records in place — nothing
+ * is copied per consumer.
+ *
+ * No CAS on the data path: one release store per publish / release.
+ *
+ * Subscribing races with the producer's gating scan, whose cached gate may
+ * already be past the `published` a new consumer sampled.  The consumer
+ * therefore goes active with that (conservative) cursor first, then —
+ * after a seq_cst fence paired with one at the top of the scan — samples
+ * `published` again and starts there: either the next scan sees it, or
+ * the second sample covers every publish made before a scan that missed
+ * it, and such a scan's gate is never past what it published.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "broadcast_ring.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#define aligned_alloc(align, size) _aligned_malloc(size, align)
+#define aligned_free(ptr) _aligned_free(ptr)
+#else
+#define aligned_free(ptr) free(ptr)
+#endif
+
+typedef struct {
+    alignas(64) atomic_size_t cursor;   // next sequence to read
+    atomic_int active;
+    size_t cached_published;            // consumer-private
+} bcast_consumer_t;
+
+struct mev_bcast_t {
+    uint8_t* slots;
+    size_t capacity;
+    size_t mask;
+    size_t stride;
+    size_t max_consumers;
+    bcast_consumer_t* consumers;
+
+    // Producer line
+    alignas(64) atomic_size_t published;
+    size_t claimed;                     // producer-private: next slot to claim
+    size_t cached_min;                  // producer-private: gate
+};
+
+static inline uint8_t* bcast_slot(mev_bcast_t* b, size_t seq) {
+    return b->slots + (seq & b->mask) * b->stride;
+}
+
+/**
+ * Create a new ring
+ */
+mev_bcast_t* mev_bcast_create(size_t capacity, size_t record_size, size_t max_consumers) {
+    if (record_size == 0 || max_consumers == 0) return NULL;
+    if (capacity < 2) capacity = 2;
+    if (capacity & (capacity - 1)) {
+        // Not power of 2, round up
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        capacity = n;
+    }
+
+    mev_bcast_t* b = (mev_bcast_t*)aligned_alloc(64, sizeof(mev_bcast_t));
+    if (!b) return NULL;
+
+    b->stride = (record_size + 63) & ~(size_t)63;
+    b->slots = (uint8_t*)aligned_alloc(64, capacity * b->stride);
+    b->consumers = (bcast_consumer_t*)aligned_alloc(64, max_consumers * sizeof(bcast_consumer_t));
+    if (!b->slots || !b->consumers) {
+        aligned_free(b->slots);
+        aligned_free(b->consumers);
+        aligned_free(b);
+        return NULL;
+    }
+    memset(b->slots, 0, capacity * b->stride);
+
+    b->capacity = capacity;
+    b->mask = capacity - 1;
+    b->max_consumers = max_consumers;
+    b->claimed = 0;
+    b->cached_min = 0;
+    atomic_store(&b->published, 0);
+    for (size_t i = 0; i < max_consumers; i++) {
+        atomic_store(&b->consumers[i].cursor, 0);
+        atomic_store(&b->consumers[i].active, 0);
+        b->consumers[i].cached_published = 0;
+    }
+    return b;
+}
+
+/**
+ * Destroy ring
+ */
+void mev_bcast_destroy(mev_bcast_t* b) {
+    if (b) {
+        aligned_free(b->slots);
+        aligned_free(b->consumers);
+        aligned_free(b);
+    }
+}
+
+/**
+ * Register a consumer.  Returns its id, or -1 if all ids are taken.
+ */
+int mev_bcast_subscribe(mev_bcast_t* b) {
+    for (size_t i = 0; i < b->max_consumers; i++) {
+        bcast_consumer_t* c = &b->consumers[i];
+        int expected = 0;
+        // Claim the id while it is still inactive (2 = joining)
+        if (!atomic_compare_exchange_strong(&c->active, &expected, 2)) continue;
+        size_t start = atomic_load_explicit(&b->published, memory_order_acquire);
+        atomic_store_explicit(&c->cursor, start, memory_order_relaxed);
+        atomic_store_explicit(&c->active, 1, memory_order_release);
+
+        // Pairs with the fence in bcast_min_cursor (see the file comment)
+        atomic_thread_fence(memory_order_seq_cst);
+        start = atomic_load_explicit(&b->published, memory_order_acquire);
+        atomic_store_explicit(&c->cursor, start, memory_order_release);
+        c->cached_published = start;
+        return (int)i;
+    }
+    return -1;
+}
+
+/**
+ * Unregister a consumer; it no longer gates the producer.
+ */
+void mev_bcast_unsubscribe(mev_bcast_t* b, int id) {
+    if (id < 0 || (size_t)id >= b->max_consumers) return;
+    atomic_store_explicit(&b->consumers[id].active, 0, memory_order_release);
+}
+
+/* Slowest active cursor, or `fallback` if there is no active consumer */
+static size_t bcast_min_cursor(mev_bcast_t* b, size_t fallback) {
+    size_t min = fallback;
+    // Pairs with the fence in mev_bcast_subscribe
+    atomic_thread_fence(memory_order_seq_cst);
+    for (size_t i = 0; i < b->max_consumers; i++) {
+        bcast_consumer_t* c = &b->consumers[i];
+        if (atomic_load_explicit(&c->active, memory_order_acquire) != 1) continue;
+        size_t cur = atomic_load_explicit(&c->cursor, memory_order_acquire);
+        if (cur < min) min = cur;
+    }
+    return min;
+}
+
+/**
+ * Next slot to fill (producer thread only), NULL if the ring is full.
+ */
+void* mev_bcast_claim(mev_bcast_t* b) {
+    size_t seq = b->claimed;
+    if (seq - b->cached_min >= b->capacity) {
+        // Only the published prefix can be held by consumers
+        b->cached_min = bcast_min_cursor(b, atomic_load_explicit(&b->published, memory_order_relaxed));
+        if (seq - b->cached_min >= b->capacity) return NULL;
+    }
+    b->claimed = seq + 1;
+    return bcast_slot(b, seq);
+}
+
+/**
+ * Publish every claimed slot.  Returns the number made visible.
+ */
+size_t mev_bcast_publish(mev_bcast_t* b) {
+    size_t prev = atomic_load_explicit(&b->published, memory_order_relaxed);
+    if (b->claimed == prev) return 0;
+    atomic_store_explicit(&b->published, b->claimed, memory_order_release);
+    return b->claimed - prev;
+}
+
+/**
+ * Contiguous run of unread records for consumer `id` (its thread only).
+ */
+size_t mev_bcast_read(mev_bcast_t* b, int id, const void** first, size_t max) {
+    bcast_consumer_t* c = &b->consumers[id];
+    size_t cur = atomic_load_explicit(&c->cursor, memory_order_relaxed);
+    if (c->cached_published == cur) {
+        c->cached_published = atomic_load_explicit(&b->published, memory_order_acquire);
+        if (c->cached_published == cur) return 0;
+    }
+    size_t n = c->cached_published - cur;
+    size_t to_end = b->capacity - (cur & b->mask);
+    if (n > to_end) n = to_end;
+    if (n > max) n = max;
+    *first = bcast_slot(b, cur);
+    return n;
+}
+
+/**
+ * Consume `n` records read by mev_bcast_read.
+ */
+void mev_bcast_release(mev_bcast_t* b, int id, size_t n) {
+    bcast_consumer_t* c = &b->consumers[id];
+    size_t cur = atomic_load_explicit(&c->cursor, memory_order_relaxed);
+    atomic_store_explicit(&c->cursor, cur + n, memory_order_release);
+}
+
+size_t mev_bcast_stride(mev_bcast_t* b) {
+    return b->stride;
+}
+
+/**
+ * Records published but not yet released by consumer `id`
+ */
+size_t mev_bcast_lag(mev_bcast_t* b, int id) {
+    size_t pub = atomic_load_explicit(&b->published, memory_order_acquire);
+    return pub - atomic_load_explicit(&b->consumers[id].cursor, memory_order_acquire);
+}
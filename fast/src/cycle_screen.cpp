@@ -0,0 +1,9 @@
+// cycle_screen.cpp — translation unit for cycle_screen.h
+//
+// This file exists solely to produce a concrete object file for the
+// header-only spot-rate screen.  All logic lives in cycle_screen.h.
+//
+// Compile flag required: -std=c++20 (GCC/Clang) or /std:c++20 (MSVC)
+
+#define CYCLE_SCREEN_IMPL
+#include "cycle_screen.h"
@@ -0,0 +1,9 @@
+// graph_replica.cpp — translation unit for graph_replica.h
+//
+// This file exists solely to produce a concrete object file for the
+// header-only replication stream.  All logic lives in graph_replica.h.
+//
+// Compile flag required: -std=c++20 (GCC/Clang) or /std:c++20 (MSVC)
+
+#define GRAPH_REPLICA_IMPL
+#include "graph_replica.h"
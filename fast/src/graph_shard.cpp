@@ -0,0 +1,9 @@
+// graph_shard.cpp — translation unit for graph_shard.h
+//
+// This file exists solely to produce a concrete object file for the
+// header-only graph sharding layer.  All logic lives in graph_shard.h.
+//
+// Compile flag required: -std=c++20 (GCC/Clang) or /std:c++20 (MSVC)
+
+#define GRAPH_SHARD_IMPL
+#include "graph_shard.h"
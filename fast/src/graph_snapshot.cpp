@@ -0,0 +1,9 @@
+// graph_snapshot.cpp — translation unit for graph_snapshot.h
+//
+// This file exists solely to produce a concrete object file for the
+// header-only snapshot save/load.  All logic lives in graph_snapshot.h.
+//
+// Compile flag required: -std=c++20 (GCC/Clang) or /std:c++20 (MSVC)
+
+#define GRAPH_SNAPSHOT_IMPL
+#include "graph_snapshot.h"
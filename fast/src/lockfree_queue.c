@@ -9,6 +9,14 @@
  * but not yet stored its payload causes the consumer to read a stale/zero slot.
  *
  * Reference: http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ *
+ * Telemetry (mev_queue_enable_stats) costs one predictable branch when off.
+ * When on, counters live in QSTATS_SHARDS cache-line-aligned blocks and each
+ * thread adds to its own (threads are dealt shards round-robin on first
+ * use), so producers never contend on a stats line.  Sampled pushes store
+ * an rdtsc stamp in a per-slot side array; the consumer that claims the
+ * slot turns it into a histogram bucket and clears it before handing the
+ * slot back, so stamps ride the same sequence handshake as the payload.
  */
 
 #include <stdint.h>
@@ -17,6 +25,10 @@
 #include <string.h>
 #include <stdalign.h>
 #include <stdatomic.h>
+#include <time.h>
+
+#include "lockfree_queue.h"
+#include "simd_utils.h"
 
 #ifdef _WIN32
 #include <malloc.h>
@@ -27,6 +39,7 @@
 #endif
 
 #define QUEUE_CAPACITY 4096  // Must be power of 2
+#define QSTATS_SHARDS  16    // Per-thread counter blocks
 
 typedef struct {
     atomic_size_t     sequence;  // Vyukov ticket: marks who may write/read this slot
@@ -34,15 +47,89 @@ typedef struct {
 } queue_slot_t;
 
 typedef struct {
+    alignas(64) atomic_uint_fast64_t pushes;
+    atomic_uint_fast64_t pops;
+    atomic_uint_fast64_t full;
+    atomic_uint_fast64_t sampled;
+    atomic_uint_fast64_t sojourn[MEV_QUEUE_LAT_BUCKETS];
+} qstats_shard_t;
+
+typedef struct {
+    qstats_shard_t shards[QSTATS_SHARDS];
+    alignas(64) atomic_size_t high_water;
+    _Atomic uint64_t* stamps;    // per slot, 0 = not sampled
+    uint64_t sample_mask;
+    uint64_t tsc0;
+    uint64_t ns0;
+} queue_stats_t;
+
+struct mev_queue_t {
     queue_slot_t* slots;
     size_t capacity;
     size_t mask;
+    queue_stats_t* stats;        // NULL unless enabled
 
     // Aligned to separate cache lines to avoid false sharing between
     // the consumer-owned head and the producer-owned tail.
     alignas(64) atomic_size_t head;  // Consumer cursor
     alignas(64) atomic_size_t tail;  // Producer cursor
-} mev_queue_t;
+};
+
+static atomic_uint g_next_shard;
+static _Thread_local unsigned tls_shard = UINT32_MAX;
+
+static inline qstats_shard_t* qstats_shard(queue_stats_t* st) {
+    if (tls_shard == UINT32_MAX) {
+        tls_shard = atomic_fetch_add_explicit(&g_next_shard, 1, memory_order_relaxed) % QSTATS_SHARDS;
+    }
+    return &st->shards[tls_shard];
+}
+
+static uint64_t qstats_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* After a push of `n` items at tickets [pos, pos + n) */
+static void qstats_pushed(mev_queue_t* q, size_t pos, size_t n) {
+    queue_stats_t* st = q->stats;
+    qstats_shard_t* sh = qstats_shard(st);
+    uint64_t before = atomic_fetch_add_explicit(&sh->pushes, n, memory_order_relaxed);
+    if (((before + n) & ~st->sample_mask) != (before & ~st->sample_mask)) {
+        // A sample boundary was crossed: stamp the first item of the run.
+        // The payload is not published yet, so the stamp rides its sequence store.
+        atomic_store_explicit(&st->stamps[pos & q->mask], mev_rdtsc() | 1, memory_order_relaxed);
+    }
+
+    size_t depth = pos + n - atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t hw = atomic_load_explicit(&st->high_water, memory_order_relaxed);
+    while (depth > hw && depth <= q->capacity &&
+           !atomic_compare_exchange_weak_explicit(&st->high_water, &hw, depth,
+                                                  memory_order_relaxed, memory_order_relaxed)) { }
+}
+
+static void qstats_full(mev_queue_t* q) {
+    atomic_fetch_add_explicit(&qstats_shard(q->stats)->full, 1, memory_order_relaxed);
+}
+
+/* Before releasing slots [pos, pos + n) to producers */
+static void qstats_popped(mev_queue_t* q, size_t pos, size_t n) {
+    queue_stats_t* st = q->stats;
+    qstats_shard_t* sh = qstats_shard(st);
+    atomic_fetch_add_explicit(&sh->pops, n, memory_order_relaxed);
+    for (size_t k = 0; k < n; k++) {
+        _Atomic uint64_t* stamp = &st->stamps[(pos + k) & q->mask];
+        uint64_t t0 = atomic_load_explicit(stamp, memory_order_relaxed);
+        if (!t0) continue;
+        atomic_store_explicit(stamp, 0, memory_order_relaxed);
+        uint64_t dt = mev_rdtsc() - t0;
+        unsigned b = dt ? 63u - (unsigned)__builtin_clzll(dt) : 0;
+        if (b >= MEV_QUEUE_LAT_BUCKETS) b = MEV_QUEUE_LAT_BUCKETS - 1;
+        atomic_fetch_add_explicit(&sh->sojourn[b], 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&sh->sampled, 1, memory_order_relaxed);
+    }
+}
 
 /**
  * Create a new queue
@@ -66,6 +153,7 @@ mev_queue_t* mev_queue_create(size_t capacity) {
 
     q->capacity = capacity;
     q->mask = capacity - 1;
+    q->stats = NULL;
     atomic_store(&q->head, 0);
     atomic_store(&q->tail, 0);
 
@@ -86,6 +174,10 @@ mev_queue_t* mev_queue_create(size_t capacity) {
  */
 void mev_queue_destroy(mev_queue_t* q) {
     if (q) {
+        if (q->stats) {
+            free((void*)q->stats->stamps);
+            aligned_free(q->stats);
+        }
         free(q->slots);
         aligned_free(q);
     }
@@ -118,11 +210,13 @@ int mev_queue_push(mev_queue_t* q, void* item) {
                     memory_order_relaxed, memory_order_relaxed)) {
                 // Slot reserved. Write payload, then release-publish via sequence.
                 atomic_store_explicit(&slot->data, (uintptr_t)item, memory_order_relaxed);
+                if (q->stats) qstats_pushed(q, pos, 1);
                 atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
                 return 0;
             }
             // CAS lost the race; pos already updated, retry.
         } else if (diff < 0) {
+            if (q->stats) qstats_full(q);
             return -1; // Full: lap in progress, consumer is behind.
         } else {
             // Another producer claimed this position; reload tail and retry.
@@ -161,6 +255,7 @@ void* mev_queue_pop(mev_queue_t* q) {
                     &q->head, &pos, pos + 1,
                     memory_order_relaxed, memory_order_relaxed)) {
                 void* item = (void*)atomic_load_explicit(&slot->data, memory_order_relaxed);
+                if (q->stats) qstats_popped(q, pos, 1);
                 // Release the slot for reuse on the next lap.
                 atomic_store_explicit(&slot->sequence, pos + q->capacity, memory_order_release);
                 return item;
@@ -197,16 +292,153 @@ int mev_queue_empty(mev_queue_t* q) {
 }
 
 /**
- * Batch pop for efficiency
+ * Batch push (multi-producer safe, lock-free).
+ * Returns the number of items pushed, 0 if full.
+ *
+ * Algorithm:
+ *   1. Read tail and count the run of consecutive slots whose sequence equals
+ *      their ticket (free for this lap), up to n_items.
+ *   2. One CAS moves tail over the whole run; the tickets are now ours.
+ *   3. Write each payload and release-publish its sequence = ticket + 1, in
+ *      order, so the consumer sees the run exactly as single pushes would.
+ *
+ * A partially free run is claimed as far as it goes: the caller retries the
+ * remainder, just as with a full single push.
+ */
+size_t mev_queue_push_batch(mev_queue_t* q, void* const* items, size_t n_items) {
+    if (n_items == 0) return 0;
+    if (n_items > q->capacity) n_items = q->capacity;
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    for (;;) {
+        size_t run = 0;
+        intptr_t diff = 0;
+        while (run < n_items) {
+            size_t seq = atomic_load_explicit(&q->slots[(pos + run) & q->mask].sequence,
+                                              memory_order_acquire);
+            diff = (intptr_t)seq - (intptr_t)(pos + run);
+            if (diff != 0) break;
+            run++;
+        }
+
+        if (run == 0) {
+            if (diff < 0) {
+                if (q->stats) qstats_full(q);
+                return 0;  // Full
+            }
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(
+                &q->tail, &pos, pos + run,
+                memory_order_relaxed, memory_order_relaxed)) {
+            if (q->stats) {
+                qstats_pushed(q, pos, run);
+                if (run < n_items) qstats_full(q);
+            }
+            for (size_t k = 0; k < run; k++) {
+                queue_slot_t* slot = &q->slots[(pos + k) & q->mask];
+                atomic_store_explicit(&slot->data, (uintptr_t)items[k], memory_order_relaxed);
+                atomic_store_explicit(&slot->sequence, pos + k + 1, memory_order_release);
+            }
+            return run;
+        }
+        // CAS lost the race; pos already reloaded, rescan from there.
+    }
+}
+
+/**
+ * Batch pop (multi-consumer safe, lock-free).
+ * Returns the number of items popped, 0 if empty.
+ *
+ * Mirror of push_batch: count the run of committed slots (sequence equals
+ * ticket + 1) from head, claim it with one CAS, then drain and release each
+ * slot for the next lap (sequence = ticket + capacity).
  */
 size_t mev_queue_pop_batch(mev_queue_t* q, void** items, size_t max_items) {
-    size_t count = 0;
+    if (max_items == 0) return 0;
+    if (max_items > q->capacity) max_items = q->capacity;
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    for (;;) {
+        size_t run = 0;
+        intptr_t diff = 0;
+        while (run < max_items) {
+            size_t seq = atomic_load_explicit(&q->slots[(pos + run) & q->mask].sequence,
+                                              memory_order_acquire);
+            diff = (intptr_t)seq - (intptr_t)(pos + run + 1);
+            if (diff != 0) break;
+            run++;
+        }
+
+        if (run == 0) {
+            if (diff < 0) return 0;  // Empty
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(
+                &q->head, &pos, pos + run,
+                memory_order_relaxed, memory_order_relaxed)) {
+            if (q->stats) qstats_popped(q, pos, run);
+            for (size_t k = 0; k < run; k++) {
+                queue_slot_t* slot = &q->slots[(pos + k) & q->mask];
+                items[k] = (void*)atomic_load_explicit(&slot->data, memory_order_relaxed);
+                atomic_store_explicit(&slot->sequence, pos + k + q->capacity, memory_order_release);
+            }
+            return run;
+        }
+    }
+}
+
+/**
+ * Turn on telemetry.  Not thread-safe: call before the queue is shared.
+ * Returns 0, or -1 on allocation failure.
+ */
+int mev_queue_enable_stats(mev_queue_t* q, unsigned sample_shift) {
+    if (q->stats) return 0;
+    if (sample_shift > 31) sample_shift = 31;
+
+    queue_stats_t* st = (queue_stats_t*)aligned_alloc(64, sizeof(queue_stats_t));
+    if (!st) return -1;
+    memset(st, 0, sizeof(*st));
+    st->stamps = (_Atomic uint64_t*)calloc(q->capacity, sizeof(uint64_t));
+    if (!st->stamps) {
+        aligned_free(st);
+        return -1;
+    }
+    st->sample_mask = (1ULL << sample_shift) - 1;
+    st->tsc0 = mev_rdtsc();
+    st->ns0 = qstats_now_ns();
+    atomic_thread_fence(memory_order_release);
+    q->stats = st;
+    return 0;
+}
 
-    while (count < max_items) {
-        void* item = mev_queue_pop(q);
-        if (!item) break;
-        items[count++] = item;
+/**
+ * Snapshot the counters (summed over shards; each counter is exact, the
+ * set is not an atomic cut).  Returns -1 if telemetry is off.
+ */
+int mev_queue_stats(mev_queue_t* q, mev_queue_stats_t* out) {
+    queue_stats_t* st = q->stats;
+    if (!st || !out) return -1;
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < QSTATS_SHARDS; i++) {
+        qstats_shard_t* sh = &st->shards[i];
+        out->pushes  += atomic_load_explicit(&sh->pushes, memory_order_relaxed);
+        out->pops    += atomic_load_explicit(&sh->pops, memory_order_relaxed);
+        out->full    += atomic_load_explicit(&sh->full, memory_order_relaxed);
+        out->sampled += atomic_load_explicit(&sh->sampled, memory_order_relaxed);
+        for (int b = 0; b < MEV_QUEUE_LAT_BUCKETS; b++) {
+            out->sojourn[b] += atomic_load_explicit(&sh->sojourn[b], memory_order_relaxed);
+        }
     }
+    out->depth = mev_queue_size(q);
+    out->high_water = atomic_load_explicit(&st->high_water, memory_order_relaxed);
+    out->capacity = q->capacity;
 
-    return count;
+    uint64_t ns = qstats_now_ns() - st->ns0;
+    out->ticks_per_ns = ns ? (double)(mev_rdtsc() - st->tsc0) / (double)ns : 0.0;
+    return 0;
 }
@@ -0,0 +1,9 @@
+// log_decoder.cpp — translation unit for log_decoder.h
+//
+// This file exists solely to produce a concrete object file for the
+// header-only event-log decoder.  All logic lives in log_decoder.h.
+//
+// Compile flag required: -std=c++20 (GCC/Clang) or /std:c++20 (MSVC)
+
+#define LOG_DECODER_IMPL
+#include "log_decoder.h"
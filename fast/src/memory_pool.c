@@ -1,14 +1,65 @@
 /**
  * Lock-Free Memory Pool for Zero-Allocation Hot Path
  * Pre-allocates buffers to avoid malloc during execution
+ *
+ * Size classes: a runtime-configurable, ascending list of block sizes
+ * (default 256 B .. 128 KB, see g_default_classes), each with an initial
+ * and a maximum block count.  mev_alloc(size) takes the smallest class
+ * that fits; the tx / calldata / result calls are the 512 B / 2 KB / 256 B
+ * lookups done once at init.
+ *
+ * Each class is one slab of fixed-size blocks with a lock-free free list:
+ * a Treiber stack whose head word carries a 32-bit generation tag next to
+ * the top block's index, so pop / push are one CAS each and immune to ABA.
+ * Free-list links live in a side array indexed by block, so a caller
+ * scribbling over a freed block cannot corrupt the list.  The slab
+ * reserves room for the maximum count but only the initial blocks start
+ * on the free list; when it runs dry the class grows one block at a time
+ * (a CAS on n_carved) up to the maximum, and only then is a block malloc'd
+ * and counted as a fallback.  n_free is exact, so n_carved - n_free is
+ * exactly the slab blocks held by threads / callers.
+ *
+ * Finding a block's class on free is O(1): slabs are aligned to 64 KB
+ * granules of the arena and a byte per granule names the class.  Anything
+ * outside the arena (class fallbacks, and sizes above the largest class)
+ * carries a 64-byte header with its class in front of the block.
+ *
+ * Per-thread magazines: each thread keeps a small stack of free blocks per
+ * class (MAG_CAPACITY, fewer for classes above 2 KB).  Alloc pops and free
+ * pushes on that stack with no atomics; only an empty magazine refills
+ * from the shared pool (half a magazine) and only a full one spills half
+ * back, so the shared free-list head sees one CAS per batch instead of
+ * one per operation.  A thread's magazines are flushed to the shared
+ * pools when it exits (pthread key destructor).  Blocks cached in
+ * magazines are not counted by mev_pool_stats().
+ *
+ * Arena: every slab and link array is carved from one arena (arena.c) —
+ * huge pages where available — and the initial blocks of each class are
+ * pre-faulted and mlocked at init (MEV_ARENA_DEFAULT), so the hot path
+ * takes neither TLB misses across scattered 4K pages nor first-touch
+ * faults.  Growth beyond the initial count faults in lazily.
+ *
+ * NUMA: with more than one memory node, each node gets its own copy of
+ * every class, in its own span of the arena bound to that node (mbind)
+ * before it is pre-faulted.  A thread allocates from the pools of the node
+ * it runs on (getcpu, rechecked whenever a magazine refills, or pinned
+ * with mev_pools_set_thread_node); its magazines only ever hold blocks of
+ * that node.  A free finds the owning pool by address as before, and a
+ * block of another node goes straight back to its own node's free list.
+ * With one node (or nodes = 1) this is the single-arena layout.
  */
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdalign.h>
 #include <stdatomic.h>
 
+#include "memory_pool.h"
+#include "arena.h"
+
 #ifdef _WIN32
 #include <windows.h>
 #include <malloc.h>
@@ -16,24 +67,95 @@
 #define aligned_free(ptr) _aligned_free(ptr)
 #else
 #include <sys/mman.h>
+#include <pthread.h>
 #define aligned_free(ptr) free(ptr)
 #endif
 
-#define POOL_BLOCK_SIZE 4096
-#define POOL_MAX_BLOCKS 1024
+#define POOL_NIL        0xFFFFFFFFu  // free-list terminator
+
+#define POOL_GRANULE_SHIFT 16        // 64 KB granules in the class map
+#define POOL_GRANULE    ((size_t)1 << POOL_GRANULE_SHIFT)
+#define POOL_NO_CLASS   0xFF         // granule holds no slab
+
+#define POOL_HDR        64           // header ahead of every off-arena block
+#define POOL_HDR_MAGIC  0x4C4F4F50u  // "POOL"
+#define POOL_OVERSIZE   0xFFFFu      // header class: larger than every class
+
+#define POOL_NODE_ALIGN ((size_t)2 << 20)  // per-node spans start on a huge page
+
+#define MAG_CAPACITY    32     // blocks per thread per class (up to 2 KB blocks)
 
 typedef struct {
-    void* blocks[POOL_MAX_BLOCKS];
-    atomic_uint head;
-    atomic_uint tail;
-    atomic_uint count;
+    uint8_t* slab;             // max_blocks * block_size reserved in the arena
+    _Atomic uint32_t* next;    // free-list links, by block index
     size_t block_size;
+    uint32_t max_blocks;
+    unsigned id;               // index into g_pools: the class map and fallback headers
+    unsigned cls;              // class index: magazines
+    unsigned node;             // NUMA node the slab is bound to
+    unsigned mag_cap;          // magazine size for this class
+    unsigned mag_batch;        // blocks moved per refill / spill
+    char name[24];             // arena layout label
+
+    // Free-list head: tag << 32 | index of the top block (POOL_NIL if empty)
+    alignas(64) _Atomic uint64_t head;
+    atomic_size_t n_free;      // blocks on the free list (the rest are out: magazines or callers)
+
+    // Growth, contention and fallback counters, off the head line
+    alignas(64) _Atomic uint32_t n_carved;   // blocks put into service (initial + grown)
+    atomic_size_t cas_retries;
+    atomic_size_t refills;
+    atomic_size_t spills;
+    atomic_size_t remote_frees;      // freed by a thread of another node
+    atomic_size_t fallback_allocs;   // malloc'd because the class was at its maximum
+    atomic_size_t fallback_live;     // ... and not yet freed
 } mev_memory_pool_t;
 
-static mev_memory_pool_t g_tx_pool;      // For transaction buffers
-static mev_memory_pool_t g_calldata_pool; // For calldata
-static mev_memory_pool_t g_result_pool;   // For results
+typedef struct {
+    uint32_t magic;
+    uint32_t cls;              // class index or POOL_OVERSIZE
+    size_t size;
+} pool_hdr_t;
+
+typedef struct {
+    void* blocks[MAG_CAPACITY];
+    unsigned n;
+} magazine_t;
+
+typedef struct {
+    magazine_t mags[MEV_POOL_MAX_CLASSES];
+    unsigned node;             // node every cached block belongs to
+} thread_cache_t;
+
+// Node n, class c is g_pools[n * g_n_classes + c]
+static mev_memory_pool_t g_pools[MEV_POOL_MAX_NODES * MEV_POOL_MAX_CLASSES];
+static unsigned g_n_classes;
+static unsigned g_n_nodes = 1;
+static int g_tx_class = -1;       // For transaction buffers (512 B)
+static int g_calldata_class = -1; // For calldata (2 KB)
+static int g_result_class = -1;   // For results (256 B)
 static int g_pools_initialized = 0;
+static atomic_int g_magazines_enabled = 1;
+
+static mev_arena_t* g_arena;
+static uintptr_t g_arena_base;
+static size_t g_arena_size;
+static uint8_t* g_granule_class;           // g_pools index per arena granule
+
+static atomic_size_t g_oversize_allocs;
+static atomic_size_t g_oversize_live;
+
+static const mev_size_class_t g_default_classes[] = {
+    {    256, 1024, 4096 },   // results
+    {    512, 1024, 4096 },   // txs
+    {   2048,  512, 2048 },   // calldata
+    {   4096,  256, 1024 },   // multicall calldata
+    {   8192,   64,  512 },
+    {  16384,   32,  256 },
+    {  32768,   16,  128 },
+    {  65536,    8,   64 },
+    { 131072,    4,   32 },   // blob chunks, Universal Router payloads
+};
 
 /**
  * Allocate aligned memory
@@ -48,168 +170,648 @@ static void* alloc_aligned(size_t size, size_t alignment) {
 #endif
 }
 
+static inline uint64_t pool_head(uint32_t tag, uint32_t idx) {
+    return ((uint64_t)tag << 32) | idx;
+}
+
+static inline size_t round_block(size_t size) {
+    return (size + 63) & ~(size_t)63;
+}
+
+static inline size_t slab_bytes(size_t block_size, uint32_t max_blocks) {
+    return (round_block(block_size) * max_blocks + POOL_GRANULE - 1) & ~(POOL_GRANULE - 1);
+}
+
 /**
- * Initialize a memory pool
+ * Initialize one node's copy of a class: reserve its slab in the arena,
+ * put the initial blocks on the free list, tag its granules in the class
+ * map.  The initial blocks are committed once the node's span is bound.
  */
-static int pool_init(mev_memory_pool_t* pool, size_t block_size, size_t initial_blocks) {
-    pool->block_size = block_size;
-    atomic_store(&pool->head, 0);
-    atomic_store(&pool->tail, 0);
-    atomic_store(&pool->count, 0);
-    
-    memset(pool->blocks, 0, sizeof(pool->blocks));
-    
-    // Pre-allocate blocks
-    for (size_t i = 0; i < initial_blocks && i < POOL_MAX_BLOCKS; i++) {
-        void* block = alloc_aligned(block_size, 64); // Cache-line aligned
-        if (!block) return -1;
-        pool->blocks[i] = block;
-        atomic_fetch_add(&pool->count, 1);
-        atomic_store(&pool->tail, i + 1);
+static int pool_init(mev_memory_pool_t* pool, unsigned node, unsigned c,
+                     const mev_size_class_t* cls, size_t slab_align) {
+    memset(pool, 0, sizeof(*pool));
+    pool->block_size = round_block(cls->block_size);
+    pool->max_blocks = cls->max;
+    pool->id = node * g_n_classes + c;
+    pool->cls = c;
+    pool->node = node;
+    if (g_n_nodes > 1) {
+        snprintf(pool->name, sizeof(pool->name), "n%u:%zu", node, pool->block_size);
+    } else {
+        snprintf(pool->name, sizeof(pool->name), "%zu", pool->block_size);
     }
-    
+
+    // Full magazines up to 2 KB blocks, then ~64 KB worth (at least 2)
+    size_t cap = pool->block_size <= 2048 ? MAG_CAPACITY : (MAG_CAPACITY * 2048) / pool->block_size;
+    pool->mag_cap = cap < 2 ? 2 : (unsigned)cap;
+    pool->mag_batch = pool->mag_cap / 2;
+
+    const size_t bytes = slab_bytes(cls->block_size, cls->max);
+    pool->slab = (uint8_t*)mev_arena_carve(g_arena, bytes, slab_align, pool->name);
+    pool->next = (_Atomic uint32_t*)mev_arena_carve(g_arena, cls->max * sizeof(uint32_t), 64, NULL);
+    if (!pool->slab || !pool->next) return -1;
+
+    // Initial blocks in address order: 0 -> 1 -> ... -> initial-1
+    for (uint32_t i = 0; i < cls->initial; i++) {
+        atomic_store_explicit(&pool->next[i], i + 1 < cls->initial ? i + 1 : POOL_NIL, memory_order_relaxed);
+    }
+    atomic_store(&pool->n_carved, cls->initial);
+    atomic_store(&pool->n_free, cls->initial);
+    atomic_store(&pool->head, pool_head(0, cls->initial ? 0 : POOL_NIL));
+
+    const size_t g0 = ((uintptr_t)pool->slab - g_arena_base) >> POOL_GRANULE_SHIFT;
+    memset(g_granule_class + g0, (int)pool->id, bytes >> POOL_GRANULE_SHIFT);
     return 0;
 }
 
 /**
- * Get a block from pool (lock-free)
+ * Put one more slab block into service, NULL once the class is at its maximum
  */
-static void* pool_get(mev_memory_pool_t* pool) {
-    while (1) {
-        unsigned int head = atomic_load(&pool->head);
-        unsigned int tail = atomic_load(&pool->tail);
-        
-        if (head >= tail) {
-            // Pool empty - allocate new (slow path)
-            return alloc_aligned(pool->block_size, 64);
+static void* pool_grow(mev_memory_pool_t* pool) {
+    uint32_t n = atomic_load_explicit(&pool->n_carved, memory_order_relaxed);
+    while (n < pool->max_blocks) {
+        if (atomic_compare_exchange_weak_explicit(&pool->n_carved, &n, n + 1,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            return pool->slab + (size_t)n * pool->block_size;
         }
-        
-        if (atomic_compare_exchange_weak(&pool->head, &head, head + 1)) {
-            void* block = pool->blocks[head % POOL_MAX_BLOCKS];
-            return block;
+    }
+    return NULL;
+}
+
+/**
+ * Pop a slab block from the free list (lock-free), growing the class if
+ * it is empty; NULL once it is empty and at its maximum
+ *
+ * Treiber stack with a generation tag in the head word: a CAS only
+ * succeeds if nobody has popped or pushed since we read the head, so a
+ * block that was popped and pushed back in between (ABA) cannot be handed
+ * out twice.  Links live in a side array, never in the blocks themselves.
+ */
+static void* pool_try_get(mev_memory_pool_t* pool) {
+    uint64_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    for (;;) {
+        uint32_t idx = (uint32_t)head;
+        if (idx == POOL_NIL) return pool_grow(pool);
+        uint32_t next = atomic_load_explicit(&pool->next[idx], memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(&pool->head, &head,
+                                                  pool_head((uint32_t)(head >> 32) + 1, next),
+                                                  memory_order_acquire, memory_order_acquire)) {
+            atomic_fetch_sub_explicit(&pool->n_free, 1, memory_order_relaxed);
+            return pool->slab + (size_t)idx * pool->block_size;
         }
-        // CAS failed, retry
+        // CAS failed, head reloaded: retry
+        atomic_fetch_add_explicit(&pool->cas_retries, 1, memory_order_relaxed);
     }
 }
 
 /**
- * Return block to pool (lock-free)
+ * Off-arena block with a header naming its class (or POOL_OVERSIZE)
+ */
+static void* heap_block(uint32_t cls, size_t size) {
+    uint8_t* raw = (uint8_t*)alloc_aligned(POOL_HDR + size, 64);
+    if (!raw) return NULL;
+    pool_hdr_t* hdr = (pool_hdr_t*)raw;
+    hdr->magic = POOL_HDR_MAGIC;
+    hdr->cls = cls;
+    hdr->size = size;
+    return raw + POOL_HDR;
+}
+
+/**
+ * Class exhausted: malloc a block and count it
+ */
+static void* pool_fallback(mev_memory_pool_t* pool) {
+    void* block = heap_block(pool->id, pool->block_size);
+    if (block) {
+        atomic_fetch_add_explicit(&pool->fallback_allocs, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&pool->fallback_live, 1, memory_order_relaxed);
+    }
+    return block;
+}
+
+/**
+ * Get a block from pool (lock-free)
+ */
+static void* pool_get(mev_memory_pool_t* pool) {
+    void* block = pool_try_get(pool);
+    if (block) return block;
+    // Class at its maximum - allocate new (slow path)
+    return pool_fallback(pool);
+}
+
+/**
+ * Return a slab block to its class (lock-free)
  *
- * Write the block pointer into the slot BEFORE bumping the tail so that
- * consumers never observe a slot with a stale/NULL pointer.  We use
- * acquire/release ordering on tail to guarantee the store to blocks[]
- * is visible before a consumer reads the updated tail.
+ * The link is written first, then published by the release CAS on head,
+ * so a popper that sees the new head also sees its link.
  */
 static void pool_put(mev_memory_pool_t* pool, void* block) {
-    if (!block) return;
-    
-    unsigned int count = atomic_load_explicit(&pool->count, memory_order_relaxed);
-    if (count >= POOL_MAX_BLOCKS) {
-        // Pool full - free block
-#ifdef _WIN32
-        _aligned_free(block);
-#else
-        free(block);
+    uint32_t idx = (uint32_t)(((uint8_t*)block - pool->slab) / pool->block_size);
+    uint64_t head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+    for (;;) {
+        atomic_store_explicit(&pool->next[idx], (uint32_t)head, memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(&pool->head, &head,
+                                                  pool_head((uint32_t)(head >> 32) + 1, idx),
+                                                  memory_order_release, memory_order_relaxed)) {
+            atomic_fetch_add_explicit(&pool->n_free, 1, memory_order_relaxed);
+            return;
+        }
+        atomic_fetch_add_explicit(&pool->cas_retries, 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * Class owning a slab block, NULL if the block is not in the arena
+ */
+static inline mev_memory_pool_t* pool_of(const void* block) {
+    const size_t off = (uintptr_t)block - g_arena_base;   // wraps above g_arena_size if below base
+    if (off >= g_arena_size) return NULL;
+    const uint8_t cls = g_granule_class[off >> POOL_GRANULE_SHIFT];
+    return cls == POOL_NO_CLASS ? NULL : &g_pools[cls];
+}
+
+/**
+ * Class for a request size: the smallest that fits, -1 above the largest
+ */
+static inline int class_for_size(size_t size) {
+    for (unsigned c = 0; c < g_n_classes; c++) {
+        if (size <= g_pools[c].block_size) return (int)c;
+    }
+    return -1;
+}
+
+static inline mev_memory_pool_t* node_pool(unsigned node, unsigned cls) {
+    return &g_pools[node * g_n_classes + cls];
+}
+
+
+/*
+ * Thread -> NUMA node
+ */
+
+static _Thread_local int tls_node = -1;     // node this thread allocates from
+static _Thread_local int tls_node_pinned;   // set by mev_pools_set_thread_node
+
+/**
+ * The calling thread's current node, folded into the configured nodes
+ */
+static unsigned current_node(void) {
+    if (g_n_nodes == 1) return 0;
+    return (unsigned)mev_numa_current_node() % g_n_nodes;
+}
+
+static inline unsigned thread_node(void) {
+    if (tls_node < 0) tls_node = (int)current_node();
+    return (unsigned)tls_node;
+}
+
+
+/*
+ * Per-thread magazines
+ */
+
+#ifndef _WIN32
+static pthread_key_t g_cache_key;
+static pthread_once_t g_cache_once = PTHREAD_ONCE_INIT;
+#endif
+static _Thread_local thread_cache_t* tls_cache;
+static _Thread_local int tls_cache_dead;      // thread is exiting: its cache is gone
+
+/**
+ * Return every cached block to its shared pool
+ */
+static void thread_cache_flush(thread_cache_t* cache) {
+    for (unsigned c = 0; c < g_n_classes; c++) {
+        magazine_t* m = &cache->mags[c];
+        while (m->n) pool_put(node_pool(cache->node, c), m->blocks[--m->n]);
+    }
+}
+
+#ifndef _WIN32
+static void thread_cache_destroy(void* arg) {
+    // Later allocs / frees from other exit destructors on this thread go
+    // to the shared pools instead of a freed (or new, leaked) cache
+    tls_cache = NULL;
+    tls_cache_dead = 1;
+    thread_cache_flush((thread_cache_t*)arg);
+    free(arg);
+}
+
+static void thread_cache_key_init(void) {
+    pthread_key_create(&g_cache_key, thread_cache_destroy);
+}
 #endif
+
+/**
+ * This thread's magazines, created on first use.  NULL (shared pool only)
+ * if they are disabled or cannot be allocated.
+ */
+static thread_cache_t* thread_cache(void) {
+    thread_cache_t* cache = tls_cache;
+    if (cache) return cache;
+    if (tls_cache_dead || !atomic_load_explicit(&g_magazines_enabled, memory_order_relaxed)) return NULL;
+
+    cache = (thread_cache_t*)calloc(1, sizeof(thread_cache_t));
+    if (!cache) return NULL;
+    cache->node = thread_node();
+#ifndef _WIN32
+    // Without a key destructor (Windows) cached blocks leak at thread exit
+    pthread_once(&g_cache_once, thread_cache_key_init);
+    pthread_setspecific(g_cache_key, cache);
+#endif
+    tls_cache = cache;
+    return cache;
+}
+
+/**
+ * Follow an unpinned thread to the node it now runs on; its magazines
+ * hold the old node's blocks, so they go back first
+ */
+static void thread_cache_rehome(thread_cache_t* cache) {
+    if (g_n_nodes == 1 || tls_node_pinned) return;
+    unsigned node = current_node();
+    tls_node = (int)node;
+    if (node == cache->node) return;
+    thread_cache_flush(cache);
+    cache->node = node;
+}
+
+/**
+ * Allocate class `cls` through the calling thread's magazine
+ */
+static void* mag_get(unsigned cls) {
+    thread_cache_t* cache = thread_cache();
+    if (!cache) return pool_get(node_pool(thread_node(), cls));
+    magazine_t* m = &cache->mags[cls];
+    if (m->n) return m->blocks[--m->n];
+
+    // Empty: refill a batch from this node's shared pool
+    thread_cache_rehome(cache);
+    mev_memory_pool_t* pool = node_pool(cache->node, cls);
+    atomic_fetch_add_explicit(&pool->refills, 1, memory_order_relaxed);
+    while (m->n < pool->mag_batch) {
+        void* block = pool_try_get(pool);
+        if (!block) break;
+        m->blocks[m->n++] = block;
+    }
+    if (m->n) return m->blocks[--m->n];
+    return pool_fallback(pool);
+}
+
+/**
+ * Free a slab block through the calling thread's magazine — or, if it
+ * belongs to another node, straight back to that node's pool
+ */
+static void mag_put(mev_memory_pool_t* pool, void* block) {
+    thread_cache_t* cache = thread_cache();
+    if (!cache || pool->node != cache->node) {
+        if (g_n_nodes > 1 && pool->node != (cache ? cache->node : thread_node())) {
+            atomic_fetch_add_explicit(&pool->remote_frees, 1, memory_order_relaxed);
+        }
+        pool_put(pool, block);
         return;
     }
-    
-    unsigned int tail = atomic_load_explicit(&pool->tail, memory_order_relaxed);
-    unsigned int new_tail;
-    do {
-        new_tail = tail + 1;
-        /* Try to claim the slot at `tail`. If another thread raced us,
-           the CAS fails and we retry with the updated tail value. */
-    } while (!atomic_compare_exchange_weak_explicit(
-        &pool->tail, &tail, new_tail,
-        memory_order_acq_rel, memory_order_relaxed));
-    
-    /* Now we own the slot — write the block pointer. The release in the
-       CAS above ensures this store is ordered before any subsequent
-       load of tail from a consumer. */
-    pool->blocks[tail % POOL_MAX_BLOCKS] = block;
+    magazine_t* m = &cache->mags[pool->cls];
+    if (m->n == pool->mag_cap) {
+        // Full: spill the oldest batch to the shared pool
+        atomic_fetch_add_explicit(&pool->spills, 1, memory_order_relaxed);
+        for (unsigned i = 0; i < pool->mag_batch; i++) pool_put(pool, m->blocks[i]);
+        memmove(m->blocks, m->blocks + pool->mag_batch, (m->n - pool->mag_batch) * sizeof(void*));
+        m->n -= pool->mag_batch;
+    }
+    m->blocks[m->n++] = block;
 }
 
 /*
  * Public API
  */
 
-int mev_pools_init(void) {
+void mev_pools_default_config(mev_pools_config_t* cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->n_classes = sizeof(g_default_classes) / sizeof(g_default_classes[0]);
+    memcpy(cfg->classes, g_default_classes, sizeof(g_default_classes));
+    cfg->arena_flags = MEV_ARENA_DEFAULT;
+}
+
+/**
+ * Classes must ascend (after rounding to 64 bytes) and have
+ * 0 <= initial <= max, 1 <= max < 2^32 - 1
+ */
+static int config_valid(const mev_pools_config_t* cfg) {
+    if (!cfg || cfg->n_classes == 0 || cfg->n_classes > MEV_POOL_MAX_CLASSES) return 0;
+    size_t prev = 0;
+    for (unsigned c = 0; c < cfg->n_classes; c++) {
+        const mev_size_class_t* cls = &cfg->classes[c];
+        if (cls->block_size == 0 || round_block(cls->block_size) <= prev) return 0;
+        if (cls->max == 0 || cls->max == POOL_NIL || cls->initial > cls->max) return 0;
+        prev = round_block(cls->block_size);
+    }
+    return 1;
+}
+
+int mev_pools_init_ex(const mev_pools_config_t* cfg) {
+    if (!config_valid(cfg)) return -1;
     if (g_pools_initialized) return 0;
-    
-    if (pool_init(&g_tx_pool, 512, 256) != 0) return -1;       // 256 tx buffers
-    if (pool_init(&g_calldata_pool, 2048, 128) != 0) return -1; // 128 calldata buffers
-    if (pool_init(&g_result_pool, 256, 512) != 0) return -1;    // 512 result buffers
-    
+
+    unsigned nodes = cfg->nodes ? cfg->nodes : (unsigned)mev_numa_node_count();
+    if (nodes > MEV_POOL_MAX_NODES) nodes = MEV_POOL_MAX_NODES;
+    if (nodes == 0) nodes = 1;
+
+    // Reserve every slab at its maximum, per node; only initial blocks are
+    // committed.  Each node's span starts and ends on a huge page.
+    size_t per_node = 2 * POOL_NODE_ALIGN;
+    for (unsigned c = 0; c < cfg->n_classes; c++) {
+        per_node += slab_bytes(cfg->classes[c].block_size, cfg->classes[c].max) + POOL_GRANULE;
+        per_node += cfg->classes[c].max * sizeof(uint32_t) + 64;
+    }
+    g_arena = mev_arena_create(per_node * nodes, cfg->arena_flags & MEV_ARENA_HUGE);
+    if (!g_arena) return -1;
+
+    mev_arena_info_t info;
+    mev_arena_info(g_arena, &info);
+    g_granule_class = (uint8_t*)malloc((info.size >> POOL_GRANULE_SHIFT) + 1);
+    if (!g_granule_class) return -1;
+    memset(g_granule_class, POOL_NO_CLASS, (info.size >> POOL_GRANULE_SHIFT) + 1);
+    g_arena_base = (uintptr_t)info.base;
+    g_n_classes = cfg->n_classes;
+    g_n_nodes = nodes;
+
+    for (unsigned n = 0; n < nodes; n++) {
+        // The node's span: carve, bind, then fault the initial blocks in
+        uint8_t* span = NULL;
+        for (unsigned c = 0; c < cfg->n_classes; c++) {
+            mev_memory_pool_t* pool = node_pool(n, c);
+            if (pool_init(pool, n, c, &cfg->classes[c], c == 0 ? POOL_NODE_ALIGN : POOL_GRANULE) != 0) return -1;
+            if (c == 0) span = pool->slab;
+        }
+        if (nodes > 1) {
+            // Pad the span to a huge page so the bind never splits one with
+            // the next node's span (hugetlb mbind would refuse)
+            mev_arena_info(g_arena, &info);
+            uint8_t* end = (uint8_t*)info.base + ((info.used + 7) & ~(size_t)7);   // carves are 8-aligned
+            const size_t pad = (size_t)(-(uintptr_t)end & (POOL_NODE_ALIGN - 1));
+            if (pad) mev_arena_carve(g_arena, pad, 8, NULL);
+            // Best effort: a logical node beyond the machine's stays unbound
+            // (counted in the arena's bind_failures)
+            mev_arena_bind(g_arena, span, (size_t)(end + pad - span), (int)n);
+        }
+        for (unsigned c = 0; c < cfg->n_classes; c++) {
+            mev_memory_pool_t* pool = node_pool(n, c);
+            mev_arena_commit(g_arena, pool->slab, pool->block_size * cfg->classes[c].initial, cfg->arena_flags);
+        }
+    }
+    g_arena_size = info.size;   // from here on, frees resolve by address
+
+    g_tx_class = class_for_size(512);
+    g_calldata_class = class_for_size(2048);
+    g_result_class = class_for_size(256);
+
     g_pools_initialized = 1;
     return 0;
 }
 
+int mev_pools_init_arena(unsigned flags) {
+    mev_pools_config_t cfg;
+    mev_pools_default_config(&cfg);
+    cfg.arena_flags = flags;
+    return mev_pools_init_ex(&cfg);
+}
+
+int mev_pools_init(void) {
+    return mev_pools_init_arena(MEV_ARENA_DEFAULT);
+}
+
+/**
+ * Arena layout (one region per class slab) and pre-fault counts, -1
+ * before init
+ */
+int mev_pools_arena_info(mev_arena_info_t* out) {
+    if (!g_arena) return -1;
+    mev_arena_info(g_arena, out);
+    return 0;
+}
+
+/**
+ * Allocate from the smallest class that fits; above the largest class the
+ * block is malloc'd with a header (counted as oversize)
+ */
+void* mev_alloc(size_t size) {
+    int cls = class_for_size(size);
+    if (cls >= 0) return mag_get((unsigned)cls);
+
+    void* block = heap_block(POOL_OVERSIZE, size);
+    if (block) {
+        atomic_fetch_add_explicit(&g_oversize_allocs, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&g_oversize_live, 1, memory_order_relaxed);
+    }
+    return block;
+}
+
+/**
+ * Free any block from mev_alloc / mev_alloc_*: slab blocks by address,
+ * everything else by its header
+ */
+void mev_free(void* ptr) {
+    if (!ptr) return;
+    mev_memory_pool_t* pool = pool_of(ptr);
+    if (pool) {
+        mag_put(pool, ptr);
+        return;
+    }
+
+    pool_hdr_t* hdr = (pool_hdr_t*)((uint8_t*)ptr - POOL_HDR);
+    if (hdr->magic != POOL_HDR_MAGIC) return;   // not ours: leave it alone
+    hdr->magic = 0;
+    if (hdr->cls == POOL_OVERSIZE) {
+        atomic_fetch_sub_explicit(&g_oversize_live, 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_sub_explicit(&g_pools[hdr->cls].fallback_live, 1, memory_order_relaxed);
+    }
+    aligned_free(hdr);
+}
+
 void* mev_alloc_tx(void) {
-    return pool_get(&g_tx_pool);
+    return g_tx_class >= 0 ? mag_get((unsigned)g_tx_class) : mev_alloc(512);
 }
 
 void mev_free_tx(void* ptr) {
-    pool_put(&g_tx_pool, ptr);
+    mev_free(ptr);
 }
 
 void* mev_alloc_calldata(void) {
-    return pool_get(&g_calldata_pool);
+    return g_calldata_class >= 0 ? mag_get((unsigned)g_calldata_class) : mev_alloc(2048);
 }
 
 void mev_free_calldata(void* ptr) {
-    pool_put(&g_calldata_pool, ptr);
+    mev_free(ptr);
 }
 
 void* mev_alloc_result(void) {
-    return pool_get(&g_result_pool);
+    return g_result_class >= 0 ? mag_get((unsigned)g_result_class) : mev_alloc(256);
 }
 
 void mev_free_result(void* ptr) {
-    pool_put(&g_result_pool, ptr);
+    mev_free(ptr);
 }
 
 /**
  * Batch allocate for parallel processing
  */
 int mev_alloc_batch(void** ptrs, size_t count, size_t size) {
-    mev_memory_pool_t* pool;
-    
-    if (size <= 256) pool = &g_result_pool;
-    else if (size <= 512) pool = &g_tx_pool;
-    else pool = &g_calldata_pool;
-    
     for (size_t i = 0; i < count; i++) {
-        ptrs[i] = pool_get(pool);
+        ptrs[i] = mev_alloc(size);
         if (!ptrs[i]) {
             // Rollback
             for (size_t j = 0; j < i; j++) {
-                pool_put(pool, ptrs[j]);
+                mev_free(ptrs[j]);
             }
             return -1;
         }
     }
-    
+
     return 0;
 }
 
 void mev_free_batch(void** ptrs, size_t count, size_t size) {
-    mev_memory_pool_t* pool;
-    
-    if (size <= 256) pool = &g_result_pool;
-    else if (size <= 512) pool = &g_tx_pool;
-    else pool = &g_calldata_pool;
-    
+    (void)size;   // each block's class is found from its address / header
     for (size_t i = 0; i < count; i++) {
-        pool_put(pool, ptrs[i]);
+        mev_free(ptrs[i]);
     }
 }
 
+/**
+ * Exact slab accounting and malloc fallbacks, one node's copy of a class
+ */
+static void pool_usage_add(mev_memory_pool_t* pool, mev_pool_usage_t* out) {
+    out->block_size = pool->block_size;
+    out->blocks += atomic_load(&pool->n_carved);
+    out->free += atomic_load(&pool->n_free);
+    out->fallback_allocs += atomic_load(&pool->fallback_allocs);
+    out->fallback_live += atomic_load(&pool->fallback_live);
+    out->max_blocks += pool->max_blocks;
+}
+
+/**
+ * A class summed over every node
+ */
+static void class_usage(int cls, mev_pool_usage_t* out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (cls < 0 || (unsigned)cls >= g_n_classes) return;
+    for (unsigned n = 0; n < g_n_nodes; n++) pool_usage_add(node_pool(n, (unsigned)cls), out);
+}
+
+/**
+ * Shared-pool traffic: failed CAS attempts, magazine refills / spills and
+ * cross-node frees
+ */
+static void pool_contention_add(mev_memory_pool_t* pool, mev_pool_contention_t* out) {
+    out->cas_retries += atomic_load(&pool->cas_retries);
+    out->refills += atomic_load(&pool->refills);
+    out->spills += atomic_load(&pool->spills);
+    out->remote_frees += atomic_load(&pool->remote_frees);
+}
+
+static void class_contention(int cls, mev_pool_contention_t* out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (cls < 0 || (unsigned)cls >= g_n_classes) return;
+    for (unsigned n = 0; n < g_n_nodes; n++) pool_contention_add(node_pool(n, (unsigned)cls), out);
+}
+
 /**
  * Get pool stats for monitoring
  */
 void mev_pool_stats(size_t* tx_avail, size_t* calldata_avail, size_t* result_avail) {
-    *tx_avail = atomic_load(&g_tx_pool.tail) - atomic_load(&g_tx_pool.head);
-    *calldata_avail = atomic_load(&g_calldata_pool.tail) - atomic_load(&g_calldata_pool.head);
-    *result_avail = atomic_load(&g_result_pool.tail) - atomic_load(&g_result_pool.head);
+    mev_pool_usage_t u;
+    class_usage(g_tx_class, &u);
+    *tx_avail = u.free;
+    class_usage(g_calldata_class, &u);
+    *calldata_avail = u.free;
+    class_usage(g_result_class, &u);
+    *result_avail = u.free;
+}
+
+void mev_pool_usage(mev_pool_usage_t* tx, mev_pool_usage_t* calldata, mev_pool_usage_t* result) {
+    class_usage(g_tx_class, tx);
+    class_usage(g_calldata_class, calldata);
+    class_usage(g_result_class, result);
+}
+
+void mev_pool_contention(mev_pool_contention_t* tx, mev_pool_contention_t* calldata,
+                         mev_pool_contention_t* result) {
+    class_contention(g_tx_class, tx);
+    class_contention(g_calldata_class, calldata);
+    class_contention(g_result_class, result);
+}
+
+unsigned mev_pools_class_count(void) {
+    return g_n_classes;
+}
+
+int mev_pool_class_usage(unsigned cls, mev_pool_usage_t* out) {
+    if (cls >= g_n_classes) return -1;
+    class_usage((int)cls, out);
+    return 0;
+}
+
+int mev_pool_class_contention(unsigned cls, mev_pool_contention_t* out) {
+    if (cls >= g_n_classes) return -1;
+    class_contention((int)cls, out);
+    return 0;
+}
+
+unsigned mev_pools_node_count(void) {
+    return g_n_nodes;
+}
+
+int mev_pool_node_usage(unsigned node, unsigned cls, mev_pool_usage_t* out) {
+    if (node >= g_n_nodes || cls >= g_n_classes || !out) return -1;
+    memset(out, 0, sizeof(*out));
+    pool_usage_add(node_pool(node, cls), out);
+    return 0;
+}
+
+int mev_pool_node_contention(unsigned node, unsigned cls, mev_pool_contention_t* out) {
+    if (node >= g_n_nodes || cls >= g_n_classes || !out) return -1;
+    memset(out, 0, sizeof(*out));
+    pool_contention_add(node_pool(node, cls), out);
+    return 0;
+}
+
+/**
+ * Pin the calling thread's allocations to `node`, or follow the CPU it
+ * runs on again with -1.  Its cached blocks go back to their node first.
+ */
+int mev_pools_set_thread_node(int node) {
+    if (node >= (int)g_n_nodes) return -1;
+    if (tls_cache) thread_cache_flush(tls_cache);
+    tls_node_pinned = node >= 0;
+    tls_node = node >= 0 ? node : (int)current_node();
+    if (tls_cache) tls_cache->node = (unsigned)tls_node;
+    return 0;
+}
+
+int mev_pools_thread_node(void) {
+    return (int)thread_node();
+}
+
+void mev_pools_oversize(size_t* allocs, size_t* live) {
+    if (allocs) *allocs = atomic_load(&g_oversize_allocs);
+    if (live) *live = atomic_load(&g_oversize_live);
+}
+
+/**
+ * Turn per-thread magazines on or off (default on).  Threads that already
+ * have magazines keep using them; meant for benchmarks and debugging.
+ */
+void mev_pools_set_magazines(int enabled) {
+    atomic_store(&g_magazines_enabled, enabled != 0);
+}
+
+/**
+ * Return the calling thread's cached blocks to the shared pools
+ */
+void mev_pools_flush_thread(void) {
+    if (tls_cache) thread_cache_flush(tls_cache);
 }
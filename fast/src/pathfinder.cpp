@@ -5,4 +5,5 @@
 //
 // Compile flag required: -std=c++20 (GCC/Clang) or /std:c++20 (MSVC)
 
+#define PATHFINDER_IMPL
 #include "pathfinder.h"
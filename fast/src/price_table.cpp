@@ -0,0 +1,9 @@
+// price_table.cpp — translation unit for price_table.h
+//
+// This file exists solely to produce a concrete object file for the
+// header-only base-token price table.  All logic lives in price_table.h.
+//
+// Compile flag required: -std=c++20 (GCC/Clang) or /std:c++20 (MSVC)
+
+#define PRICE_TABLE_IMPL
+#include "price_table.h"
@@ -0,0 +1,337 @@
+/**
+ * Profit-Ordered Multi-Queue for the Opportunity Pipeline
+ * Multiple producers (detectors), one or more consumers (executor)
+ *
+ * Layout: n_shards independent sorted arrays, each guarded by a try-lock
+ * and each on its own cache lines.  Arrays are kept worst-first, so the
+ * best entry is the last one and pop is a decrement.  Every shard
+ * publishes the profit of its best and of its worst entry in atomics so
+ * choosing a shard needs no lock.
+ *
+ *   push: reserve one of `capacity` places in a shared count, then lock
+ *         a shard with room, starting from a random one (moving on if the
+ *         try-lock fails or it is full), binary-search the insert position
+ *         and shift the better entries up by one.  Shards are sized so that
+ *         a shard with room always exists while the count is below
+ *         capacity.  Only when the whole queue is full does push shed:
+ *         it samples two shards, locks the one with the lower published
+ *         worst entry and drops that entry (or the newcomer, if it ranks
+ *         no better) — load shedding keeps the most profitable
+ *         opportunities.  Pop releases the place.
+ *   pop:  sample two random shards, lock the one with the better published
+ *         top and take its best entry; if both look empty, sweep all shards.
+ *
+ * This is the "multi-queue" relaxation: consumers get one of the best
+ * entries with high probability rather than the global maximum (and
+ * shedding drops one of the worst rather than the global minimum), in
+ * exchange for no shared lock (the count is one atomic add per push and
+ * pop, on its own line).  Within a shard order is exact:
+ * profit descending, then earlier deadline block first.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "priority_queue.h"
+#include "simd_utils.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#define aligned_alloc(align, size) _aligned_malloc(size, align)
+#define aligned_free(ptr) _aligned_free(ptr)
+#else
+#define aligned_free(ptr) free(ptr)
+#endif
+
+#define PQ_DEFAULT_SHARDS 8
+#define PQ_EMPTY_TOP      INT64_MIN
+#define PQ_EMPTY_LOW      INT64_MAX
+
+typedef struct {
+    int64_t  profit;
+    uint64_t deadline_block;
+    void*    item;
+} pq_entry_t;
+
+typedef struct {
+    alignas(64) atomic_flag lock;
+    atomic_llong  top;          // profit of entries[n - 1], PQ_EMPTY_TOP if empty
+    atomic_llong  low;          // profit of entries[0], PQ_EMPTY_LOW if empty
+    atomic_size_t n;
+    pq_entry_t*   entries;      // sorted worst-first
+    size_t        cap;
+} pq_shard_t;
+
+struct mev_pq_t {
+    pq_shard_t* shards;
+    size_t n_shards;
+    size_t capacity;
+    alignas(64) atomic_size_t count;    // entries stored or reserved, <= capacity
+    alignas(64) atomic_uint_fast64_t dropped;
+};
+
+static inline uint32_t pq_rand(void) {
+    static _Thread_local uint64_t s;
+    if (s == 0) s = (uint64_t)(uintptr_t)&s | 1;   // distinct per thread
+    s ^= s << 13;
+    s ^= s >> 7;
+    s ^= s << 17;
+    return (uint32_t)(s >> 32);
+}
+
+/* a ranks before b */
+static inline int pq_better(int64_t pa, uint64_t da, int64_t pb, uint64_t db) {
+    return pa > pb || (pa == pb && da < db);
+}
+
+/**
+ * Create a new queue
+ */
+mev_pq_t* mev_pq_create(size_t capacity, size_t n_shards) {
+    if (n_shards == 0) n_shards = PQ_DEFAULT_SHARDS;
+    if (capacity < n_shards) capacity = n_shards;
+
+    mev_pq_t* q = (mev_pq_t*)aligned_alloc(64, sizeof(mev_pq_t));
+    if (!q) return NULL;
+    q->shards = (pq_shard_t*)aligned_alloc(64, n_shards * sizeof(pq_shard_t));
+    if (!q->shards) {
+        aligned_free(q);
+        return NULL;
+    }
+    q->n_shards = n_shards;
+    q->capacity = capacity;
+    atomic_store(&q->count, 0);
+    atomic_store(&q->dropped, 0);
+
+    const size_t per_shard = (capacity + n_shards - 1) / n_shards;
+    for (size_t i = 0; i < n_shards; i++) {
+        pq_shard_t* s = &q->shards[i];
+        atomic_flag_clear(&s->lock);
+        atomic_store(&s->top, PQ_EMPTY_TOP);
+        atomic_store(&s->low, PQ_EMPTY_LOW);
+        atomic_store(&s->n, 0);
+        s->cap = per_shard;
+        s->entries = (pq_entry_t*)calloc(per_shard, sizeof(pq_entry_t));
+        if (!s->entries) {
+            while (i--) free(q->shards[i].entries);
+            aligned_free(q->shards);
+            aligned_free(q);
+            return NULL;
+        }
+    }
+    return q;
+}
+
+/**
+ * Destroy queue (items still queued are not freed)
+ */
+void mev_pq_destroy(mev_pq_t* q) {
+    if (q) {
+        for (size_t i = 0; i < q->n_shards; i++) free(q->shards[i].entries);
+        aligned_free(q->shards);
+        aligned_free(q);
+    }
+}
+
+static inline int pq_try_lock(pq_shard_t* s) {
+    return !atomic_flag_test_and_set_explicit(&s->lock, memory_order_acquire);
+}
+
+static inline void pq_unlock(pq_shard_t* s) {
+    atomic_flag_clear_explicit(&s->lock, memory_order_release);
+}
+
+static inline void pq_publish(pq_shard_t* s, size_t n) {
+    atomic_store_explicit(&s->n, n, memory_order_relaxed);
+    atomic_store_explicit(&s->low, n ? s->entries[0].profit : PQ_EMPTY_LOW,
+                          memory_order_relaxed);
+    atomic_store_explicit(&s->top, n ? s->entries[n - 1].profit : PQ_EMPTY_TOP,
+                          memory_order_release);
+}
+
+/* Take one place below capacity; 0 if the queue is full */
+static inline int pq_reserve(mev_pq_t* q) {
+    size_t c = atomic_load_explicit(&q->count, memory_order_relaxed);
+    while (c < q->capacity) {
+        if (atomic_compare_exchange_weak_explicit(&q->count, &c, c + 1,
+                                                  memory_order_relaxed, memory_order_relaxed))
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Lock a shard with room (`room`), or a non-empty one, starting from a
+ * random shard.  A place is reserved whenever room is asked for, so one
+ * turns up; NULL only if a full sweep found every shard empty.
+ */
+static pq_shard_t* pq_lock_shard(mev_pq_t* q, int room) {
+    size_t i = pq_rand() % q->n_shards;
+    unsigned candidates = 0;
+    for (unsigned spins = 1;; i = (i + 1) % q->n_shards, spins++) {
+        pq_shard_t* s = &q->shards[i];
+        size_t n = atomic_load_explicit(&s->n, memory_order_relaxed);
+        if (room ? n < s->cap : n > 0) {
+            candidates++;
+            if (pq_try_lock(s)) {
+                n = atomic_load_explicit(&s->n, memory_order_relaxed);
+                if (room ? n < s->cap : n > 0) return s;
+                pq_unlock(s);
+            }
+        }
+        if (spins % q->n_shards == 0) {
+            if (!room && candidates == 0) return NULL;
+            candidates = 0;
+            mev_cpu_pause();
+        }
+    }
+}
+
+/*
+ * Queue full: lock the shard whose worst entry looks lower of two sampled
+ * ones (as pop picks the better top), else any non-empty shard.  Sets
+ * *outranked and returns NULL without locking when `profit` is below both
+ * published worst entries — the newcomer is shed on that (possibly stale)
+ * reading, which keeps the common full-queue push off the shard locks.
+ */
+static pq_shard_t* pq_lock_victim(mev_pq_t* q, int64_t profit, int* outranked) {
+    for (int attempt = 0; attempt < 4; attempt++) {
+        pq_shard_t* a = &q->shards[pq_rand() % q->n_shards];
+        pq_shard_t* b = &q->shards[pq_rand() % q->n_shards];
+        int64_t la = atomic_load_explicit(&a->low, memory_order_relaxed);
+        int64_t lb = atomic_load_explicit(&b->low, memory_order_relaxed);
+        pq_shard_t* s = lb < la ? b : a;
+        int64_t low = lb < la ? lb : la;
+        if (low == PQ_EMPTY_LOW) continue;
+        if (profit < low) {
+            *outranked = 1;
+            return NULL;
+        }
+        if (!pq_try_lock(s)) continue;
+        if (atomic_load_explicit(&s->n, memory_order_relaxed) > 0) return s;
+        pq_unlock(s);
+    }
+    return pq_lock_shard(q, 0);
+}
+
+/**
+ * Push an opportunity.  Returns 1 and sets *evicted when something was shed.
+ */
+int mev_pq_push(mev_pq_t* q, int64_t profit, uint64_t deadline_block,
+                void* item, void** evicted) {
+    pq_shard_t* s;
+    int full, outranked = 0;
+    for (;;) {
+        full = !pq_reserve(q);
+        s = full ? pq_lock_victim(q, profit, &outranked) : pq_lock_shard(q, 1);
+        if (s || outranked) break;
+        // Full, yet every shard is empty: pops are draining it, retry
+    }
+
+    size_t n = s ? atomic_load_explicit(&s->n, memory_order_relaxed) : 0;
+    const pq_entry_t* worst = s ? &s->entries[0] : NULL;
+    if (outranked || (full && !pq_better(profit, deadline_block,
+                                         worst->profit, worst->deadline_block))) {
+        // Ranks no better than the worst entry kept there: shed the newcomer
+        if (s) pq_unlock(s);
+        atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+        if (evicted) *evicted = item;
+        return 1;
+    }
+
+    // Entries the newcomer beats come first; it goes before its equals,
+    // which pop sooner from the end (FIFO among equals)
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const pq_entry_t* e = &s->entries[mid];
+        if (pq_better(profit, deadline_block, e->profit, e->deadline_block)) lo = mid + 1;
+        else hi = mid;
+    }
+    const int shed = full;
+    if (shed) {
+        // Drop the worst entry: the ones below the insert point move down
+        if (evicted) *evicted = worst->item;
+        lo--;
+        memmove(&s->entries[0], &s->entries[1], lo * sizeof(pq_entry_t));
+    } else {
+        memmove(&s->entries[lo + 1], &s->entries[lo], (n - lo) * sizeof(pq_entry_t));
+        n++;
+    }
+    s->entries[lo].profit = profit;
+    s->entries[lo].deadline_block = deadline_block;
+    s->entries[lo].item = item;
+
+    pq_publish(s, n);
+    pq_unlock(s);
+
+    if (shed) atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+    return shed;
+}
+
+/* Take the best entry of a locked shard; NULL if it is empty */
+static void* pq_take(mev_pq_t* q, pq_shard_t* s, int64_t* profit, uint64_t* deadline_block, int* got) {
+    size_t n = atomic_load_explicit(&s->n, memory_order_relaxed);
+    if (n == 0) { *got = 0; return NULL; }
+    pq_entry_t e = s->entries[n - 1];
+    pq_publish(s, n - 1);
+    atomic_fetch_sub_explicit(&q->count, 1, memory_order_relaxed);
+    if (profit) *profit = e.profit;
+    if (deadline_block) *deadline_block = e.deadline_block;
+    *got = 1;
+    return e.item;
+}
+
+/**
+ * Pop the best of two randomly sampled shards; sweep all if both are empty.
+ */
+void* mev_pq_pop(mev_pq_t* q, int64_t* profit, uint64_t* deadline_block) {
+    int got = 0;
+    void* item;
+
+    for (int attempt = 0; attempt < 4; attempt++) {
+        pq_shard_t* a = &q->shards[pq_rand() % q->n_shards];
+        pq_shard_t* b = &q->shards[pq_rand() % q->n_shards];
+        int64_t ta = atomic_load_explicit(&a->top, memory_order_acquire);
+        int64_t tb = atomic_load_explicit(&b->top, memory_order_acquire);
+        pq_shard_t* s = tb > ta ? b : a;
+        if ((tb > ta ? tb : ta) == PQ_EMPTY_TOP && atomic_load_explicit(&s->n, memory_order_relaxed) == 0)
+            break;
+        if (!pq_try_lock(s)) continue;
+        item = pq_take(q, s, profit, deadline_block, &got);
+        pq_unlock(s);
+        if (got) return item;
+    }
+
+    // Sparse queue: find any non-empty shard
+    for (size_t i = 0; i < q->n_shards; i++) {
+        pq_shard_t* s = &q->shards[i];
+        if (atomic_load_explicit(&s->n, memory_order_relaxed) == 0) continue;
+        while (!pq_try_lock(s)) mev_cpu_pause();
+        item = pq_take(q, s, profit, deadline_block, &got);
+        pq_unlock(s);
+        if (got) return item;
+    }
+    return NULL;
+}
+
+/**
+ * Get queue size (approximate snapshot)
+ */
+size_t mev_pq_size(mev_pq_t* q) {
+    size_t total = 0;
+    for (size_t i = 0; i < q->n_shards; i++)
+        total += atomic_load_explicit(&q->shards[i].n, memory_order_relaxed);
+    return total;
+}
+
+/**
+ * Opportunities shed by overflow since creation
+ */
+uint64_t mev_pq_dropped(mev_pq_t* q) {
+    return atomic_load_explicit(&q->dropped, memory_order_relaxed);
+}
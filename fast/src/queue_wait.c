@@ -0,0 +1,173 @@
+/**
+ * Adaptive Blocking Wait for Queue Consumers
+ * spin (pause) → yield → park on a futex
+ *
+ * The wait object is an eventcount: a 32-bit futex word `seq` plus a count
+ * of parked consumers.  Producers only touch `seq` (and enter the kernel)
+ * when `waiters` is non-zero, so an unwatched queue pays one fence and one
+ * load per notify.
+ *
+ * Lost-wakeup freedom (Dekker pattern, both sides seq_cst):
+ *   consumer: waiters++ ; v = seq ; re-check queue ; futex_wait(seq, v)
+ *   producer: publish item ; fence ; if (waiters) { seq++ ; futex_wake }
+ * Either the producer sees the registered waiter and bumps `seq` (so the
+ * futex_wait returns at once if it has not slept yet), or the consumer's
+ * re-check sees the item.
+ *
+ * Non-Linux builds park with a short nanosleep instead of a futex.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sched.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "queue_wait.h"
+#include "simd_utils.h"
+
+#define WAIT_SPINS   256  // pause iterations before yielding (~ a few µs)
+#define WAIT_YIELDS  16   // sched_yield rounds before parking
+#define WAIT_POLL_NS 50000  // park granularity without futexes
+
+struct mev_wait_t {
+    atomic_uint seq;                   // futex word, bumped by notify
+    atomic_uint waiters;               // consumers between register and wake
+    atomic_uint_fast64_t wakes;
+    atomic_uint_fast64_t parks;
+};
+
+mev_wait_t* mev_wait_create(void) {
+    mev_wait_t* w = (mev_wait_t*)calloc(1, sizeof(mev_wait_t));
+    if (!w) return NULL;
+    atomic_store(&w->seq, 0);
+    atomic_store(&w->waiters, 0);
+    atomic_store(&w->wakes, 0);
+    atomic_store(&w->parks, 0);
+    return w;
+}
+
+void mev_wait_destroy(mev_wait_t* w) {
+    free(w);
+}
+
+static uint64_t wait_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Sleep until `seq` moves away from `v` or `ns` elapse (ns < 0: no limit). */
+static void wait_park(mev_wait_t* w, unsigned v, int64_t ns) {
+#ifdef __linux__
+    struct timespec ts, *tsp = NULL;
+    if (ns >= 0) {
+        ts.tv_sec  = ns / 1000000000LL;
+        ts.tv_nsec = ns % 1000000000LL;
+        tsp = &ts;
+    }
+    syscall(SYS_futex, &w->seq, FUTEX_WAIT_PRIVATE, v, tsp, NULL, 0);
+#else
+    (void)v;
+    struct timespec ts = { 0, (ns >= 0 && ns < WAIT_POLL_NS) ? ns : WAIT_POLL_NS };
+    nanosleep(&ts, NULL);
+#endif
+}
+
+/**
+ * Wake every parked consumer.  Call after a successful push.
+ */
+void mev_wait_notify(mev_wait_t* w) {
+    // Order the caller's publish before the waiters load (pairs with the
+    // seq_cst increment in wait_for)
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&w->waiters, memory_order_relaxed) == 0) return;
+
+    atomic_fetch_add_explicit(&w->seq, 1, memory_order_seq_cst);
+    atomic_fetch_add_explicit(&w->wakes, 1, memory_order_relaxed);
+#ifdef __linux__
+    syscall(SYS_futex, &w->seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+typedef void* (*try_pop_fn)(void* q);
+
+static void* try_pop_mpmc(void* q) { return mev_queue_pop((mev_queue_t*)q); }
+static void* try_pop_spsc(void* q) { return mev_spsc_pop((mev_spsc_t*)q); }
+
+/**
+ * Shared backoff loop.  NULL items are indistinguishable from "empty", as
+ * with the non-blocking pops.
+ */
+static void* wait_for(void* q, try_pop_fn try_pop, mev_wait_t* w, int64_t timeout_ns) {
+    void* item = try_pop(q);
+    if (item || timeout_ns == 0) return item;
+
+    const uint64_t deadline = timeout_ns > 0 ? wait_now_ns() + (uint64_t)timeout_ns : 0;
+
+    // 1. Spin: cheapest wake-up, burns the core for a few microseconds
+    for (int i = 0; i < WAIT_SPINS; i++) {
+        mev_cpu_pause();
+        if ((item = try_pop(q))) return item;
+    }
+
+    // 2. Yield: lets a producer on the same core run
+    for (int i = 0; i < WAIT_YIELDS; i++) {
+        sched_yield();
+        if ((item = try_pop(q))) return item;
+        if (deadline && wait_now_ns() >= deadline) return NULL;
+    }
+
+    // 3. Park until notified
+    for (;;) {
+        atomic_fetch_add_explicit(&w->waiters, 1, memory_order_seq_cst);
+        unsigned v = atomic_load_explicit(&w->seq, memory_order_seq_cst);
+        item = try_pop(q);
+        if (item) {
+            atomic_fetch_sub_explicit(&w->waiters, 1, memory_order_relaxed);
+            return item;
+        }
+
+        int64_t remaining = -1;
+        if (deadline) {
+            uint64_t now = wait_now_ns();
+            if (now >= deadline) {
+                atomic_fetch_sub_explicit(&w->waiters, 1, memory_order_relaxed);
+                return NULL;
+            }
+            remaining = (int64_t)(deadline - now);
+        }
+        atomic_fetch_add_explicit(&w->parks, 1, memory_order_relaxed);
+        wait_park(w, v, remaining);
+        atomic_fetch_sub_explicit(&w->waiters, 1, memory_order_relaxed);
+
+        if ((item = try_pop(q))) return item;
+    }
+}
+
+/**
+ * Pop from an MPMC queue, blocking up to timeout_ns (< 0: forever).
+ */
+void* mev_queue_pop_wait(mev_queue_t* q, mev_wait_t* w, int64_t timeout_ns) {
+    return wait_for(q, try_pop_mpmc, w, timeout_ns);
+}
+
+/**
+ * Pop from an SPSC ring (consumer thread only), blocking up to timeout_ns.
+ */
+void* mev_spsc_pop_wait(mev_spsc_t* q, mev_wait_t* w, int64_t timeout_ns) {
+    return wait_for(q, try_pop_spsc, w, timeout_ns);
+}
+
+void mev_wait_stats(mev_wait_t* w, uint64_t* wakes, uint64_t* parks) {
+    if (wakes) *wakes = atomic_load_explicit(&w->wakes, memory_order_relaxed);
+    if (parks) *parks = atomic_load_explicit(&w->parks, memory_order_relaxed);
+}
@@ -0,0 +1,228 @@
+/**
+ * Inline Fixed-Size Record Queue
+ * Multiple producers / multiple consumers, payload stored in the slot
+ *
+ * Same Vyukov per-slot sequence protocol as lockfree_queue.c, but each slot
+ * carries a `record_size`-byte payload right after its sequence word, and
+ * the claim / publish halves of push and pop are exposed separately so the
+ * record is written and read in place:
+ *
+ *   producer: p = claim(&t); fill *p; commit(t)    (sequence = t + 1)
+ *   consumer: p = acquire(&t); read *p; release(t) (sequence = t + capacity)
+ *
+ * Between claim and commit (acquire and release) the slot belongs to the
+ * caller alone; other producers / consumers move on to later tickets.  A
+ * slow committer only holds back consumers of its own slot.
+ *
+ * Each slot is its sequence word alone on one cache line followed by the
+ * record padded to whole cache lines, and the ring is 64-byte aligned: no
+ * two slots share a line and every record starts 64-byte aligned, so
+ * records may hold over-aligned (SIMD, atomic) fields.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "record_queue.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#define aligned_alloc(align, size) _aligned_malloc(size, align)
+#define aligned_free(ptr) _aligned_free(ptr)
+#else
+#define aligned_free(ptr) free(ptr)
+#endif
+
+#define RECQ_HEADER 64  // cache line holding the sequence word ahead of the record
+
+typedef struct {
+    atomic_size_t sequence;
+    // record_size bytes follow
+} recq_slot_t;
+
+struct mev_recq_t {
+    uint8_t* slots;
+    size_t capacity;
+    size_t mask;
+    size_t stride;       // bytes per slot: RECQ_HEADER + record, multiple of 64
+    size_t record_size;
+
+    alignas(64) atomic_size_t head;  // Consumer cursor
+    alignas(64) atomic_size_t tail;  // Producer cursor
+};
+
+static inline recq_slot_t* recq_slot(mev_recq_t* q, size_t pos) {
+    return (recq_slot_t*)(q->slots + (pos & q->mask) * q->stride);
+}
+
+static inline void* recq_record(recq_slot_t* slot) {
+    return (uint8_t*)slot + RECQ_HEADER;
+}
+
+/**
+ * Create a new queue
+ */
+mev_recq_t* mev_recq_create(size_t capacity, size_t record_size) {
+    if (record_size == 0 || record_size > SIZE_MAX - RECQ_HEADER - 63) return NULL;
+    if (capacity > (SIZE_MAX >> 1) + 1) return NULL;
+    if (capacity < 2) capacity = 2;
+    if (capacity & (capacity - 1)) {
+        // Not power of 2, round up
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        capacity = n;
+    }
+
+    const size_t stride = RECQ_HEADER + ((record_size + 63) & ~(size_t)63);
+    if (capacity > SIZE_MAX / stride) return NULL;  // ring size overflows
+
+    mev_recq_t* q = (mev_recq_t*)aligned_alloc(64, sizeof(mev_recq_t));
+    if (!q) return NULL;
+
+    q->stride = stride;
+    q->slots = (uint8_t*)aligned_alloc(64, capacity * q->stride);
+    if (!q->slots) {
+        aligned_free(q);
+        return NULL;
+    }
+    memset(q->slots, 0, capacity * q->stride);
+
+    q->capacity = capacity;
+    q->mask = capacity - 1;
+    q->record_size = record_size;
+    atomic_store(&q->head, 0);
+    atomic_store(&q->tail, 0);
+
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_store_explicit(&recq_slot(q, i)->sequence, i, memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_release);
+
+    return q;
+}
+
+/**
+ * Destroy queue
+ */
+void mev_recq_destroy(mev_recq_t* q) {
+    if (q) {
+        aligned_free(q->slots);
+        aligned_free(q);
+    }
+}
+
+/**
+ * Claim the next free slot (multi-producer safe, lock-free).
+ * Returns the record to fill, or NULL if full.  Must be followed by
+ * mev_recq_commit(ticket).
+ */
+void* mev_recq_claim(mev_recq_t* q, size_t* ticket) {
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    for (;;) {
+        recq_slot_t* slot = recq_slot(q, pos);
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &q->tail, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                *ticket = pos;
+                return recq_record(slot);
+            }
+        } else if (diff < 0) {
+            return NULL; // Full
+        } else {
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * Publish a claimed slot to consumers.
+ */
+void mev_recq_commit(mev_recq_t* q, size_t ticket) {
+    atomic_store_explicit(&recq_slot(q, ticket)->sequence, ticket + 1, memory_order_release);
+}
+
+/**
+ * Take the oldest committed record (multi-consumer safe, lock-free).
+ * Returns the record to read, or NULL if empty.  Must be followed by
+ * mev_recq_release(ticket).
+ */
+const void* mev_recq_acquire(mev_recq_t* q, size_t* ticket) {
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    for (;;) {
+        recq_slot_t* slot = recq_slot(q, pos);
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &q->head, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                *ticket = pos;
+                return recq_record(slot);
+            }
+        } else if (diff < 0) {
+            return NULL; // Empty
+        } else {
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * Hand an acquired slot back to producers for the next lap.
+ */
+void mev_recq_release(mev_recq_t* q, size_t ticket) {
+    atomic_store_explicit(&recq_slot(q, ticket)->sequence, ticket + q->capacity,
+                          memory_order_release);
+}
+
+/**
+ * Copy `record` (record_size bytes) in.  Returns 0 on success, -1 if full.
+ */
+int mev_recq_push(mev_recq_t* q, const void* record) {
+    size_t ticket;
+    void* dst = mev_recq_claim(q, &ticket);
+    if (!dst) return -1;
+    memcpy(dst, record, q->record_size);
+    mev_recq_commit(q, ticket);
+    return 0;
+}
+
+/**
+ * Copy the oldest record out.  Returns 0 on success, -1 if empty.
+ */
+int mev_recq_pop(mev_recq_t* q, void* record) {
+    size_t ticket;
+    const void* src = mev_recq_acquire(q, &ticket);
+    if (!src) return -1;
+    memcpy(record, src, q->record_size);
+    mev_recq_release(q, ticket);
+    return 0;
+}
+
+size_t mev_recq_record_size(mev_recq_t* q) {
+    return q->record_size;
+}
+
+/**
+ * Get queue size (approximate snapshot; includes claimed, uncommitted slots)
+ */
+size_t mev_recq_size(mev_recq_t* q) {
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    return tail - head;
+}
+
+int mev_recq_empty(mev_recq_t* q) {
+    return mev_recq_size(q) == 0;
+}
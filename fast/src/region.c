@@ -0,0 +1,242 @@
+/**
+ * Per-Block Region Allocator
+ * Bump allocation for block-lifetime data, released with one reset
+ *
+ * Most hot-path allocations live exactly one block.  Instead of freeing
+ * each of them through the pools, they are bump-allocated from chunks of
+ * a dedicated arena (arena.c: huge pages, pre-faulted, mlocked) and the
+ * whole region is recycled by mev_region_reset at the next block.
+ *
+ * Each thread bumps a pointer through its current chunk with no atomics;
+ * only a full chunk costs a CAS on the shared claim word to take the next
+ * one.  The claim word packs the region generation next to the index of
+ * the next free chunk, so reset is O(1): store (gen + 1) << 32 and publish
+ * gen + 1.  A thread notices the new generation on its next allocation
+ * (one read of a read-mostly line) and drops its stale chunk; a claim
+ * made with a stale generation fails its CAS.  Requests larger than a
+ * chunk claim several adjacent chunks at once.
+ *
+ * Once the arena is exhausted, chunks are malloc'd (overflow) and kept on
+ * a list that the next reset frees — counted, so the arena can be sized
+ * from chunks_high_water / overflow_total.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "region.h"
+#include "arena.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#define aligned_free(ptr) _aligned_free(ptr)
+#else
+#define aligned_free(ptr) free(ptr)
+#endif
+
+#define REGION_ALIGN      16       // mev_region_alloc
+#define REGION_MAX_ALIGN  4096     // chunks start page-aligned
+
+typedef struct region_overflow {
+    struct region_overflow* next;
+    void* mem;                     // aligned block this trailer sits at the end of
+} region_overflow_t;
+
+typedef struct {
+    uintptr_t cur;
+    uintptr_t end;
+    uint32_t gen;                  // generation cur / end belong to
+} region_tls_t;
+
+static mev_arena_t* g_arena;
+static uint8_t* g_base;
+static size_t g_chunk_bytes;
+static uint32_t g_n_chunks;
+static int g_region_initialized = 0;
+
+static alignas(64) _Atomic uint32_t g_gen;          // read on every allocation, written on reset
+static alignas(64) _Atomic uint64_t g_claim;        // gen << 32 | next free chunk
+static _Atomic(region_overflow_t*) g_overflow;      // malloc'd chunks of this generation
+static atomic_size_t g_overflow_epoch;
+static atomic_size_t g_overflow_total;
+static atomic_size_t g_high_water;
+static _Atomic uint64_t g_epoch;
+static _Atomic uint64_t g_resets;
+
+static _Thread_local region_tls_t tls_region;
+
+static inline uintptr_t align_up(uintptr_t p, size_t align) {
+    return (p + align - 1) & ~(uintptr_t)(align - 1);
+}
+
+static void* alloc_aligned(size_t size, size_t alignment) {
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    void* ptr;
+    if (posix_memalign(&ptr, alignment, size) != 0) return NULL;
+    return ptr;
+#endif
+}
+
+/**
+ * Claim `k` adjacent arena chunks for generation `gen` (lock-free).
+ * NULL if the arena is exhausted or a reset moved past `gen`.
+ */
+static uint8_t* region_claim(uint32_t gen, uint32_t k, int* stale) {
+    uint64_t s = atomic_load_explicit(&g_claim, memory_order_relaxed);
+    for (;;) {
+        if ((uint32_t)(s >> 32) != gen) {
+            *stale = 1;
+            return NULL;
+        }
+        uint32_t next = (uint32_t)s;
+        if (k > g_n_chunks - next) return NULL;
+        if (atomic_compare_exchange_weak_explicit(&g_claim, &s, s + k,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            return g_base + (size_t)next * g_chunk_bytes;
+        }
+    }
+}
+
+/**
+ * Arena exhausted: malloc a chunk and keep it for the next reset to free
+ */
+static uint8_t* region_overflow(size_t bytes) {
+    bytes = align_up(bytes, 64);
+    uint8_t* mem = (uint8_t*)alloc_aligned(bytes + sizeof(region_overflow_t), REGION_MAX_ALIGN);
+    if (!mem) return NULL;
+    region_overflow_t* o = (region_overflow_t*)(mem + bytes);
+    o->mem = mem;
+    o->next = atomic_load_explicit(&g_overflow, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&g_overflow, &o->next, o,
+                                                  memory_order_release, memory_order_relaxed)) {
+    }
+    atomic_fetch_add_explicit(&g_overflow_epoch, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_overflow_total, 1, memory_order_relaxed);
+    return mem;
+}
+
+/**
+ * Slow path: the thread's chunk is stale or full, or the request is
+ * larger than a chunk
+ */
+static void* region_refill(region_tls_t* t, size_t size) {
+    if (!g_region_initialized) return NULL;
+
+    for (;;) {
+        const uint32_t gen = atomic_load_explicit(&g_gen, memory_order_acquire);
+        int stale = 0;
+
+        if (size > g_chunk_bytes) {
+            // Whole chunks of its own; the thread keeps its current chunk
+            const uint32_t k = (uint32_t)((size + g_chunk_bytes - 1) / g_chunk_bytes);
+            uint8_t* p = region_claim(gen, k, &stale);
+            if (stale) continue;
+            return p ? p : region_overflow(size);
+        }
+
+        uint8_t* chunk = region_claim(gen, 1, &stale);
+        if (stale) continue;
+        if (!chunk) chunk = region_overflow(g_chunk_bytes);
+        if (!chunk) return NULL;
+
+        // Chunk starts are page-aligned, so the request fits at offset 0
+        t->cur = (uintptr_t)chunk + size;
+        t->end = (uintptr_t)chunk + g_chunk_bytes;
+        t->gen = gen;
+        return chunk;
+    }
+}
+
+void* mev_region_alloc_aligned(size_t size, size_t align) {
+    if (align == 0 || (align & (align - 1)) || align > REGION_MAX_ALIGN) return NULL;
+    region_tls_t* t = &tls_region;
+    if (t->gen == atomic_load_explicit(&g_gen, memory_order_acquire)) {
+        uintptr_t p = align_up(t->cur, align);
+        if (p <= t->end && size <= t->end - p) {
+            t->cur = p + size;
+            return (void*)p;
+        }
+    }
+    return region_refill(t, size);
+}
+
+void* mev_region_alloc(size_t size) {
+    return mev_region_alloc_aligned(size, REGION_ALIGN);
+}
+
+int mev_region_init(size_t bytes, size_t chunk_bytes, unsigned arena_flags) {
+    if (g_region_initialized) return 0;
+    if (bytes == 0) bytes = MEV_REGION_DEFAULT_BYTES;
+    if (chunk_bytes == 0) chunk_bytes = MEV_REGION_DEFAULT_CHUNK;
+    chunk_bytes = align_up(chunk_bytes, REGION_MAX_ALIGN);
+    if (bytes < chunk_bytes) return -1;
+
+    g_arena = mev_arena_create(bytes, arena_flags);
+    if (!g_arena) return -1;
+    g_base = (uint8_t*)mev_arena_carve(g_arena, bytes - bytes % chunk_bytes, REGION_MAX_ALIGN, "region");
+    if (!g_base) return -1;
+
+    g_chunk_bytes = chunk_bytes;
+    g_n_chunks = (uint32_t)(bytes / chunk_bytes);
+    // Generation 1: threads start at 0, so their first allocation refills
+    atomic_store(&g_claim, (uint64_t)1 << 32);
+    atomic_store_explicit(&g_gen, 1, memory_order_release);
+    g_region_initialized = 1;
+    return 0;
+}
+
+/**
+ * Recycle every chunk: O(1) for the arena, plus freeing this generation's
+ * overflow chunks
+ */
+void mev_region_reset(uint64_t epoch) {
+    if (!g_region_initialized) return;
+    const uint32_t gen = atomic_load_explicit(&g_gen, memory_order_relaxed) + 1;
+
+    uint64_t s = atomic_exchange_explicit(&g_claim, (uint64_t)gen << 32, memory_order_relaxed);
+    size_t used = (uint32_t)s;
+    if (used > atomic_load_explicit(&g_high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&g_high_water, used, memory_order_relaxed);
+    }
+    atomic_store_explicit(&g_epoch, epoch, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_resets, 1, memory_order_relaxed);
+    atomic_store_explicit(&g_gen, gen, memory_order_release);
+
+    region_overflow_t* o = atomic_exchange_explicit(&g_overflow, NULL, memory_order_acquire);
+    while (o) {
+        region_overflow_t* next = o->next;
+        aligned_free(o->mem);
+        o = next;
+    }
+    atomic_store_explicit(&g_overflow_epoch, 0, memory_order_relaxed);
+}
+
+uint64_t mev_region_epoch(void) {
+    return atomic_load(&g_epoch);
+}
+
+void mev_region_stats(mev_region_stats_t* out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    out->epoch = atomic_load(&g_epoch);
+    out->resets = atomic_load(&g_resets);
+    out->chunk_bytes = g_chunk_bytes;
+    out->chunks = g_n_chunks;
+    out->chunks_used = (uint32_t)atomic_load(&g_claim);
+    size_t hw = atomic_load(&g_high_water);
+    out->chunks_high_water = out->chunks_used > hw ? out->chunks_used : hw;
+    out->overflow_chunks = atomic_load(&g_overflow_epoch);
+    out->overflow_total = atomic_load(&g_overflow_total);
+}
+
+int mev_region_arena_info(mev_arena_info_t* out) {
+    if (!g_arena) return -1;
+    mev_arena_info(g_arena, out);
+    return 0;
+}
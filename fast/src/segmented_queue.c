@@ -0,0 +1,281 @@
+/**
+ * Unbounded Segmented Queue
+ * Multiple producers (mempool workers), one consumer, grows under bursts
+ *
+ * A linked list of fixed-size segments, each a 2 KB calldata-pool buffer:
+ *
+ *   [enq_idx | next, refs | slot 0 .. slot 239]
+ *
+ * Push is one fetch_add on the tail segment's enq_idx and one release
+ * store of the item into the slot it returns — no CAS loop.  An index past
+ * the end means the segment is full: the first producer to notice links a
+ * fresh segment (from the queue's small cache, else the pool) and swings
+ * `tail`; the others follow.  The consumer walks slots in order, waiting
+ * on a slot that is claimed but not yet written exactly as a Vyukov ring
+ * waits on its sequence word, and moves to `next` after the last slot.
+ *
+ * Recycling: a producer pins the segment it works on (refs) and re-checks
+ * that it is still the tail before claiming a slot.  The consumer retires
+ * a drained segment and only reuses it once refs is back to zero, so a
+ * preempted producer never writes into a segment that has been reset.
+ * A producer may still be between loading `tail` and pinning, though, so
+ * a segment's memory must outlive every such load: drained segments stay
+ * owned by the queue (cached for the next burst, refs never reset) and go
+ * back to the pool only in mev_segq_destroy.  The queue therefore holds
+ * its high-water mark of segments; `max_items` bounds it, and at the
+ * ceiling push fails like a full bounded ring.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "segmented_queue.h"
+#include "memory_pool.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#define aligned_alloc(align, size) _aligned_malloc(size, align)
+#define aligned_free(ptr) _aligned_free(ptr)
+#else
+#define aligned_free(ptr) free(ptr)
+#endif
+
+#define SEGQ_SEGMENT_BYTES 2048   // calldata pool block
+
+typedef struct segq_segment {
+    alignas(64) atomic_size_t enq_idx;           // Producer claim counter
+    alignas(64) _Atomic(struct segq_segment*) next;
+    atomic_size_t refs;                          // Producers pinning this segment
+    struct segq_segment* retired_next;           // Consumer / cache links
+    alignas(64) _Atomic(void*) slots[MEV_SEGQ_SEGMENT_SLOTS];
+} segq_segment_t;
+
+_Static_assert(sizeof(segq_segment_t) <= SEGQ_SEGMENT_BYTES, "segment must fit a calldata block");
+
+struct mev_segq_t {
+    size_t max_segments;                         // 0 = unlimited
+
+    // Segment accounting and cache (slow path, under `lock`)
+    alignas(64) atomic_flag lock;
+    segq_segment_t* cache;
+    size_t n_cached;
+    atomic_size_t n_segments;
+    atomic_size_t high_water;
+    atomic_size_t ceiling_hits;
+
+    alignas(64) _Atomic(segq_segment_t*) tail;   // Producer side
+
+    // Consumer side
+    alignas(64) segq_segment_t* head;
+    size_t deq_idx;
+    segq_segment_t* retired;                     // Drained, maybe still pinned
+};
+
+static inline void segq_lock(mev_segq_t* q) {
+    while (atomic_flag_test_and_set_explicit(&q->lock, memory_order_acquire)) { }
+}
+
+static inline void segq_unlock(mev_segq_t* q) {
+    atomic_flag_clear_explicit(&q->lock, memory_order_release);
+}
+
+static void segq_reset(segq_segment_t* s) {
+    atomic_store_explicit(&s->enq_idx, 0, memory_order_relaxed);
+    atomic_store_explicit(&s->next, NULL, memory_order_relaxed);
+    for (size_t i = 0; i < MEV_SEGQ_SEGMENT_SLOTS; i++) {
+        atomic_store_explicit(&s->slots[i], NULL, memory_order_relaxed);
+    }
+}
+
+/**
+ * A fresh, empty segment — from the cache, else the pool — or NULL at the ceiling
+ */
+static segq_segment_t* segq_segment_get(mev_segq_t* q) {
+    segq_lock(q);
+    segq_segment_t* s = q->cache;
+    if (s) {
+        q->cache = s->retired_next;
+        q->n_cached--;
+        segq_unlock(q);
+    } else {
+        size_t n = atomic_load_explicit(&q->n_segments, memory_order_relaxed);
+        if (q->max_segments && n >= q->max_segments) {
+            segq_unlock(q);
+            atomic_fetch_add_explicit(&q->ceiling_hits, 1, memory_order_relaxed);
+            return NULL;
+        }
+        atomic_store_explicit(&q->n_segments, n + 1, memory_order_relaxed);
+        if (n + 1 > atomic_load_explicit(&q->high_water, memory_order_relaxed)) {
+            atomic_store_explicit(&q->high_water, n + 1, memory_order_relaxed);
+        }
+        segq_unlock(q);
+
+        s = (segq_segment_t*)mev_alloc_calldata();
+        if (!s) {
+            atomic_fetch_sub_explicit(&q->n_segments, 1, memory_order_relaxed);
+            return NULL;
+        }
+        atomic_store_explicit(&s->refs, 0, memory_order_relaxed);
+    }
+    segq_reset(s);
+    return s;
+}
+
+/**
+ * Return an unpinned segment to the cache.  Never to the pool: a producer
+ * that loaded it as `tail` may not have pinned it yet.
+ */
+static void segq_segment_put(mev_segq_t* q, segq_segment_t* s) {
+    segq_lock(q);
+    s->retired_next = q->cache;
+    q->cache = s;
+    q->n_cached++;
+    segq_unlock(q);
+}
+
+/**
+ * Create a new queue
+ */
+mev_segq_t* mev_segq_create(size_t max_items) {
+    if (mev_pools_init() != 0) return NULL;
+
+    mev_segq_t* q = (mev_segq_t*)aligned_alloc(64, sizeof(mev_segq_t));
+    if (!q) return NULL;
+    memset(q, 0, sizeof(*q));
+    atomic_flag_clear(&q->lock);
+
+    if (max_items) {
+        q->max_segments = (max_items + MEV_SEGQ_SEGMENT_SLOTS - 1) / MEV_SEGQ_SEGMENT_SLOTS;
+        if (q->max_segments < 2) q->max_segments = 2;   // room to link past a full tail
+    }
+
+    segq_segment_t* s = segq_segment_get(q);
+    if (!s) {
+        aligned_free(q);
+        return NULL;
+    }
+    atomic_store(&q->tail, s);
+    q->head = s;
+    q->deq_idx = 0;
+    return q;
+}
+
+/**
+ * Destroy queue (queued items are not freed)
+ */
+void mev_segq_destroy(mev_segq_t* q) {
+    if (!q) return;
+    segq_segment_t* s = q->head;
+    while (s) {
+        segq_segment_t* next = atomic_load(&s->next);
+        mev_free_calldata(s);
+        s = next;
+    }
+    for (s = q->retired; s; ) {
+        segq_segment_t* next = s->retired_next;
+        mev_free_calldata(s);
+        s = next;
+    }
+    for (s = q->cache; s; ) {
+        segq_segment_t* next = s->retired_next;
+        mev_free_calldata(s);
+        s = next;
+    }
+    aligned_free(q);
+}
+
+/**
+ * Push an item (any thread).  Fails at the memory ceiling, or for a NULL
+ * item, which pop could not tell from an unwritten slot.
+ */
+int mev_segq_push(mev_segq_t* q, void* item) {
+    if (!item) return -1;
+    for (;;) {
+        segq_segment_t* s = atomic_load(&q->tail);
+        atomic_fetch_add(&s->refs, 1);
+        if (atomic_load(&q->tail) != s) {
+            // Moved on (and possibly recycled) since we read it
+            atomic_fetch_sub_explicit(&s->refs, 1, memory_order_release);
+            continue;
+        }
+
+        size_t i = atomic_fetch_add_explicit(&s->enq_idx, 1, memory_order_relaxed);
+        if (i < MEV_SEGQ_SEGMENT_SLOTS) {
+            atomic_store_explicit(&s->slots[i], item, memory_order_release);
+            atomic_fetch_sub_explicit(&s->refs, 1, memory_order_release);
+            return 0;
+        }
+
+        // Segment full: link a successor if nobody has, then advance tail
+        segq_segment_t* next = atomic_load_explicit(&s->next, memory_order_acquire);
+        if (!next) {
+            segq_segment_t* fresh = segq_segment_get(q);
+            if (!fresh) {
+                atomic_fetch_sub_explicit(&s->refs, 1, memory_order_release);
+                // Another producer may have linked one meanwhile
+                if (atomic_load_explicit(&s->next, memory_order_acquire)) continue;
+                return -1;
+            }
+            segq_segment_t* expected = NULL;
+            if (atomic_compare_exchange_strong(&s->next, &expected, fresh)) {
+                next = fresh;
+            } else {
+                segq_segment_put(q, fresh);
+                next = expected;
+            }
+        }
+        segq_segment_t* cur = s;
+        atomic_compare_exchange_strong(&q->tail, &cur, next);
+        atomic_fetch_sub_explicit(&s->refs, 1, memory_order_release);
+    }
+}
+
+/* Recycle retired segments no producer still pins */
+static void segq_reclaim(mev_segq_t* q) {
+    segq_segment_t** link = &q->retired;
+    while (*link) {
+        segq_segment_t* s = *link;
+        if (atomic_load(&s->refs) == 0) {
+            *link = s->retired_next;
+            segq_segment_put(q, s);
+        } else {
+            link = &s->retired_next;
+        }
+    }
+}
+
+/**
+ * Pop the oldest item (consumer thread only).  NULL if empty.
+ */
+void* mev_segq_pop(mev_segq_t* q) {
+    segq_segment_t* s = q->head;
+    if (q->deq_idx == MEV_SEGQ_SEGMENT_SLOTS) {
+        segq_segment_t* next = atomic_load_explicit(&s->next, memory_order_acquire);
+        if (!next) return NULL;
+        // Every slot of `s` was consumed, so only stale pins can remain
+        q->head = next;
+        q->deq_idx = 0;
+        s->retired_next = q->retired;
+        q->retired = s;
+        segq_reclaim(q);
+        s = next;
+    }
+
+    void* item = atomic_load_explicit(&s->slots[q->deq_idx], memory_order_acquire);
+    if (!item) return NULL;   // empty, or claimed and not yet written
+    q->deq_idx++;
+    return item;
+}
+
+/**
+ * Segment accounting
+ */
+void mev_segq_stats(mev_segq_t* q, size_t* segments, size_t* high_water, size_t* ceiling_hits) {
+    if (segments) *segments = atomic_load(&q->n_segments);
+    if (high_water) *high_water = atomic_load(&q->high_water);
+    if (ceiling_hits) *ceiling_hits = atomic_load(&q->ceiling_hits);
+}
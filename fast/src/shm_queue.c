@@ -0,0 +1,379 @@
+/**
+ * Shared-Memory Cross-Process Queue
+ * Go network layer → Rust core (or any two processes) without a syscall per message
+ *
+ * The queue lives entirely in a POSIX shared-memory object:
+ *
+ *   offset 0        header: magic, version, kind, sizes, data offset
+ *   offset 64/128   consumer / producer cursors, one cache line each
+ *   data_offset     ring
+ *
+ * Nothing in the mapping is a pointer — cursors are sequence numbers and
+ * the ring is addressed relative to data_offset — so each process may map
+ * it at a different address.  The creator fills the header and stores the
+ * magic last (release); open() refuses an object whose magic, version or
+ * size does not match, so a reader never sees a half-built queue or a
+ * layout from another build.
+ *
+ * SPSC (variable-length records): a byte ring with monotonically increasing
+ * head / tail byte counts.  Each record is framed as an 8-byte length word
+ * followed by the payload padded to 8 bytes.  A record that would straddle
+ * the end of the ring is preceded by a wrap marker and written at offset
+ * 0, so every record is contiguous and can be read in place (peek).  Each
+ * side caches the other's cursor and rereads it only when the ring looks
+ * full / empty, as in spsc_queue.c.
+ *
+ * MPMC (fixed slots): the Vyukov per-slot sequence protocol of
+ * lockfree_queue.c, with a length word and up to slot_size payload bytes
+ * inline in each 64-byte-padded slot (as in record_queue.c).
+ *
+ * 64-bit atomics on shared memory are address-free on every supported
+ * target, so C11 atomics work across processes unchanged.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "shm_queue.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define SHMQ_MAGIC   0x3151484D53564D45ULL   // "EMVSHMQ1"
+#define SHMQ_WRAP    0xFFFFFFFFFFFFFFFFULL   // length word: skip to ring start
+#define SHMQ_FRAME   8                       // length word ahead of each record
+#define SHMQ_SLOT_HDR 16                     // MPMC: sequence word, then length word
+
+typedef struct {
+    _Atomic uint64_t magic;     // stored last by the creator
+    uint32_t version;
+    uint32_t kind;
+    uint64_t map_size;
+    uint64_t data_offset;       // from the start of the mapping
+    uint64_t capacity;          // ring bytes (SPSC) or slots (MPMC)
+    uint64_t stride;            // bytes per slot (MPMC), 0 for SPSC
+    uint64_t max_record;
+
+    alignas(64) _Atomic uint64_t head;   // Consumer cursor
+    alignas(64) _Atomic uint64_t tail;   // Producer cursor
+} shmq_header_t;
+
+struct mev_shmq_t {
+    shmq_header_t* hdr;
+    uint8_t* data;
+    size_t map_size;
+    uint64_t mask;
+    int kind;
+
+    // Process-local caches (SPSC)
+    uint64_t cached_head;       // producer's view of head
+    uint64_t cached_tail;       // consumer's view of tail
+};
+
+static inline uint64_t shmq_pad8(uint64_t n) {
+    return (n + 7) & ~(uint64_t)7;
+}
+
+static inline _Atomic uint64_t* shmq_seq(mev_shmq_t* q, uint64_t pos) {
+    return (_Atomic uint64_t*)(q->data + (pos & q->mask) * q->hdr->stride);
+}
+
+#ifdef _WIN32
+
+// No POSIX shared memory: the queue is unavailable and callers fall back
+mev_shmq_t* mev_shmq_create(const char* name, int kind, size_t capacity, size_t slot_size) {
+    (void)name; (void)kind; (void)capacity; (void)slot_size;
+    return NULL;
+}
+mev_shmq_t* mev_shmq_open(const char* name) { (void)name; return NULL; }
+void mev_shmq_close(mev_shmq_t* q) { (void)q; }
+int mev_shmq_unlink(const char* name) { (void)name; return -1; }
+
+#else
+
+static mev_shmq_t* shmq_attach(void* base, size_t map_size) {
+    mev_shmq_t* q = (mev_shmq_t*)malloc(sizeof(mev_shmq_t));
+    if (!q) {
+        munmap(base, map_size);
+        return NULL;
+    }
+    q->hdr = (shmq_header_t*)base;
+    q->data = (uint8_t*)base + q->hdr->data_offset;
+    q->map_size = map_size;
+    q->mask = q->hdr->capacity - 1;
+    q->kind = (int)q->hdr->kind;
+    q->cached_head = atomic_load_explicit(&q->hdr->head, memory_order_acquire);
+    q->cached_tail = atomic_load_explicit(&q->hdr->tail, memory_order_acquire);
+    return q;
+}
+
+/**
+ * Create a queue, replacing any existing object called `name`
+ */
+mev_shmq_t* mev_shmq_create(const char* name, int kind, size_t capacity, size_t slot_size) {
+    if (!name) return NULL;
+    if (kind != MEV_SHMQ_SPSC && kind != MEV_SHMQ_MPMC) return NULL;
+    if (kind == MEV_SHMQ_MPMC && (slot_size == 0 || slot_size > INT32_MAX)) return NULL;
+    if (capacity < 2) capacity = 2;
+    if (kind == MEV_SHMQ_SPSC && capacity < 64) capacity = 64;
+    if (capacity & (capacity - 1)) {
+        // Not power of 2, round up
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        capacity = n;
+    }
+
+    const uint64_t stride = kind == MEV_SHMQ_MPMC
+        ? (SHMQ_SLOT_HDR + slot_size + 63) & ~(uint64_t)63
+        : 0;
+    const uint64_t data_offset = (sizeof(shmq_header_t) + 4095) & ~(uint64_t)4095;
+    const uint64_t map_size = data_offset + (kind == MEV_SHMQ_MPMC ? capacity * stride : capacity);
+
+    // A fresh object: processes still mapping an old one keep it
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return NULL;
+    if (ftruncate(fd, (off_t)map_size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    void* base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name);
+        return NULL;
+    }
+
+    // ftruncate zero-fills: cursors start at 0
+    shmq_header_t* h = (shmq_header_t*)base;
+    h->version = MEV_SHMQ_VERSION;
+    h->kind = (uint32_t)kind;
+    h->map_size = map_size;
+    h->data_offset = data_offset;
+    h->capacity = capacity;
+    h->stride = stride;
+    // SPSC: a record plus a wrap gap must fit in the ring
+    h->max_record = kind == MEV_SHMQ_MPMC ? slot_size : capacity / 2 - SHMQ_FRAME;
+    if (h->max_record > INT32_MAX) h->max_record = INT32_MAX;   // lengths are returned as int
+    if (kind == MEV_SHMQ_MPMC) {
+        uint8_t* data = (uint8_t*)base + data_offset;
+        for (uint64_t i = 0; i < capacity; i++) {
+            atomic_store_explicit((_Atomic uint64_t*)(data + i * stride), i, memory_order_relaxed);
+        }
+    }
+    atomic_store_explicit(&h->magic, SHMQ_MAGIC, memory_order_release);
+
+    return shmq_attach(base, map_size);
+}
+
+/**
+ * Map an existing queue created by another process
+ */
+mev_shmq_t* mev_shmq_open(const char* name) {
+    if (!name) return NULL;
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(shmq_header_t)) {
+        close(fd);
+        return NULL;
+    }
+    size_t map_size = (size_t)st.st_size;
+    void* base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+
+    shmq_header_t* h = (shmq_header_t*)base;
+    if (atomic_load_explicit(&h->magic, memory_order_acquire) != SHMQ_MAGIC ||
+        h->version != MEV_SHMQ_VERSION ||
+        h->map_size != map_size ||
+        (h->kind != MEV_SHMQ_SPSC && h->kind != MEV_SHMQ_MPMC)) {
+        munmap(base, map_size);
+        return NULL;
+    }
+    return shmq_attach(base, map_size);
+}
+
+/**
+ * Unmap this process's view (the object itself stays until unlinked)
+ */
+void mev_shmq_close(mev_shmq_t* q) {
+    if (q) {
+        munmap(q->hdr, q->map_size);
+        free(q);
+    }
+}
+
+/**
+ * Remove the name; existing mappings stay valid
+ */
+int mev_shmq_unlink(const char* name) {
+    return name ? shm_unlink(name) : -1;
+}
+
+#endif // _WIN32
+
+// ─── SPSC, variable-length ───────────────────────────────────────────────────
+
+static int spsc_send(mev_shmq_t* q, const void* data, uint32_t len) {
+    shmq_header_t* h = q->hdr;
+    const uint64_t cap = h->capacity;
+    const uint64_t frame = SHMQ_FRAME + shmq_pad8(len);
+    const uint64_t tail = atomic_load_explicit(&h->tail, memory_order_relaxed);
+    const uint64_t pos = tail & q->mask;
+    const uint64_t to_end = cap - pos;
+    const uint64_t need = to_end < frame ? to_end + frame : frame;
+
+    if (need > cap - (tail - q->cached_head)) {
+        q->cached_head = atomic_load_explicit(&h->head, memory_order_acquire);
+        if (need > cap - (tail - q->cached_head)) return MEV_SHMQ_FULL;
+    }
+
+    uint8_t* p = q->data + pos;
+    if (to_end < frame) {
+        // Published together with the record by the single tail store below
+        *(uint64_t*)p = SHMQ_WRAP;
+        p = q->data;
+    }
+    *(uint64_t*)p = len;
+    memcpy(p + SHMQ_FRAME, data, len);
+    atomic_store_explicit(&h->tail, tail + need, memory_order_release);
+    return 0;
+}
+
+/**
+ * Next record for the consumer (SPSC): length, or MEV_SHMQ_EMPTY
+ */
+int mev_shmq_peek(mev_shmq_t* q, const void** data) {
+    if (q->kind != MEV_SHMQ_SPSC) return MEV_SHMQ_EMPTY;
+    shmq_header_t* h = q->hdr;
+    uint64_t head = atomic_load_explicit(&h->head, memory_order_relaxed);
+    if (head == q->cached_tail) {
+        q->cached_tail = atomic_load_explicit(&h->tail, memory_order_acquire);
+        if (head == q->cached_tail) return MEV_SHMQ_EMPTY;
+    }
+
+    uint64_t pos = head & q->mask;
+    uint64_t len = *(const uint64_t*)(q->data + pos);
+    if (len == SHMQ_WRAP) {
+        // A wrap marker is always followed by a record at offset 0
+        head += h->capacity - pos;
+        atomic_store_explicit(&h->head, head, memory_order_release);
+        pos = 0;
+        len = *(const uint64_t*)q->data;
+    }
+    *data = q->data + pos + SHMQ_FRAME;
+    return (int)len;
+}
+
+/**
+ * Drop the record returned by mev_shmq_peek
+ */
+void mev_shmq_consume(mev_shmq_t* q) {
+    if (q->kind != MEV_SHMQ_SPSC) return;
+    shmq_header_t* h = q->hdr;
+    const uint64_t head = atomic_load_explicit(&h->head, memory_order_relaxed);
+    const uint64_t len = *(const uint64_t*)(q->data + (head & q->mask));
+    atomic_store_explicit(&h->head, head + SHMQ_FRAME + shmq_pad8(len), memory_order_release);
+}
+
+// ─── MPMC, fixed slots ───────────────────────────────────────────────────────
+
+static int mpmc_send(mev_shmq_t* q, const void* data, uint32_t len) {
+    shmq_header_t* h = q->hdr;
+    uint64_t pos = atomic_load_explicit(&h->tail, memory_order_relaxed);
+    for (;;) {
+        _Atomic uint64_t* seq = shmq_seq(q, pos);
+        const int64_t diff = (int64_t)(atomic_load_explicit(seq, memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&h->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                uint8_t* slot = (uint8_t*)seq;
+                *(uint64_t*)(slot + 8) = len;
+                memcpy(slot + SHMQ_SLOT_HDR, data, len);
+                atomic_store_explicit(seq, pos + 1, memory_order_release);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return MEV_SHMQ_FULL;
+        } else {
+            pos = atomic_load_explicit(&h->tail, memory_order_relaxed);
+        }
+    }
+}
+
+static int mpmc_recv(mev_shmq_t* q, void* buf, uint32_t buf_len) {
+    shmq_header_t* h = q->hdr;
+    uint64_t pos = atomic_load_explicit(&h->head, memory_order_relaxed);
+    for (;;) {
+        _Atomic uint64_t* seq = shmq_seq(q, pos);
+        const int64_t diff = (int64_t)(atomic_load_explicit(seq, memory_order_acquire) - (pos + 1));
+        if (diff == 0) {
+            const uint8_t* slot = (const uint8_t*)seq;
+            const uint64_t len = *(const uint64_t*)(slot + 8);
+            if (len > buf_len) {
+                // Only report it if the slot is still ours to take
+                if (atomic_load_explicit(&h->head, memory_order_relaxed) == pos) return MEV_SHMQ_NOSPACE;
+                pos = atomic_load_explicit(&h->head, memory_order_relaxed);
+                continue;
+            }
+            if (atomic_compare_exchange_weak_explicit(&h->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                memcpy(buf, slot + SHMQ_SLOT_HDR, len);
+                atomic_store_explicit(seq, pos + h->capacity, memory_order_release);
+                return (int)len;
+            }
+        } else if (diff < 0) {
+            return MEV_SHMQ_EMPTY;
+        } else {
+            pos = atomic_load_explicit(&h->head, memory_order_relaxed);
+        }
+    }
+}
+
+// ─── Common API ──────────────────────────────────────────────────────────────
+
+/**
+ * Copy a record into the queue.  0, MEV_SHMQ_FULL or MEV_SHMQ_TOOBIG.
+ */
+int mev_shmq_send(mev_shmq_t* q, const void* data, uint32_t len) {
+    if (len > q->hdr->max_record) return MEV_SHMQ_TOOBIG;
+    return q->kind == MEV_SHMQ_SPSC ? spsc_send(q, data, len) : mpmc_send(q, data, len);
+}
+
+/**
+ * Copy the next record out.  Its length, MEV_SHMQ_EMPTY, or
+ * MEV_SHMQ_NOSPACE (record left in the queue) if `buf_len` is too small.
+ */
+int mev_shmq_recv(mev_shmq_t* q, void* buf, uint32_t buf_len) {
+    if (q->kind == MEV_SHMQ_MPMC) return mpmc_recv(q, buf, buf_len);
+    const void* p;
+    int len = mev_shmq_peek(q, &p);
+    if (len < 0) return len;
+    if ((uint32_t)len > buf_len) return MEV_SHMQ_NOSPACE;
+    memcpy(buf, p, (size_t)len);
+    mev_shmq_consume(q);
+    return len;
+}
+
+int mev_shmq_kind(mev_shmq_t* q) {
+    return q->kind;
+}
+
+uint32_t mev_shmq_max_record(mev_shmq_t* q) {
+    return (uint32_t)q->hdr->max_record;
+}
+
+int mev_shmq_empty(mev_shmq_t* q) {
+    return atomic_load_explicit(&q->hdr->head, memory_order_acquire) ==
+           atomic_load_explicit(&q->hdr->tail, memory_order_acquire);
+}
@@ -0,0 +1,193 @@
+/**
+ * Wait-free SPSC Ring for Per-Detector Channels
+ * One producer (feed thread), one consumer (detector)
+ *
+ * With a single writer per index no CAS and no per-slot sequence is needed:
+ * the producer owns `tail`, the consumer owns `head`, and each publishes its
+ * index with a release store that the other side reads with acquire.
+ *
+ * Each side also keeps a private copy of the other side's index
+ * (`cached_head` / `cached_tail`) and only re-reads the shared one when the
+ * copy says the ring is full / empty.  In steady state push and pop touch no
+ * cache line written by the other thread except the slot itself.
+ *
+ * Batch operations copy a run of items and publish the index once.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "spsc_queue.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#define aligned_alloc(align, size) _aligned_malloc(size, align)
+#define aligned_free(ptr) _aligned_free(ptr)
+#else
+#define aligned_free(ptr) free(ptr)
+#endif
+
+struct mev_spsc_t {
+    void** slots;
+    size_t capacity;
+    size_t mask;
+
+    // Producer line: shared tail + producer's view of head
+    alignas(64) atomic_size_t tail;
+    size_t cached_head;
+
+    // Consumer line: shared head + consumer's view of tail
+    alignas(64) atomic_size_t head;
+    size_t cached_tail;
+};
+
+/**
+ * Create a new ring
+ */
+mev_spsc_t* mev_spsc_create(size_t capacity) {
+    if (capacity < 2) capacity = 2;
+    if (capacity & (capacity - 1)) {
+        // Not power of 2, round up
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        capacity = n;
+    }
+
+    mev_spsc_t* q = (mev_spsc_t*)aligned_alloc(64, sizeof(mev_spsc_t));
+    if (!q) return NULL;
+
+    q->slots = (void**)calloc(capacity, sizeof(void*));
+    if (!q->slots) {
+        aligned_free(q);
+        return NULL;
+    }
+
+    q->capacity = capacity;
+    q->mask = capacity - 1;
+    q->cached_head = 0;
+    q->cached_tail = 0;
+    atomic_store(&q->head, 0);
+    atomic_store(&q->tail, 0);
+    return q;
+}
+
+/**
+ * Destroy ring
+ */
+void mev_spsc_destroy(mev_spsc_t* q) {
+    if (q) {
+        free(q->slots);
+        aligned_free(q);
+    }
+}
+
+/**
+ * Free slots as seen by the producer; refreshes cached_head only when the
+ * cached view cannot satisfy `want`.
+ */
+static inline size_t spsc_free_slots(mev_spsc_t* q, size_t tail, size_t want) {
+    size_t free_slots = q->capacity - (tail - q->cached_head);
+    if (free_slots < want) {
+        q->cached_head = atomic_load_explicit(&q->head, memory_order_acquire);
+        free_slots = q->capacity - (tail - q->cached_head);
+    }
+    return free_slots;
+}
+
+/**
+ * Filled slots as seen by the consumer; refreshes cached_tail only when the
+ * cached view cannot satisfy `want`.
+ */
+static inline size_t spsc_filled_slots(mev_spsc_t* q, size_t head, size_t want) {
+    size_t filled = q->cached_tail - head;
+    if (filled < want) {
+        q->cached_tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+        filled = q->cached_tail - head;
+    }
+    return filled;
+}
+
+/**
+ * Push item (producer thread only). Returns 0 on success, -1 if full.
+ */
+int mev_spsc_push(mev_spsc_t* q, void* item) {
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (spsc_free_slots(q, tail, 1) == 0) return -1;
+
+    q->slots[tail & q->mask] = item;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return 0;
+}
+
+/**
+ * Pop item (consumer thread only). Returns NULL if empty.
+ */
+void* mev_spsc_pop(mev_spsc_t* q) {
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (spsc_filled_slots(q, head, 1) == 0) return NULL;
+
+    void* item = q->slots[head & q->mask];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return item;
+}
+
+/**
+ * Push up to n_items (producer thread only), published with a single
+ * release store.  Returns the number pushed.
+ */
+size_t mev_spsc_push_batch(mev_spsc_t* q, void* const* items, size_t n_items) {
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    size_t n = spsc_free_slots(q, tail, n_items);
+    if (n > n_items) n = n_items;
+    if (n == 0) return 0;
+
+    // Copy in at most two runs: up to the end of the ring, then from slot 0
+    size_t start = tail & q->mask;
+    size_t first = q->capacity - start;
+    if (first > n) first = n;
+    memcpy(&q->slots[start], items, first * sizeof(void*));
+    memcpy(&q->slots[0], items + first, (n - first) * sizeof(void*));
+
+    atomic_store_explicit(&q->tail, tail + n, memory_order_release);
+    return n;
+}
+
+/**
+ * Pop up to max_items (consumer thread only), released with a single
+ * store.  Returns the number popped.
+ */
+size_t mev_spsc_pop_batch(mev_spsc_t* q, void** items, size_t max_items) {
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t n = spsc_filled_slots(q, head, max_items);
+    if (n > max_items) n = max_items;
+    if (n == 0) return 0;
+
+    size_t start = head & q->mask;
+    size_t first = q->capacity - start;
+    if (first > n) first = n;
+    memcpy(items, &q->slots[start], first * sizeof(void*));
+    memcpy(items + first, &q->slots[0], (n - first) * sizeof(void*));
+
+    atomic_store_explicit(&q->head, head + n, memory_order_release);
+    return n;
+}
+
+/**
+ * Get ring size (approximate snapshot when read from a third thread)
+ */
+size_t mev_spsc_size(mev_spsc_t* q) {
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    return tail - head;
+}
+
+/**
+ * Check if empty
+ */
+int mev_spsc_empty(mev_spsc_t* q) {
+    return mev_spsc_size(q) == 0;
+}
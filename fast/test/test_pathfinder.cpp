@@ -0,0 +1,877 @@
+/**
+ * MEV Protocol - C++ Kernel Tests (pathfinder + pool-graph extensions)
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include "../include/pathfinder.h"
+#include "../include/cycle_screen.h"
+#include "../include/graph_shard.h"
+#include "../include/graph_snapshot.h"
+#include "../include/log_decoder.h"
+#include "../include/delta_stream.h"
+#include "../include/graph_replica.h"
+#include "../include/price_table.h"
+#include "../include/backrun_cache.h"
+#include <sys/socket.h>
+
+/* Test colors */
+#define GREEN "\033[32m"
+#define RED "\033[31m"
+#define RESET "\033[0m"
+
+#define TEST(name) printf("  Testing %s... ", name)
+#define PASS() printf(GREEN "PASS" RESET "\n")
+#define FAIL() printf(RED "FAIL" RESET "\n")
+
+/* PoolGraph is a few hundred KB — keep test graphs off the stack */
+static PoolGraph g_graph;
+
+static void make_addr(uint8_t out[20], uint8_t tag) {
+    memset(out, 0, 20);
+    out[0]  = 0xAA;
+    out[19] = tag;
+}
+
+static AMMPool make_pool(uint8_t t0, uint8_t t1, uint8_t pool_tag,
+                         uint64_t r0, uint64_t r1, uint32_t fee_bps = 3000) {
+    AMMPool p{};
+    make_addr(p.token0, t0);
+    make_addr(p.token1, t1);
+    make_addr(p.pool_addr, pool_tag);
+    p.pool_addr[0] = 0xBB;
+    p.reserve0 = r0;
+    p.reserve1 = r1;
+    p.fee_bps  = fee_bps;
+    return p;
+}
+
+static uint64_t token_fp(uint8_t tag) {
+    uint8_t a[20];
+    make_addr(a, tag);
+    return PoolGraph::pf_fnv1a(a, 20);
+}
+
+static uint32_t token_id(const PoolGraph& g, uint8_t tag) {
+    uint8_t a[20];
+    make_addr(a, tag);
+    return g.tokens.find(a);
+}
+
+void test_pool_graph() {
+    printf("\n=== PoolGraph Tests ===\n");
+
+    TEST("upsert appends then updates in place");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        assert(g.upsert(make_pool(1, 2, 1, 1000000, 2000000)));
+        uint32_t v0 = g.version[0];
+        assert(g.upsert(make_pool(1, 2, 1, 1500000, 1500000)));
+        assert(g.n_pools == 1);
+        assert(g.reserve0[0] == 1500000);
+        assert(g.version[0] != v0);
+        PASS();
+    }
+
+    TEST("find_best_path locates a 2-cycle");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        /* Pool A prices token2 at 2.0, pool B at 2.2 → buy on A, sell on B */
+        g.upsert(make_pool(1, 2, 1, 1000000000ULL, 2000000000ULL));
+        g.upsert(make_pool(1, 2, 2, 1000000000ULL, 2200000000ULL));
+        PathfinderResult r = find_best_path(g, token_id(g, 1), token_id(g, 1), 100000000ULL);
+        assert(r.valid == 1);
+        assert(r.best_path.n_hops == 2);
+        assert(r.gross_profit > 0);
+        PASS();
+    }
+}
+
+void test_token_table() {
+    printf("\n=== Token Table Tests ===\n");
+
+    TEST("interning assigns dense ids and verifies full addresses");
+    {
+        static TokenTable t;
+        t.clear();
+        uint8_t a[20], b[20];
+        make_addr(a, 1);
+        make_addr(b, 1);
+        b[7] = 0x42;                                   /* differs outside the tag byte */
+        assert(t.intern(a) == 0);
+        assert(t.intern(b) == 1);
+        assert(t.intern(a) == 0);
+        assert(t.find(b) == 1 && t.n_tokens == 2);
+        b[7] = 0x43;
+        assert(t.find(b) == PF_INF);
+        PASS();
+    }
+
+    TEST("table fills to PF_MAX_TOKENS then refuses");
+    {
+        static TokenTable t;
+        t.clear();
+        uint8_t a[20] = {};
+        for (uint32_t i = 0; i < PF_MAX_TOKENS; ++i) {
+            memcpy(a, &i, sizeof(i));
+            assert(t.intern(a) == i);
+        }
+        uint32_t extra = PF_MAX_TOKENS;
+        memcpy(a, &extra, sizeof(extra));
+        assert(t.intern(a) == PF_INF);
+        for (uint32_t i = 0; i < PF_MAX_TOKENS; i += 37) {
+            memcpy(a, &i, sizeof(i));
+            assert(t.find(a) == i);
+        }
+        PASS();
+    }
+}
+
+void test_price_table() {
+    printf("\n=== Price Table Tests ===\n");
+
+    static PriceTable pt;
+    PoolGraph& g = g_graph;
+
+    TEST("tokens are quoted from their deepest base pool, then one hop out");
+    {
+        g.clear();
+        /* token 1 = base; token 2 quoted by the deeper of two pools */
+        g.upsert(make_pool(2, 1, 1,   1000000ULL,   2000000ULL));          /* 2.0, shallow */
+        g.upsert(make_pool(2, 1, 2, 100000000ULL, 300000000ULL));          /* 3.0, deep */
+        g.upsert(make_pool(3, 2, 3,  50000000ULL,  10000000ULL));          /* 3 → 2 @ 0.2 */
+        g.upsert(make_pool(4, 5, 4,   1000000ULL,   1000000ULL));          /* unreachable */
+
+        uint8_t base[20];
+        make_addr(base, 1);
+        pt.init(base);
+        assert(pt.refresh(g) == 4);
+        const uint32_t t2 = token_id(g, 2), t3 = token_id(g, 3), t4 = token_id(g, 4);
+        assert(pt.level[t2] == 1 && pt.via_pool[t2] == 1);
+        assert(pt.to_base[t2] > 2.999 && pt.to_base[t2] < 3.001);
+        assert(pt.level[t3] == 2);
+        assert(pt.to_base[t3] > 0.599 && pt.to_base[t3] < 0.601);
+        assert(pt.level[t4] == PT_UNPRICED && pt.n_priced == 3);
+
+        int64_t out;
+        assert(pt.convert(t3, 1000, out) && out == 600);
+        assert(!pt.convert(t4, 1000, out) && out == 0);
+        PASS();
+    }
+
+    TEST("refresh re-quotes only dirty pools and propagates one hop");
+    {
+        assert(pt.refresh(g) == 0);
+        g.upsert(make_pool(2, 1, 2, 100000000ULL, 400000000ULL));          /* deep pool → 4.0 */
+        assert(pt.refresh(g) == 1);
+        const uint32_t t2 = token_id(g, 2), t3 = token_id(g, 3);
+        assert(pt.to_base[t2] > 3.999 && pt.to_base[t2] < 4.001);
+        assert(pt.to_base[t3] > 0.799 && pt.to_base[t3] < 0.801);
+
+        PASS();
+    }
+
+    TEST("clearing the graph resets the table");
+    {
+        g.clear();
+        g.upsert(make_pool(1, 6, 1, 2000000ULL, 1000000ULL));             /* 6 @ 2.0 */
+        assert(pt.refresh(g) == 1);
+        const uint32_t t6 = token_id(g, 6);
+        assert(pt.n_priced == 2 && pt.level[t6] == 1);
+        assert(pt.to_base[t6] > 1.999 && pt.to_base[t6] < 2.001);
+        PASS();
+    }
+
+    TEST("refill with the base under a new id re-resolves it");
+    {
+        g.clear();
+        g.upsert(make_pool(7, 8, 1, 1000000ULL, 1000000ULL));             /* base is not id 0 now */
+        g.upsert(make_pool(7, 1, 2, 1000000ULL, 3000000ULL));             /* 7 @ 3.0 */
+        assert(pt.refresh(g) == 2);
+        const uint32_t t1 = token_id(g, 1), t7 = token_id(g, 7), t8 = token_id(g, 8);
+        assert(pt.base_id == t1 && pt.level[t1] == 0 && pt.to_base[t1] == 1.0);
+        assert(pt.level[t7] == 1 && pt.to_base[t7] > 2.999 && pt.to_base[t7] < 3.001);
+        assert(pt.level[t8] == 2 && pt.n_priced == 3);
+        PASS();
+    }
+}
+
+void test_backrun_cache() {
+    printf("\n=== Backrun Cache Tests ===\n");
+
+    static BackrunCache cache;
+    PoolGraph& g = g_graph;
+
+    TEST("precompute simulates the victim and finds the backrun");
+    {
+        g.clear();
+        cache.clear();
+        g.upsert(make_pool(1, 2, 1, 1000000000000ULL, 1000000000000ULL));  /* victim pool */
+        g.upsert(make_pool(1, 2, 2, 1000000000000ULL, 1000000000000ULL));
+        g.upsert(make_pool(3, 4, 3, 1000000000000ULL, 1000000000000ULL));  /* unrelated */
+        assert(!find_best_path(g, token_id(g, 2), token_id(g, 2), 10000000000ULL).valid);
+
+        VictimSwap v{};
+        memset(v.tx_hash, 0x5A, 32);
+        make_addr(v.pool_addr, 1);
+        v.pool_addr[0] = 0xBB;
+        make_addr(v.token_in, 1);
+        v.amount_in = 10000000000ULL;                                     /* 1% of the pool */
+
+        const uint32_t ver0 = g.version[0];
+        BackrunQuote q;
+        assert(cache.precompute(g, v, 10000000000ULL, &q) == BR_OK);
+        assert(q.victim_slot == 0 && q.victim_amount_out > 0);
+        assert(q.post_reserve0 == 1000000000000ULL + v.amount_in);
+        assert(q.post_reserve1 == 1000000000000ULL - q.victim_amount_out);
+        assert(q.backrun.valid && q.backrun.gross_profit > 0);
+        assert(q.backrun.best_path.n_hops == 2);
+        /* live state untouched */
+        assert(g.reserve0[0] == 1000000000000ULL && g.version[0] == ver0);
+        PASS();
+    }
+
+    TEST("lookup hits until a touched pool moves");
+    {
+        uint8_t h[32];
+        memset(h, 0x5A, 32);
+        const BackrunQuote* q = cache.lookup(g, h);
+        assert(q && q->backrun.valid);
+
+        g.upsert(make_pool(3, 4, 3, 2000000000000ULL, 1000000000000ULL)); /* unrelated pool */
+        assert(cache.lookup(g, h));
+
+        g.upsert(make_pool(1, 2, 2, 1000000000000ULL, 1100000000000ULL)); /* backrun hop */
+        assert(!cache.lookup(g, h));
+        assert(!cache.lookup(g, h));                                      /* dropped */
+        assert(cache.stats.hits == 2 && cache.stats.stale == 1 && cache.stats.misses == 1);
+        PASS();
+    }
+
+    TEST("unknown pools and foreign tokens are rejected");
+    {
+        VictimSwap v{};
+        make_addr(v.pool_addr, 9);
+        v.amount_in = 1000;
+        assert(cache.precompute(g, v, 1000, nullptr) == BR_ENOPOOL);
+        make_addr(v.pool_addr, 1);
+        v.pool_addr[0] = 0xBB;
+        make_addr(v.token_in, 3);
+        assert(cache.precompute(g, v, 1000, nullptr) == BR_ETOKEN);
+        PASS();
+    }
+}
+
+void test_reorg_journal() {
+    printf("\n=== Reorg Journal Tests ===\n");
+
+    TEST("rollback reverts updates and appends after the fork block");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        AMMPool p = make_pool(1, 2, 1, 1000, 2000);
+        p.block_updated = 100;
+        g.upsert(p);
+        uint32_t v100 = g.version[0];
+
+        p.reserve0 = 1100; p.block_updated = 101;
+        g.upsert(p);
+        p.reserve0 = 1200; p.block_updated = 102;
+        g.upsert(p);
+        AMMPool q = make_pool(2, 3, 2, 5000, 6000);
+        q.block_updated = 102;
+        g.upsert(q);
+        assert(g.n_pools == 2 && g.block_updated[0] == 102);
+
+        assert(g.rollback(101) == 2);          /* undo the 102 append + update */
+        assert(g.n_pools == 1);
+        assert(g.reserve0[0] == 1100 && g.block_updated[0] == 101);
+        assert(g.rollback(100) == 1);
+        assert(g.reserve0[0] == 1000 && g.version[0] == v100);
+        assert(g.rollback(100) == 0);
+        PASS();
+    }
+
+    TEST("rollback past the journal window is refused");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        AMMPool p = make_pool(1, 2, 1, 1000, 2000);
+        for (uint64_t b = 1; b <= PF_JOURNAL_DEPTH + 10; ++b) {
+            p.reserve0 = 1000 + b;
+            p.block_updated = b;
+            g.upsert(p);
+        }
+        assert(g.rollback(5) == -1);
+        assert(g.rollback(PF_JOURNAL_DEPTH) == 10);
+        assert(g.reserve0[0] == 1000 + PF_JOURNAL_DEPTH);
+        PASS();
+    }
+}
+
+void test_cycle_screen() {
+    printf("\n=== Cycle Screen Tests ===\n");
+
+    static SpotRateMatrix m;
+    static CycleHit hits[64];
+
+    TEST("2-cycle above threshold is reported");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        g.upsert(make_pool(1, 2, 1, 1000000000ULL, 2000000000ULL));
+        g.upsert(make_pool(1, 2, 2, 1000000000ULL, 2200000000ULL));
+
+        uint8_t hub[1][20];
+        make_addr(hub[0], 1);
+        m.init(hub, 1);
+        assert(m.refresh(g) == 2);
+        uint32_t n = m.screen(0, hits, 64);
+        assert(n == 1);
+        assert(hits[0].n_hops == 2);
+        assert(hits[0].pool_idx[0] == 1 && hits[0].pool_idx[1] == 0);
+        assert(hits[0].rate_product > 1.09f && hits[0].rate_product < 1.10f);
+        /* A 1000 bps edge requirement rejects it */
+        assert(m.screen(1000, hits, 64) == 0);
+        PASS();
+    }
+
+    TEST("refresh touches only dirty pools");
+    {
+        PoolGraph& g = g_graph;
+        assert(m.refresh(g) == 0);
+        g.upsert(make_pool(1, 2, 2, 1000000000ULL, 2000000000ULL));  /* close the gap */
+        assert(m.refresh(g) == 1);
+        assert(m.screen(0, hits, 64) == 0);
+        PASS();
+    }
+
+    TEST("triangular cycle is reported once");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        /* 1→2 @2, 2→3 @3, 3→1 @0.2 → product 1.2 before fees */
+        g.upsert(make_pool(1, 2, 1, 1000000000ULL, 2000000000ULL));
+        g.upsert(make_pool(2, 3, 2, 1000000000ULL, 3000000000ULL));
+        g.upsert(make_pool(3, 1, 3, 1000000000ULL,  200000000ULL));
+
+        uint8_t hubs[2][20];
+        make_addr(hubs[0], 1);
+        make_addr(hubs[1], 2);
+        m.init(hubs, 2);
+        m.refresh(g);
+        uint32_t n = m.screen(0, hits, 64);
+        assert(n == 1);
+        assert(hits[0].n_hops == 3);
+        assert(hits[0].token_id[0] == token_id(g, 1));
+        assert(hits[0].token_id[1] == token_id(g, 2));
+        assert(hits[0].token_id[2] == token_id(g, 3));
+        PASS();
+    }
+
+    TEST("clear and refill to the same size rebuilds the matrix");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        /* Same slot count, different pairs; token 4 now takes id 0 and the
+           hub token 1 id 1 (hub 2's old id), hub 2 is not interned */
+        g.upsert(make_pool(4, 1, 1, 2000000000ULL, 1000000000ULL));
+        g.upsert(make_pool(4, 1, 2, 2200000000ULL, 1000000000ULL));
+        g.upsert(make_pool(5, 6, 3, 1000000000ULL, 1000000000ULL));
+
+        assert(m.refresh(g) == 3);
+        assert(m.n_hubs == 1);
+        uint32_t n = m.screen(0, hits, 64);
+        assert(n == 1 && hits[0].n_hops == 2);
+        assert(hits[0].token_id[0] == token_id(g, 1) && hits[0].token_id[1] == token_id(g, 4));
+        assert(hits[0].pool_idx[0] == 1 && hits[0].pool_idx[1] == 0);
+        PASS();
+    }
+
+    TEST("a hub interned later joins the screen");
+    {
+        PoolGraph& g = g_graph;
+        g.upsert(make_pool(2, 5, 4, 1000000000ULL, 1000000000ULL));
+        assert(m.refresh(g) == 4);                  /* rebuilt with hub 2 */
+        assert(m.n_hubs == 2 && m.col_id[m.hub_col[1]] == token_id(g, 2));
+        assert(m.screen(0, hits, 64) == 1 && hits[0].token_id[0] == token_id(g, 1));
+        PASS();
+    }
+
+    TEST("rollback of a pool update restores its rate");
+    {
+        PoolGraph& g = g_graph;
+        AMMPool p = make_pool(4, 1, 2, 2000000000ULL, 1000000000ULL);  /* close the gap */
+        p.block_updated = 50;
+        g.upsert(p);
+        m.refresh(g);
+        assert(m.screen(0, hits, 64) == 0);
+        assert(g.rollback(49) == 1);
+        m.refresh(g);
+        assert(m.screen(0, hits, 64) == 1);
+        PASS();
+    }
+}
+
+void test_graph_shard() {
+    printf("\n=== Graph Shard Tests ===\n");
+
+    static AMMPool pools[16];
+    uint32_t n = 0;
+    /* Community A: 10-11-12, community B: 20-21, hub token 1 */
+    pools[n++] = make_pool(10, 11, 1, 1000000000ULL, 1000000000ULL);
+    pools[n++] = make_pool(11, 12, 2, 1000000000ULL, 1000000000ULL);
+    pools[n++] = make_pool(10, 12, 3, 1000000000ULL, 1000000000ULL);
+    pools[n++] = make_pool(20, 21, 4, 1000000000ULL, 1000000000ULL);
+    pools[n++] = make_pool(12, 20, 5, 1000000000ULL, 1000000000ULL);  /* cross */
+    pools[n++] = make_pool(1, 10, 6, 1000000000ULL, 2000000000ULL);
+    pools[n++] = make_pool(1, 10, 7, 1000000000ULL, 2200000000ULL);
+    pools[n++] = make_pool(1, 20, 8, 1000000000ULL, 1000000000ULL);
+
+    ShardConfig cfg{};
+    make_addr(cfg.hub_tokens[0], 1);
+    cfg.n_hubs     = 1;
+    cfg.n_workers  = 2;
+    cfg.fill_pct   = 3;          /* 7-pool shards: A and B cannot share one */
+    cfg.first_cpu  = -1;
+
+    TEST("partition separates communities and counts cross edges");
+    ShardedGraph* sg = nullptr;
+    {
+        sg = ShardedGraph::create(pools, n, cfg);
+        assert(sg != nullptr);
+        assert(sg->report.n_shards == 3);
+        assert(sg->report.n_cross == 1);
+        assert(sg->report.n_dropped == 0);
+        assert(sg->report.n_replicated == 3);
+        assert(sg->shard_of(token_fp(10)) != sg->shard_of(token_fp(20)));
+        PASS();
+    }
+
+    TEST("parallel search finds the hub cycle and records latency");
+    {
+        uint8_t hub[20], t20[20];
+        make_addr(hub, 1);
+        make_addr(t20, 20);
+        PathfinderResult r = sg->find_best(hub, hub, 100000000ULL);
+        assert(r.valid == 1);
+        assert(r.best_path.n_hops == 2);
+        assert(sg->stats[GS_HUB_SHARD].searches == 1);
+        /* Second query from a community token: only its shard + hub shard run */
+        sg->find_best(t20, t20, 1000000ULL);
+        uint64_t total = 0;
+        for (uint32_t s = 0; s < sg->n_shards; ++s) total += sg->stats[s].searches;
+        assert(total == 3 + 2);
+        ShardedGraph::destroy(sg);
+        PASS();
+    }
+
+    TEST("hub pools past one shard spill into extra hub shards");
+    {
+        /* 300 hub pools on distinct tokens plus a hub cycle on the last one:
+         * more than a single hub shard could hold */
+        static AMMPool many[302];
+        uint32_t m = 0;
+        for (uint32_t k = 0; k < 300; ++k) {
+            AMMPool p = make_pool(1, static_cast<uint8_t>(k), static_cast<uint8_t>(k),
+                                  1000000000ULL, 1000000000ULL);
+            p.token1[18]    = static_cast<uint8_t>(1 + (k >> 8));
+            p.pool_addr[18] = static_cast<uint8_t>(1 + (k >> 8));
+            many[m++] = p;
+        }
+        for (uint32_t k = 0; k < 2; ++k) {
+            AMMPool p = many[299];
+            p.pool_addr[17] = static_cast<uint8_t>(1 + k);
+            p.reserve1 = k ? 2200000000ULL : 2000000000ULL;
+            many[m++] = p;
+        }
+
+        ShardConfig c2 = cfg;
+        c2.fill_pct = 50;           /* 128-pool target: three hub shards */
+        ShardedGraph* big = ShardedGraph::create(many, m, c2);
+        assert(big != nullptr);
+        assert(big->report.n_hub_shards == 3);
+        assert(big->report.n_dropped == 0);
+        uint32_t in_hub = 0;
+        for (uint32_t h = 0; h < big->n_hub_shards; ++h) in_hub += big->graphs[h].n_pools;
+        assert(in_hub == m);
+
+        uint8_t hub[20];
+        make_addr(hub, 1);
+        PathfinderResult r = big->find_best(hub, hub, 100000000ULL);
+        assert(r.valid == 1);
+
+        /* An upserted cross pool is counted, an update of it is not */
+        AMMPool x = make_pool(10, 20, 9, 1000000000ULL, 1000000000ULL);
+        ShardedGraph* small = ShardedGraph::create(pools, n, cfg);
+        assert(small != nullptr);
+        const uint32_t cross0 = small->report.n_cross;
+        small->place(x, small->report.n_cross, small->report.n_dropped);
+        small->place(x, small->report.n_cross, small->report.n_dropped);
+        assert(small->report.n_cross == cross0 + 1);
+        ShardedGraph::destroy(small);
+        ShardedGraph::destroy(big);
+        PASS();
+    }
+}
+
+void test_graph_snapshot() {
+    printf("\n=== Graph Snapshot Tests ===\n");
+
+    static PoolGraph loaded;
+    const char* path = "test/snapshot_test.bin";
+
+    TEST("save/load round-trip");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        g.upsert(make_pool(1, 2, 1, 1000000000ULL, 2000000000ULL));
+        g.upsert(make_pool(2, 3, 2, 3000000000ULL, 4000000000ULL, 500));
+        assert(snapshot_save(g, path, 19000000ULL) == PF_SNAP_OK);
+
+        uint64_t block = 0;
+        loaded.clear();
+        assert(snapshot_load(loaded, path, &block) == PF_SNAP_OK);
+        assert(block == 19000000ULL);
+        assert(loaded.n_pools == 2);
+        assert(loaded.reserve1[1] == 4000000000ULL);
+        assert(loaded.fee_bps[1] == 500);
+        assert(loaded.token0_id[0] == g.token0_id[0]);
+        assert(loaded.tokens.n_tokens == 3);
+        assert(memcmp(loaded.pool_addr[1], g.pool_addr[1], 20) == 0);
+        assert(loaded.version[1] == g.version[1]);
+        assert(loaded.version_clock == g.version_clock);
+        PASS();
+    }
+
+    TEST("corrupted payload is rejected");
+    {
+        FILE* f = fopen(path, "r+b");
+        assert(f);
+        fseek(f, 200, SEEK_SET);
+        fputc(0x5A, f);
+        fclose(f);
+        assert(snapshot_load(loaded, path, nullptr) == PF_SNAP_ECHECKSUM);
+        assert(loaded.n_pools == 2);  /* untouched on error */
+        PASS();
+    }
+
+    TEST("corrupted header fields are rejected");
+    {
+        assert(snapshot_save(g_graph, path, 19000000ULL) == PF_SNAP_OK);
+        FILE* f = fopen(path, "r+b");
+        assert(f);
+        fseek(f, offsetof(SnapshotHeader, last_block), SEEK_SET);
+        fputc(0x01, f);                       /* last_block no longer 19000000 */
+        fclose(f);
+        assert(snapshot_load(loaded, path, nullptr) == PF_SNAP_ECHECKSUM);
+        remove(path);
+        assert(snapshot_load(loaded, path, nullptr) == PF_SNAP_EIO);
+        PASS();
+    }
+}
+
+/* Sign-extended int64 as a big-endian 32-byte ABI word */
+static void put_word(uint8_t* w, int64_t v) {
+    memset(w, v < 0 ? 0xFF : 0x00, 32);
+    for (int i = 0; i < 8; ++i) w[31 - i] = static_cast<uint8_t>(static_cast<uint64_t>(v) >> (8 * i));
+}
+
+static EvmLog make_log(const AMMPool& p, const uint8_t* topic0,
+                       const uint8_t* data, uint32_t len, uint64_t block) {
+    EvmLog lg{};
+    memcpy(lg.address, p.pool_addr, 20);
+    memcpy(lg.topics[0], topic0, 32);
+    lg.n_topics     = 3;
+    lg.data         = data;
+    lg.data_len     = len;
+    lg.block_number = block;
+    return lg;
+}
+
+void test_log_decoder() {
+    printf("\n=== Log Decoder Tests ===\n");
+
+    TEST("V2 Sync updates reserves and marks the slot dirty");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        AMMPool a = make_pool(1, 2, 1, 1000, 2000);
+        AMMPool b = make_pool(2, 3, 2, 3000, 4000);
+        g.upsert(a);
+        g.upsert(b);
+        uint32_t v0 = g.version[0];
+
+        uint8_t data[64];
+        put_word(data, 5555);
+        put_word(data + 32, 7777);
+        AMMPool stranger = make_pool(1, 2, 9, 0, 0);
+        EvmLog logs[3] = {
+            make_log(b, LD_TOPIC_SYNC, data, 64, 50),
+            make_log(stranger, LD_TOPIC_SYNC, data, 64, 50),
+            make_log(b, LD_TOPIC_SWAP_V3, data, 64, 50),  /* V3 event on a V2 pool */
+        };
+        uint64_t dirty[LD_DIRTY_WORDS];
+        LogDecodeStats st = decode_logs(g, logs, 3, dirty);
+        assert(st.applied == 1 && st.no_pool == 1 && st.malformed == 1);
+        assert(st.n_dirty == 1 && dirty[0] == 0x2);
+        assert(g.reserve0[1] == 5555 && g.reserve1[1] == 7777);
+        assert(g.block_updated[1] == 50);
+        assert(g.version[0] == v0);
+        PASS();
+    }
+
+    TEST("V3 Swap and in-range Mint/Burn update liquidity, price and tick");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        AMMPool p = make_pool(1, 2, 3, 1000000, 1ULL << 40);
+        p.is_v3 = 1;
+        g.upsert(p);
+
+        uint8_t swap[160];
+        put_word(swap, 100);
+        put_word(swap + 32, -99);
+        put_word(swap + 64, 3LL << 40);  /* sqrtPriceX96 → Q64 = 3 << 8 */
+        put_word(swap + 96, 2000000);
+        put_word(swap + 128, -10);
+
+        uint8_t mint[128];
+        put_word(mint, 0);
+        put_word(mint + 32, 500);
+        put_word(mint + 64, 0);
+        put_word(mint + 96, 0);
+        uint8_t burn[96];
+        put_word(burn, 300);
+        put_word(burn + 32, 0);
+        put_word(burn + 64, 0);
+
+        EvmLog logs[4] = {
+            make_log(p, LD_TOPIC_SWAP_V3, swap, 160, 60),
+            make_log(p, LD_TOPIC_MINT_V3, mint, 128, 60),
+            make_log(p, LD_TOPIC_BURN_V3, burn, 96, 60),
+            make_log(p, LD_TOPIC_MINT_V3, mint, 128, 60),
+        };
+        for (auto& lg : logs) lg.n_topics = 4;
+        put_word(logs[1].topics[2], -20);   /* [-20, 20) contains -10 */
+        put_word(logs[1].topics[3], 20);
+        put_word(logs[2].topics[2], -100);  /* [-100, 0) contains -10 */
+        put_word(logs[2].topics[3], 0);
+        put_word(logs[3].topics[2], 0);     /* [0, 60) does not */
+        put_word(logs[3].topics[3], 60);
+
+        uint64_t dirty[LD_DIRTY_WORDS];
+        LogDecodeStats st = decode_logs(g, logs, 4, dirty);
+        assert(st.applied == 3 && st.n_dirty == 1);
+        assert(g.tick[0] == -10);
+        assert(g.reserve1[0] == (3ULL << 8));
+        assert(g.reserve0[0] == 2000000 + 500 - 300);
+
+        /* Three changes in one block are undone by a single journal entry */
+        assert(g.rollback(59) == 1);
+        assert(g.reserve0[0] == 1000000 && g.tick[0] == 0);
+        PASS();
+    }
+
+    TEST("values wider than 64 bits are counted and not applied");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        AMMPool a = make_pool(1, 2, 1, 1000, 2000);
+        g.upsert(a);
+        const uint32_t v0 = g.version[0];
+
+        uint8_t wide[64];
+        put_word(wide, 5555);
+        put_word(wide + 32, 7777);
+        wide[32 + 23] = 1;                  /* reserve1 = 2^64 + 7777 */
+        EvmLog lg = make_log(a, LD_TOPIC_SYNC, wide, 64, 70);
+
+        uint64_t dirty[LD_DIRTY_WORDS];
+        LogDecodeStats st = decode_logs(g, &lg, 1, dirty);
+        assert(st.overflowed == 1 && st.applied == 0 && st.n_dirty == 0);
+        assert(g.reserve0[0] == 1000 && g.reserve1[0] == 2000);
+        assert(g.version[0] == v0);
+        PASS();
+    }
+}
+
+void test_delta_stream() {
+    printf("\n=== Delta Stream Tests ===\n");
+
+    static PoolGraph replica;
+    static PoolDelta deltas[PF_MAX_POOLS];
+    const char* path = "test/delta_test.dlt";
+
+    TEST("recorded deltas replay to the same state");
+    {
+        PoolGraph& g = g_graph;
+        g.clear();
+        g.upsert(make_pool(1, 2, 1, 1000, 2000));
+        g.upsert(make_pool(2, 3, 2, 3000, 4000));
+        memcpy(&replica, &g, sizeof(PoolGraph));
+
+        DeltaWriter w;
+        assert(w.open(path) == PF_SNAP_OK);
+        uint32_t clock = g.version_clock;
+        g.apply_state(1, 3100, 3900, 0, 10);
+        uint32_t n = delta_collect(g, clock, deltas, PF_MAX_POOLS);
+        assert(n == 1 && deltas[0].slot == 1);
+        assert(w.append(10, deltas, n) == PF_SNAP_OK);
+        assert(w.append(10, deltas, 0) == PF_SNAP_EFORMAT);   /* blocks must increase */
+        clock = g.version_clock;
+        g.apply_state(0, 1100, 1900, 0, 11);
+        g.apply_state(1, 3200, 3800, 0, 11);
+        n = delta_collect(g, clock, deltas, PF_MAX_POOLS);
+        assert(n == 2);
+        assert(w.append(11, deltas, n) == PF_SNAP_OK);
+        assert(w.finish() == PF_SNAP_OK);
+
+        DeltaReader rd;
+        assert(rd.open(path) == PF_SNAP_OK);
+        assert(rd.hdr.n_frames == 2 && rd.hdr.n_deltas == 3);
+        uint64_t block;
+        const PoolDelta* d;
+        uint32_t frames = 0;
+        while (rd.next(block, d, n)) {
+            delta_apply(replica, block, d, n);
+            ++frames;
+        }
+        rd.close();
+        remove(path);
+        assert(frames == 2);
+        assert(replica.reserve0[0] == 1100 && replica.reserve1[1] == 3800);
+        assert(replica.block_updated[1] == 11);
+        assert(replica.rollback(10) == 2);
+        assert(replica.reserve0[1] == 3100);
+        PASS();
+    }
+}
+
+void test_graph_replica() {
+    printf("\n=== Graph Replica Tests ===\n");
+
+    static PoolGraph follower_graph;
+    static ReplicaLeader leader;
+    static ReplicaFollower follower;
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+
+    PoolGraph& g = g_graph;
+    g.clear();
+    g.upsert(make_pool(1, 2, 1, 1000, 2000));
+    g.upsert(make_pool(2, 3, 2, 3000, 4000));
+    leader.init(sv[0], 0);
+    follower.init(sv[1], true);
+    follower_graph.clear();
+
+    TEST("snapshot then deltas mirror reserves and versions");
+    {
+        assert(leader.publish(g, 100) == PF_REPL_APPLIED);
+        assert(follower.poll_once(follower_graph) == PF_REPL_RESYNCED);
+        assert(follower_graph.n_pools == 2);
+
+        g.apply_state(1, 3100, 3900, 0, 101);
+        assert(leader.publish(g, 101) == PF_REPL_APPLIED);
+        assert(follower.poll_once(follower_graph) == PF_REPL_APPLIED);
+        assert(follower_graph.reserve0[1] == 3100 && follower_graph.reserve1[1] == 3900);
+        assert(follower_graph.version[1] == g.version[1]);
+        assert(follower.last_block == 101 && leader.stats.deltas == 1);
+        PASS();
+    }
+
+    TEST("sequence gap triggers a resync request and snapshot");
+    {
+        int lost[2];
+        assert(socketpair(AF_UNIX, SOCK_STREAM, 0, lost) == 0);
+        g.apply_state(0, 1200, 1800, 0, 102);
+        leader.fd = lost[0];                        /* frame 102 never arrives */
+        assert(leader.publish(g, 102) == PF_REPL_APPLIED);
+        leader.fd = sv[0];
+        close(lost[0]);
+        close(lost[1]);
+
+        g.apply_state(1, 3300, 3700, 0, 103);
+        assert(leader.publish(g, 103) == PF_REPL_APPLIED);
+        assert(follower.poll_once(follower_graph) == PF_REPL_GAP);
+        assert(!follower.synced && follower.stats.resync_requests == 1);
+
+        g.apply_state(1, 3400, 3600, 0, 104);
+        assert(leader.publish(g, 104) == PF_REPL_APPLIED);   /* serves the request */
+        assert(leader.stats.resync_requests == 1);
+        assert(follower.poll_once(follower_graph) == PF_REPL_RESYNCED);
+        assert(follower_graph.reserve0[0] == 1200 && follower_graph.reserve0[1] == 3400);
+        assert(follower.last_block == 104);
+        PASS();
+    }
+
+    TEST("leader rollback and append are sent as snapshots");
+    {
+        g.apply_state(1, 3500, 3500, 0, 105);
+        assert(leader.publish(g, 105) == PF_REPL_APPLIED);
+        assert(follower.poll_once(follower_graph) == PF_REPL_APPLIED);
+        assert(follower_graph.reserve0[1] == 3500);
+
+        assert(g.rollback(104) == 1);                /* reorg: 105 reverted */
+        assert(leader.publish(g, 105) == PF_REPL_APPLIED);
+        assert(follower.poll_once(follower_graph) == PF_REPL_RESYNCED);
+        assert(follower_graph.reserve0[1] == 3400 && follower_graph.reserve1[1] == 3600);
+        assert(follower_graph.version[1] == g.version[1]);
+
+        AMMPool p = make_pool(3, 4, 3, 5000, 6000);
+        p.block_updated = 106;
+        assert(g.upsert(p));
+        assert(leader.publish(g, 106) == PF_REPL_APPLIED);
+        assert(follower.poll_once(follower_graph) == PF_REPL_RESYNCED);
+        assert(follower_graph.n_pools == 3 && follower_graph.reserve1[2] == 6000);
+
+        g.apply_state(2, 5100, 5900, 0, 107);        /* back to plain deltas */
+        assert(leader.publish(g, 107) == PF_REPL_APPLIED);
+        assert(follower.poll_once(follower_graph) == PF_REPL_APPLIED);
+        assert(follower_graph.reserve0[2] == 5100 && follower.synced);
+        PASS();
+    }
+
+    TEST("delta for a slot the follower lacks forces a resync");
+    {
+        follower_graph.n_pools = 2;                  /* as if the append was lost */
+        g.apply_state(2, 5200, 5800, 0, 108);
+        assert(leader.publish(g, 108) == PF_REPL_APPLIED);
+        assert(follower.poll_once(follower_graph) == PF_REPL_GAP);
+        assert(!follower.synced);
+
+        g.apply_state(0, 1300, 1700, 0, 109);
+        assert(leader.publish(g, 109) == PF_REPL_APPLIED);   /* serves the request */
+        assert(follower.poll_once(follower_graph) == PF_REPL_RESYNCED);
+        assert(follower_graph.n_pools == 3 && follower_graph.reserve0[2] == 5200);
+        PASS();
+    }
+
+    follower.release();
+    close(sv[0]);
+    close(sv[1]);
+}
+
+int main() {
+    printf("MEV Protocol - C++ Kernel Test Suite\n");
+    printf("====================================\n");
+
+    test_pool_graph();
+    test_token_table();
+    test_price_table();
+    test_backrun_cache();
+    test_reorg_journal();
+    test_cycle_screen();
+    test_graph_shard();
+    test_graph_snapshot();
+    test_log_decoder();
+    test_delta_stream();
+    test_graph_replica();
+
+    printf("\n" GREEN "All tests passed!" RESET "\n\n");
+    return 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * Memory pool stress test — N threads allocating, handing off and freeing.
+ *
+ * Each thread loops: allocate a random run of blocks from a random pool,
+ * stamp every block with (thread, serial) and a fill pattern, swap some of
+ * them into a shared exchange array (so the block is freed by whichever
+ * thread swaps it out — cross-thread frees), verify and free the rest.
+ *
+ * Invariants checked:
+ *   1. No block is handed to two owners at once (the stamp written at
+ *      allocation is intact when the owner frees it).
+ *   2. Exact accounting: after every thread has exited (flushing its
+ *      magazines) and the exchange is drained, each pool's free list holds
+ *      all of its slab blocks again and no fallback block is live.
+ *   3. No crash / deadlock at high thread counts.
+ *
+ * Build and run from fast/:
+ *   make stress                   # 16 threads x 200000 iterations
+ *   make tsan                     # ThreadSanitizer, 8 threads; reports fail it
+ *   make stress STRESS_ARGS="32 100000"
+ *
+ * Run directly:
+ *   ./test_pool_stress            # default: 8 threads x 200000 iterations
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "../include/memory_pool.h"
+
+#define MAX_RUN     40      /* > one magazine, so refills and spills happen */
+#define EXCHANGE    64
+#define STAMP_BYTES 64      /* bytes checked per block (smallest pool is 256) */
+
+typedef struct {
+    void*   ptr;
+    int     pool;           /* 0 tx, 1 calldata, 2 result */
+} held_t;
+
+typedef struct {
+    _Atomic(uintptr_t) slot[EXCHANGE];   /* block | pool index in the low bits */
+} exchange_t;
+
+typedef struct {
+    exchange_t* ex;
+    uint32_t    tid;
+    uint64_t    iters;
+    uint64_t    seed;
+    uint64_t    corrupt;    /* out */
+    uint64_t    allocs;     /* out */
+} worker_args_t;
+
+static void* pool_alloc(int pool) {
+    switch (pool) {
+    case 0:  return mev_alloc_tx();
+    case 1:  return mev_alloc_calldata();
+    default: return mev_alloc_result();
+    }
+}
+
+static void pool_free(int pool, void* p) {
+    switch (pool) {
+    case 0:  mev_free_tx(p); break;
+    case 1:  mev_free_calldata(p); break;
+    default: mev_free_result(p); break;
+    }
+}
+
+/* Stamp: word 0 = tid << 32 | serial, rest of STAMP_BYTES = serial low byte */
+static void stamp(void* p, uint32_t tid, uint32_t serial) {
+    uint64_t w = ((uint64_t)tid << 32) | serial;
+    memcpy(p, &w, sizeof(w));
+    memset((uint8_t*)p + sizeof(w), (int)(serial & 0xFF), STAMP_BYTES - sizeof(w));
+}
+
+static int stamp_ok(const void* p) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    const uint8_t fill = (uint8_t)(w & 0xFF);
+    const uint8_t* b = (const uint8_t*)p + sizeof(w);
+    for (size_t i = 0; i < STAMP_BYTES - sizeof(w); i++) {
+        if (b[i] != fill) return 0;
+    }
+    return 1;
+}
+
+static uint64_t next_rand(uint64_t* s) {
+    *s ^= *s << 13; *s ^= *s >> 7; *s ^= *s << 17;
+    return *s;
+}
+
+static void* worker(void* arg) {
+    worker_args_t* a = (worker_args_t*)arg;
+    held_t held[MAX_RUN];
+    uint32_t serial = 0;
+    uint64_t s = a->seed;
+
+    for (uint64_t it = 0; it < a->iters; it++) {
+        const int pool = (int)(next_rand(&s) % 3);
+        const int n = 1 + (int)(next_rand(&s) % MAX_RUN);
+        for (int i = 0; i < n; i++) {
+            held[i].pool = pool;
+            held[i].ptr = pool_alloc(pool);
+            if (!held[i].ptr) { a->corrupt++; return NULL; }
+            stamp(held[i].ptr, a->tid, ++serial);
+            a->allocs++;
+        }
+        for (int i = 0; i < n; i++) {
+            /* Verify our own stamp: a second owner would have overwritten it */
+            uint64_t w;
+            memcpy(&w, held[i].ptr, sizeof(w));
+            if ((uint32_t)(w >> 32) != a->tid || !stamp_ok(held[i].ptr)) a->corrupt++;
+
+            if (next_rand(&s) % 4 == 0) {
+                /* Hand off: whoever swaps it out frees it */
+                uintptr_t mine = (uintptr_t)held[i].ptr | (uintptr_t)held[i].pool;
+                uintptr_t theirs = atomic_exchange(&a->ex->slot[next_rand(&s) % EXCHANGE], mine);
+                if (theirs) {
+                    void* p = (void*)(theirs & ~(uintptr_t)3);
+                    if (!stamp_ok(p)) a->corrupt++;
+                    pool_free((int)(theirs & 3), p);
+                }
+            } else {
+                pool_free(held[i].pool, held[i].ptr);
+            }
+        }
+    }
+    return NULL;   /* thread exit flushes this thread's magazines */
+}
+
+int main(int argc, char** argv) {
+    int n_threads = (argc > 1) ? atoi(argv[1]) : 8;
+    uint64_t iters = (argc > 2) ? strtoull(argv[2], NULL, 10) : 200000ULL;
+    if (n_threads < 1 || n_threads > 256) {
+        fprintf(stderr, "n_threads must be in [1, 256]\n");
+        return 1;
+    }
+
+    printf("Pool stress test: %d threads x %llu iterations\n",
+           n_threads, (unsigned long long)iters);
+    if (mev_pools_init() != 0) {
+        fprintf(stderr, "mev_pools_init failed\n");
+        return 1;
+    }
+
+    static exchange_t ex;
+    worker_args_t* args = calloc(n_threads, sizeof(*args));
+    pthread_t* threads = calloc(n_threads, sizeof(*threads));
+    if (!args || !threads) {
+        fprintf(stderr, "alloc failed\n");
+        return 1;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < n_threads; i++) {
+        args[i].ex = &ex;
+        args[i].tid = (uint32_t)(i + 1);
+        args[i].iters = iters;
+        args[i].seed = 0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1);
+        if (pthread_create(&threads[i], NULL, worker, &args[i]) != 0) {
+            fprintf(stderr, "pthread_create failed\n");
+            return 1;
+        }
+    }
+    uint64_t corrupt = 0, allocs = 0;
+    for (int i = 0; i < n_threads; i++) {
+        pthread_join(threads[i], NULL);
+        corrupt += args[i].corrupt;
+        allocs += args[i].allocs;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    /* Drain the exchange from this thread, then flush our own magazines */
+    for (int i = 0; i < EXCHANGE; i++) {
+        uintptr_t v = atomic_exchange(&ex.slot[i], 0);
+        if (v) pool_free((int)(v & 3), (void*)(v & ~(uintptr_t)3));
+    }
+    mev_pools_flush_thread();
+
+    double elapsed = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("  allocs:      %llu (%.2f Mops/s)\n", (unsigned long long)allocs, (double)allocs / elapsed / 1e6);
+
+    const char* names[3] = { "tx", "calldata", "result" };
+    mev_pool_usage_t u[3];
+    mev_pool_contention_t c[3];
+    mev_pool_usage(&u[0], &u[1], &u[2]);
+    mev_pool_contention(&c[0], &c[1], &c[2]);
+    int leaks = 0;
+    for (int p = 0; p < 3; p++) {
+        printf("  %-9s free %zu/%zu  fallback %zu (live %zu)  cas retries %zu  refills %zu  spills %zu\n",
+               names[p], u[p].free, u[p].blocks, u[p].fallback_allocs, u[p].fallback_live,
+               c[p].cas_retries, c[p].refills, c[p].spills);
+        if (u[p].free != u[p].blocks || u[p].fallback_live != 0) leaks = 1;
+    }
+
+    if (corrupt) {
+        fprintf(stderr, "FAIL: %llu blocks had a second owner\n", (unsigned long long)corrupt);
+        return 1;
+    }
+    if (leaks) {
+        fprintf(stderr, "FAIL: accounting mismatch after all blocks were returned\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -16,6 +16,7 @@
  * Run:
  *   ./test_queue_stress.exe        # default: 4 producers x 250000 items
  *   ./test_queue_stress.exe 8 1000000
+ *   ./test_queue_stress.exe 4 250000 32   # push_batch / pop_batch, runs of 32
  */
 
 #include <stdio.h>
@@ -33,16 +34,41 @@
 #define DECODE_PID(p)    ((uint16_t)((uintptr_t)(p) >> 48))
 #define DECODE_SEQ(p)    ((uint64_t)((uintptr_t)(p) & 0xFFFFFFFFFFFFULL))
 
+#define MAX_BATCH 256
+
 typedef struct {
     mev_queue_t* q;
     uint16_t     pid;
     uint64_t     n_items;
+    size_t       batch;      /* 1 = single push, else push_batch runs */
     uint64_t     pushed;     /* out */
     uint64_t     full_retries; /* out */
 } producer_args_t;
 
 static void* producer_thread(void* arg) {
     producer_args_t* a = (producer_args_t*)arg;
+    if (a->batch > 1) {
+        void* items[MAX_BATCH];
+        uint64_t seq = 1;
+        while (seq <= a->n_items) {
+            size_t n = 0;
+            while (n < a->batch && seq + n <= a->n_items) {
+                items[n] = ENCODE(a->pid, seq + n);
+                n++;
+            }
+            /* A short run is legal: push the rest on the next iteration. */
+            size_t done = mev_queue_push_batch(a->q, items, n);
+            if (done == 0) {
+                a->full_retries++;
+                struct timespec ts = {0, 1000}; /* 1us */
+                nanosleep(&ts, NULL);
+                continue;
+            }
+            seq += done;
+            a->pushed += done;
+        }
+        return NULL;
+    }
     for (uint64_t seq = 1; seq <= a->n_items; seq++) {
         void* item = ENCODE(a->pid, seq);
         /* Spin on full queue (legitimate backpressure). */
@@ -60,20 +86,26 @@ static void* producer_thread(void* arg) {
 int main(int argc, char** argv) {
     int n_producers = (argc > 1) ? atoi(argv[1]) : 4;
     uint64_t n_per_producer = (argc > 2) ? strtoull(argv[2], NULL, 10) : 250000ULL;
+    size_t batch = (argc > 3) ? (size_t)strtoull(argv[3], NULL, 10) : 1;
 
     if (n_producers < 1 || n_producers > 64) {
         fprintf(stderr, "n_producers must be in [1, 64]\n");
         return 1;
     }
+    if (batch < 1 || batch > MAX_BATCH) {
+        fprintf(stderr, "batch must be in [1, %d]\n", MAX_BATCH);
+        return 1;
+    }
     if (n_producers > (1 << 16)) {
         fprintf(stderr, "n_producers exceeds 16-bit pid encoding\n");
         return 1;
     }
 
-    printf("Stress test: %d producers x %llu items each (total %llu)\n",
+    printf("Stress test: %d producers x %llu items each (total %llu), batch %zu\n",
            n_producers,
            (unsigned long long)n_per_producer,
-           (unsigned long long)(n_producers * n_per_producer));
+           (unsigned long long)(n_producers * n_per_producer),
+           batch);
 
     /* Capacity intentionally small relative to throughput to exercise the
      * "queue full" branch and force producer/consumer interleaving. */
@@ -107,6 +139,7 @@ int main(int argc, char** argv) {
         args[i].q = q;
         args[i].pid = (uint16_t)(i + 1);  /* avoid pid=0 (matches NULL/empty) */
         args[i].n_items = n_per_producer;
+        args[i].batch = batch;
         if (pthread_create(&threads[i], NULL, producer_thread, &args[i]) != 0) {
             fprintf(stderr, "pthread_create failed\n");
             return 1;
@@ -118,9 +151,20 @@ int main(int argc, char** argv) {
     uint64_t total_popped = 0;
     uint64_t empty_spins = 0;
     int producers_done = 0;
+    void* buf[MAX_BATCH];
+    size_t buf_n = 0, buf_i = 0;
 
     while (total_popped < total_expected) {
-        void* item = mev_queue_try_pop(q);
+        if (buf_i == buf_n) {
+            buf_i = 0;
+            if (batch > 1) {
+                buf_n = mev_queue_pop_batch(q, buf, batch);
+            } else {
+                buf[0] = mev_queue_try_pop(q);
+                buf_n = buf[0] != NULL;
+            }
+        }
+        void* item = buf_i < buf_n ? buf[buf_i++] : NULL;
         if (!item) {
             /* Check whether all producers have finished pushing. */
             if (!producers_done) {